@@ -0,0 +1,45 @@
+import time
+
+from pysqlite2 import dbapi2 as sqlite
+
+def fetch_rate(size, rows, mode, blob_views=False, rounds=9):
+    """Returns the number of BLOB bytes per second fetched in the fastest of
+    several rounds."""
+    con = sqlite.connect(":memory:")
+    con.execute("create table test(data blob)")
+    con.executemany("insert into test(data) values (?)",
+                    ((buffer("x" * size),) for i in xrange(rows)))
+    cur = con.cursor()
+    cur.blob_views = blob_views
+
+    best = None
+    for round in range(rounds):
+        starttime = time.time()
+        cur.execute("select data from test")
+        if mode == "fetchall":
+            nbytes = sum(len(row[0]) for row in cur.fetchall())
+        elif mode == "fetchmany":
+            nbytes = 0
+            batch = cur.fetchmany(100)
+            while batch:
+                nbytes += sum(len(row[0]) for row in batch)
+                batch = cur.fetchmany(100)
+        else:
+            nbytes = sum(len(row[0]) for row in cur)
+        elapsed = time.time() - starttime
+        if best is None or elapsed < best:
+            best = elapsed
+
+    con.close()
+    return nbytes / best
+
+def test():
+    print "%-20s %-10s %14s %14s" % ("rows", "fetch", "copies [MB/s]", "views [MB/s]")
+    for size, rows in ((256 * 1024, 400), (4096, 20000), (64, 200000)):
+        for mode in ("fetchall", "fetchmany", "iterate"):
+            print "%-20s %-10s %14.0f %14.0f" % ("%d x %d B" % (rows, size), mode,
+                                                 fetch_rate(size, rows, mode) / 1e6,
+                                                 fetch_rate(size, rows, mode, True) / 1e6)
+
+if __name__ == "__main__":
+    test()
@@ -0,0 +1,28 @@
+import time
+
+from pysqlite2 import dbapi2 as sqlite
+
+def lookup_time(policy, size, lookups=200000):
+    """Returns the time per statement cache hit in microseconds."""
+    cache = sqlite.Cache(lambda key: key, size, policy)
+    keys = ["select %d" % i for i in range(size)]
+
+    # fill the cache, then look up all entries round-robin, so that every
+    # lookup is a hit and the entries keep changing their position
+    for key in keys:
+        cache.get(key)
+
+    starttime = time.time()
+    for i in xrange(lookups):
+        cache.get(keys[i % size])
+    endtime = time.time()
+
+    return (endtime - starttime) * 1e6 / lookups
+
+def test():
+    print "%8s %12s %12s" % ("size", "lfu [us]", "lru [us]")
+    for size in (100, 1000, 10000):
+        print "%8d %12.3f %12.3f" % (size, lookup_time("lfu", size), lookup_time("lru", size))
+
+if __name__ == "__main__":
+    test()
@@ -0,0 +1,50 @@
+import os
+import tempfile
+import time
+
+from pysqlite2 import dbapi2 as sqlite
+
+def transaction_rate(database, transactions=10000, rounds=5, rollback=False):
+    """Returns the number of one-row transactions per second in the fastest
+    of several rounds."""
+    con = sqlite.connect(database)
+    con.execute("pragma synchronous = off")
+    con.execute("create table test(i integer)")
+    con.commit()
+    cur = con.cursor()
+    end = con.rollback if rollback else con.commit
+
+    best = None
+    for round in range(rounds):
+        starttime = time.time()
+        for i in xrange(transactions):
+            cur.execute("insert into test(i) values (?)", (i,))
+            end()
+        elapsed = time.time() - starttime
+        if best is None or elapsed < best:
+            best = elapsed
+
+    con.close()
+    return transactions / best
+
+def test():
+    fd, path = tempfile.mkstemp(suffix=".db")
+    os.close(fd)
+
+    print "%-10s %14s %14s" % ("database", "commit [1/s]", "rollback [1/s]")
+    try:
+        for database in (":memory:", path):
+            if database == path:
+                os.remove(path)
+            commit_rate = transaction_rate(database)
+            if database == path:
+                os.remove(path)
+            rollback_rate = transaction_rate(database, rollback=True)
+            print "%-10s %14.0f %14.0f" % ("memory" if database == ":memory:" else "file",
+                                           commit_rate, rollback_rate)
+    finally:
+        if os.path.exists(path):
+            os.remove(path)
+
+if __name__ == "__main__":
+    test()
@@ -0,0 +1,1417 @@
+#-*- coding: ISO-8859-1 -*-
+# pysqlite2/test/dbapi.py: tests for DB-API compliance
+#
+# Copyright (C) 2004-2015 Gerhard Hring <gh@ghaering.de>
+#
+# This file is part of pysqlite.
+#
+# This software is provided 'as-is', without any express or implied
+# warranty.  In no event will the authors be held liable for any damages
+# arising from the use of this software.
+#
+# Permission is granted to anyone to use this software for any purpose,
+# including commercial applications, and to alter it and redistribute it
+# freely, subject to the following restrictions:
+#
+# 1. The origin of this software must not be misrepresented; you must not
+#    claim that you wrote the original software. If you use this software
+#    in a product, an acknowledgment in the product documentation would be
+#    appreciated but is not required.
+# 2. Altered source versions must be plainly marked as such, and must not be
+#    misrepresented as being the original software.
+# 3. This notice may not be removed or altered from any source distribution.
+
+import struct
+import unittest
+try:
+    import threading
+except ImportError:
+    threading = None
+import pysqlite2.dbapi2 as sqlite
+
+class ModuleTests(unittest.TestCase):
+    def CheckAPILevel(self):
+        self.assertEqual(sqlite.apilevel, "2.0",
+                         "apilevel is %s, should be 2.0" % sqlite.apilevel)
+
+    def CheckThreadSafety(self):
+        self.assertEqual(sqlite.threadsafety, 1,
+                         "threadsafety is %d, should be 1" % sqlite.threadsafety)
+
+    def CheckParamStyle(self):
+        self.assertEqual(sqlite.paramstyle, "qmark",
+                         "paramstyle is '%s', should be 'qmark'" %
+                         sqlite.paramstyle)
+
+    def CheckWarning(self):
+        self.assertTrue(issubclass(sqlite.Warning, StandardError),
+                        "Warning is not a subclass of StandardError")
+
+    def CheckError(self):
+        self.assertTrue(issubclass(sqlite.Error, StandardError),
+                        "Error is not a subclass of StandardError")
+
+    def CheckInterfaceError(self):
+        self.assertTrue(issubclass(sqlite.InterfaceError, sqlite.Error),
+                        "InterfaceError is not a subclass of Error")
+
+    def CheckDatabaseError(self):
+        self.assertTrue(issubclass(sqlite.DatabaseError, sqlite.Error),
+                        "DatabaseError is not a subclass of Error")
+
+    def CheckDataError(self):
+        self.assertTrue(issubclass(sqlite.DataError, sqlite.DatabaseError),
+                        "DataError is not a subclass of DatabaseError")
+
+    def CheckOperationalError(self):
+        self.assertTrue(issubclass(sqlite.OperationalError, sqlite.DatabaseError),
+                        "OperationalError is not a subclass of DatabaseError")
+
+    def CheckIntegrityError(self):
+        self.assertTrue(issubclass(sqlite.IntegrityError, sqlite.DatabaseError),
+                        "IntegrityError is not a subclass of DatabaseError")
+
+    def CheckInternalError(self):
+        self.assertTrue(issubclass(sqlite.InternalError, sqlite.DatabaseError),
+                        "InternalError is not a subclass of DatabaseError")
+
+    def CheckProgrammingError(self):
+        self.assertTrue(issubclass(sqlite.ProgrammingError, sqlite.DatabaseError),
+                        "ProgrammingError is not a subclass of DatabaseError")
+
+    def CheckNotSupportedError(self):
+        self.assertTrue(issubclass(sqlite.NotSupportedError,
+                                   sqlite.DatabaseError),
+                        "NotSupportedError is not a subclass of DatabaseError")
+
+class ConnectionTests(unittest.TestCase):
+    def setUp(self):
+        self.cx = sqlite.connect(":memory:")
+        cu = self.cx.cursor()
+        cu.execute("create table test(id integer primary key, name text)")
+        cu.execute("insert into test(name) values (?)", ("foo",))
+
+    def tearDown(self):
+        self.cx.close()
+
+    def CheckCommit(self):
+        self.cx.commit()
+
+    def CheckCommitAfterNoChanges(self):
+        """
+        A commit should also work when no changes were made to the database.
+        """
+        self.cx.commit()
+        self.cx.commit()
+
+    def CheckRollback(self):
+        self.cx.rollback()
+
+    def CheckRollbackAfterNoChanges(self):
+        """
+        A rollback should also work when no changes were made to the database.
+        """
+        self.cx.rollback()
+        self.cx.rollback()
+
+    def CheckCursor(self):
+        cu = self.cx.cursor()
+
+    def CheckFailedOpen(self):
+        YOU_CANNOT_OPEN_THIS = "/foo/bar/bla/23534/mydb.db"
+        try:
+            con = sqlite.connect(YOU_CANNOT_OPEN_THIS)
+        except sqlite.OperationalError:
+            return
+        self.fail("should have raised an OperationalError")
+
+    def CheckClose(self):
+        self.cx.close()
+
+    def CheckExceptions(self):
+        # Optional DB-API extension.
+        self.assertEqual(self.cx.Warning, sqlite.Warning)
+        self.assertEqual(self.cx.Error, sqlite.Error)
+        self.assertEqual(self.cx.InterfaceError, sqlite.InterfaceError)
+        self.assertEqual(self.cx.DatabaseError, sqlite.DatabaseError)
+        self.assertEqual(self.cx.DataError, sqlite.DataError)
+        self.assertEqual(self.cx.OperationalError, sqlite.OperationalError)
+        self.assertEqual(self.cx.IntegrityError, sqlite.IntegrityError)
+        self.assertEqual(self.cx.InternalError, sqlite.InternalError)
+        self.assertEqual(self.cx.ProgrammingError, sqlite.ProgrammingError)
+        self.assertEqual(self.cx.NotSupportedError, sqlite.NotSupportedError)
+
+    def CheckOpenFlags(self):
+        con = sqlite.connect(":memory:", flags=sqlite.SQLITE_OPEN_READONLY)
+        # exception will be raised because of readonly database
+        self.assertRaises(sqlite.OperationalError, con.execute, "create table test(foo)")
+
+    def CheckExecuteDml(self):
+        rowcount, lastrowid = self.cx.execute_dml("insert into test(name) values (?)", ("bar",))
+        self.assertEqual(rowcount, 1)
+        self.assertEqual(lastrowid, 2)
+        rowcount, lastrowid = self.cx.execute_dml("update test set name=:name", {"name": u"baz"})
+        self.assertEqual(rowcount, 2)
+        self.assertEqual(self.cx.execute("select count(*) from test where name='baz'").fetchone()[0], 2)
+
+    def CheckExecuteDmlImplicitTransaction(self):
+        self.cx.commit()
+        self.cx.execute_dml("insert into test(name) values (?)", ("bar",))
+        self.cx.rollback()
+        self.assertEqual(self.cx.execute("select count(*) from test").fetchone()[0], 1)
+
+    def CheckExecuteDmlRejectsQueries(self):
+        self.assertRaises(sqlite.ProgrammingError, self.cx.execute_dml, "select name from test")
+
+    def CheckExecuteDmlWrongNumberOfBindings(self):
+        self.assertRaises(sqlite.ProgrammingError, self.cx.execute_dml, "insert into test(name) values (?)")
+        self.assertRaises(sqlite.ProgrammingError, self.cx.execute_dml, "insert into test(name) values (?)", (1, 2))
+
+    def CheckExecuteDmlError(self):
+        self.assertRaises(sqlite.IntegrityError, self.cx.execute_dml, "insert into test(id, name) values (?, ?)", (1, "bar"))
+        # the cached statement can be used again after the error
+        self.cx.execute_dml("insert into test(id, name) values (?, ?)", (5, "bar"))
+
+class CursorTests(unittest.TestCase):
+    def setUp(self):
+        self.cx = sqlite.connect(":memory:")
+        self.cu = self.cx.cursor()
+        self.cu.execute("create table test(id integer primary key, name text, income number)")
+        self.cu.execute("insert into test(name) values (?)", ("foo",))
+
+    def tearDown(self):
+        self.cu.close()
+        self.cx.close()
+
+    def CheckExecuteNoArgs(self):
+        self.cu.execute("delete from test")
+
+    def CheckExecuteIllegalSql(self):
+        try:
+            self.cu.execute("select asdf")
+            self.fail("should have raised an OperationalError")
+        except sqlite.OperationalError:
+            return
+        except:
+            self.fail("raised wrong exception")
+
+    def CheckExecuteTooMuchSql(self):
+        try:
+            self.cu.execute("select 5+4; select 4+5")
+            self.fail("should have raised a Warning")
+        except sqlite.Warning:
+            return
+        except:
+            self.fail("raised wrong exception")
+
+    def CheckExecuteTooMuchSql2(self):
+        self.cu.execute("select 5+4; -- foo bar")
+
+    def CheckExecuteTooMuchSql3(self):
+        self.cu.execute("""
+            select 5+4;
+
+            /*
+            foo
+            */
+            """)
+
+    def CheckExecuteWrongSqlArg(self):
+        try:
+            self.cu.execute(42)
+            self.fail("should have raised a ValueError")
+        except ValueError:
+            return
+        except:
+            self.fail("raised wrong exception.")
+
+    def CheckExecuteArgInt(self):
+        self.cu.execute("insert into test(id) values (?)", (42,))
+
+    def CheckExecuteArgFloat(self):
+        self.cu.execute("insert into test(income) values (?)", (2500.32,))
+
+    def CheckExecuteArgString(self):
+        self.cu.execute("insert into test(name) values (?)", ("Hugo",))
+
+    def CheckExecuteArgStringWithZeroByte(self):
+        self.cu.execute("insert into test(name) values (?)", ("Hu\x00go",))
+
+        self.cu.execute("select name from test where id=?", (self.cu.lastrowid,))
+        row = self.cu.fetchone()
+        self.assertEqual(row[0], "Hu\x00go")
+
+    def CheckExecuteWrongNoOfArgs1(self):
+        # too many parameters
+        try:
+            self.cu.execute("insert into test(id) values (?)", (17, "Egon"))
+            self.fail("should have raised ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+
+    def CheckExecuteWrongNoOfArgs2(self):
+        # too little parameters
+        try:
+            self.cu.execute("insert into test(id) values (?)")
+            self.fail("should have raised ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+
+    def CheckExecuteWrongNoOfArgs3(self):
+        # no parameters, parameters are needed
+        try:
+            self.cu.execute("insert into test(id) values (?)")
+            self.fail("should have raised ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+
+    def CheckExecuteParamList(self):
+        self.cu.execute("insert into test(name) values ('foo')")
+        self.cu.execute("select name from test where name=?", ["foo"])
+        row = self.cu.fetchone()
+        self.assertEqual(row[0], "foo")
+
+    def CheckExecuteParamSequence(self):
+        class L(object):
+            def __len__(self):
+                return 1
+            def __getitem__(self, x):
+                assert x == 0
+                return "foo"
+
+        self.cu.execute("insert into test(name) values ('foo')")
+        self.cu.execute("select name from test where name=?", L())
+        row = self.cu.fetchone()
+        self.assertEqual(row[0], "foo")
+
+    def CheckExecuteDictMapping(self):
+        self.cu.execute("insert into test(name) values ('foo')")
+        self.cu.execute("select name from test where name=:name", {"name": "foo"})
+        row = self.cu.fetchone()
+        self.assertEqual(row[0], "foo")
+
+    def CheckExecuteDictMapping_Mapping(self):
+        class D(dict):
+            def __missing__(self, key):
+                return "foo"
+
+        self.cu.execute("insert into test(name) values ('foo')")
+        self.cu.execute("select name from test where name=:name", D())
+        row = self.cu.fetchone()
+        self.assertEqual(row[0], "foo")
+
+    def CheckExecuteDictMappingTooLittleArgs(self):
+        self.cu.execute("insert into test(name) values ('foo')")
+        try:
+            self.cu.execute("select name from test where name=:name and id=:id", {"name": "foo"})
+            self.fail("should have raised ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+
+    def CheckExecuteDictMappingNoArgs(self):
+        self.cu.execute("insert into test(name) values ('foo')")
+        try:
+            self.cu.execute("select name from test where name=:name")
+            self.fail("should have raised ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+
+    def CheckExecuteDictMappingUnnamed(self):
+        self.cu.execute("insert into test(name) values ('foo')")
+        try:
+            self.cu.execute("select name from test where name=?", {"name": "foo"})
+            self.fail("should have raised ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+
+    def CheckClose(self):
+        self.cu.close()
+
+    def CheckRowcountExecute(self):
+        self.cu.execute("delete from test")
+        self.cu.execute("insert into test(name) values ('foo')")
+        self.cu.execute("insert into test(name) values ('foo')")
+        self.cu.execute("update test set name='bar'")
+        self.assertEqual(self.cu.rowcount, 2)
+
+    def CheckRowcountSelect(self):
+        """
+        pysqlite does not know the rowcount of SELECT statements, because we
+        don't fetch all rows after executing the select statement. The rowcount
+        has thus to be -1.
+        """
+        self.cu.execute("select 5 union select 6")
+        self.assertEqual(self.cu.rowcount, -1)
+
+    def CheckRowcountExecutemany(self):
+        self.cu.execute("delete from test")
+        self.cu.executemany("insert into test(name) values (?)", [(1,), (2,), (3,)])
+        self.assertEqual(self.cu.rowcount, 3)
+
+    def CheckTotalChanges(self):
+        self.cu.execute("insert into test(name) values ('foo')")
+        self.cu.execute("insert into test(name) values ('foo')")
+        if self.cx.total_changes < 2:
+            self.fail("total changes reported wrong value")
+
+    # Checks for executemany:
+    # Sequences are required by the DB-API, iterators
+    # enhancements in pysqlite.
+
+    def CheckExecuteManySequence(self):
+        self.cu.executemany("insert into test(income) values (?)", [(x,) for x in range(100, 110)])
+
+    def CheckExecuteManyIterator(self):
+        class MyIter:
+            def __init__(self):
+                self.value = 5
+
+            def next(self):
+                if self.value == 10:
+                    raise StopIteration
+                else:
+                    self.value += 1
+                    return (self.value,)
+
+        self.cu.executemany("insert into test(income) values (?)", MyIter())
+
+    def CheckExecuteManyGenerator(self):
+        def mygen():
+            for i in range(5):
+                yield (i,)
+
+        self.cu.executemany("insert into test(income) values (?)", mygen())
+
+    def CheckExecuteManyRepeatedString(self):
+        name = u"H\xfcgo" * 100
+        rows = [(name,), (name,), (u"Egon",), (name,)]
+        self.cu.execute("delete from test")
+        self.cu.executemany("insert into test(name) values (?)", rows)
+        self.cu.execute("select name from test order by id")
+        self.assertEqual(self.cu.fetchall(), rows)
+
+    def CheckBoundStringOutlivesParameters(self):
+        self.cu.execute("delete from test")
+        self.cu.executemany("insert into test(name) values (?)", [(u"x%d" % i,) for i in range(10)])
+        self.cu.execute("select name from test where name >= ? order by name", (u"x" + u"5",))
+        self.assertEqual([row[0] for row in self.cu], [u"x5", u"x6", u"x7", u"x8", u"x9"])
+
+    def CheckExecuteManyWrongSqlArg(self):
+        try:
+            self.cu.executemany(42, [(3,)])
+            self.fail("should have raised a ValueError")
+        except ValueError:
+            return
+        except:
+            self.fail("raised wrong exception.")
+
+    def CheckExecuteManySelect(self):
+        try:
+            self.cu.executemany("select ?", [(3,)])
+            self.fail("should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            return
+        except:
+            self.fail("raised wrong exception.")
+
+    def CheckExecuteManyNotIterable(self):
+        try:
+            self.cu.executemany("insert into test(income) values (?)", 42)
+            self.fail("should have raised a TypeError")
+        except TypeError:
+            return
+        except Exception, e:
+            print "raised", e.__class__
+            self.fail("raised wrong exception.")
+
+    def CheckFetchIter(self):
+        # Optional DB-API extension.
+        self.cu.execute("delete from test")
+        self.cu.execute("insert into test(id) values (?)", (5,))
+        self.cu.execute("insert into test(id) values (?)", (6,))
+        self.cu.execute("select id from test order by id")
+        lst = []
+        for row in self.cu:
+            lst.append(row[0])
+        self.assertEqual(lst[0], 5)
+        self.assertEqual(lst[1], 6)
+
+    def CheckFetchone(self):
+        self.cu.execute("select name from test")
+        row = self.cu.fetchone()
+        self.assertEqual(row[0], "foo")
+        row = self.cu.fetchone()
+        self.assertEqual(row, None)
+
+    def CheckFetchoneNoStatement(self):
+        cur = self.cx.cursor()
+        row = cur.fetchone()
+        self.assertEqual(row, None)
+
+    def CheckArraySize(self):
+        # must default ot 1
+        self.assertEqual(self.cu.arraysize, 1)
+
+        # now set to 2
+        self.cu.arraysize = 2
+
+        # now make the query return 3 rows
+        self.cu.execute("delete from test")
+        self.cu.execute("insert into test(name) values ('A')")
+        self.cu.execute("insert into test(name) values ('B')")
+        self.cu.execute("insert into test(name) values ('C')")
+        self.cu.execute("select name from test")
+        res = self.cu.fetchmany()
+
+        self.assertEqual(len(res), 2)
+
+    def CheckFetchmany(self):
+        self.cu.execute("select name from test")
+        res = self.cu.fetchmany(100)
+        self.assertEqual(len(res), 1)
+        res = self.cu.fetchmany(100)
+        self.assertEqual(res, [])
+
+    def CheckFetchmanyKwArg(self):
+        """Checks if fetchmany works with keyword arguments"""
+        self.cu.execute("select name from test")
+        res = self.cu.fetchmany(size=100)
+        self.assertEqual(len(res), 1)
+
+    def CheckFetchall(self):
+        self.cu.execute("select name from test")
+        res = self.cu.fetchall()
+        self.assertEqual(len(res), 1)
+        res = self.cu.fetchall()
+        self.assertEqual(res, [])
+
+    def CheckExecutecolumns(self):
+        self.cu.execute("delete from test")
+        names = [u"n\xe4%d" % i for i in range(3000)]
+        incomes = [None, 1, 2.5] * 1000
+        self.cu.executecolumns("insert into test(name, income) values (?, ?)", [names, incomes])
+        self.assertEqual(self.cu.rowcount, 3000)
+        self.cu.execute("select name, income from test order by id")
+        self.assertEqual(self.cu.fetchall(), zip(names, incomes))
+
+    def CheckExecutecolumnsBuffers(self):
+        self.cu.execute("delete from test")
+        self.cu.executecolumns("insert into test(id, income) values (?, ?)",
+                               [memoryview(bytearray("\x01\x02\xff")), [1, 2, 3]])
+        self.cu.execute("select id from test order by id")
+        ids, = self.cu.fetchcolumns()
+        self.cu.executecolumns("update test set income = ? where id = ?", [ids, ids])
+        self.assertEqual(self.cu.rowcount, 3)
+        self.cu.execute("select id, income from test order by id")
+        self.assertEqual(self.cu.fetchall(), [(1, 1), (2, 2), (255, 255)])
+
+    def CheckExecutecolumnsWrongLength(self):
+        try:
+            self.cu.executecolumns("insert into test(id, name) values (?, ?)", [[1, 2], ["a"]])
+            self.fail("should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+
+    def CheckExecutecolumnsNotDML(self):
+        try:
+            self.cu.executecolumns("select ?", [[1, 2]])
+            self.fail("should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+
+    def CheckDescriptionShared(self):
+        self.cu.execute("select id, name from test").fetchall()
+        description = self.cu.description
+        cu = self.cx.cursor()
+        cu.execute("select id, name from test")
+        self.assertTrue(cu.description is description)
+        self.assertEqual([d[0] for d in description], ["id", "name"])
+
+    def CheckDescriptionAfterSchemaChange(self):
+        self.cu.execute("create table schema_change(a)")
+        self.cu.execute("select * from schema_change")
+        self.assertEqual([d[0] for d in self.cu.description], ["a"])
+        self.cu.execute("alter table schema_change add column b")
+        self.cu.execute("select * from schema_change")
+        self.assertEqual([d[0] for d in self.cu.description], ["a", "b"])
+
+    def CheckFetchmanyBatches(self):
+        """Checks fetchmany across the boundaries of the internal fetch batches"""
+        self.cu.executemany("insert into test(name) values (?)", [("n%d" % i,) for i in range(1000)])
+        self.cu.execute("select id from test order by id")
+        res = self.cu.fetchmany(300)
+        self.assertEqual([r[0] for r in res], range(1, 301))
+        self.assertEqual(self.cu.fetchone(), (301,))
+        res = self.cu.fetchmany(700)
+        self.assertEqual([r[0] for r in res], range(302, 1002))
+        self.assertEqual(self.cu.fetchmany(10), [])
+
+    def CheckFetchallBatches(self):
+        """Checks fetchall across the boundaries of the internal fetch batches"""
+        self.cu.executemany("insert into test(name, income) values (?, ?)",
+                            [(u"n\xe4%d" % i, i / 2.0) for i in range(1000)])
+        self.cu.execute("select id, name, income from test order by id")
+        self.cu.fetchone()
+        res = self.cu.fetchall()
+        self.assertEqual(len(res), 1000)
+        self.assertEqual(res[0], (2, u"n\xe40", 0.0))
+        self.assertEqual(res[-1], (1001, u"n\xe4999", 499.5))
+        self.assertEqual(self.cu.fetchall(), [])
+
+    def CheckFetchLargeValues(self):
+        """Checks rows with values too large for the fetch batches between others"""
+        def value(i):
+            return "v%d" % i * (3000 if i % 3 == 0 else 1)
+        rows = [(unicode(value(i)), buffer(value(i))) for i in range(20)]
+        self.cu.execute("delete from test")
+        self.cu.executemany("insert into test(name, income) values (?, ?)", rows)
+        self.cu.execute("select name, income from test order by id")
+        res = self.cu.fetchmany(3) + self.cu.fetchmany(1) + [self.cu.fetchone()]
+        res += self.cu.fetchmany(4) + self.cu.fetchall()
+        self.assertEqual([(name, str(blob)) for name, blob in res],
+                         [(name, str(blob)) for name, blob in rows])
+        self.assertEqual(self.cu.fetchall(), [])
+
+    def CheckBlobViews(self):
+        self.assertEqual(self.cu.blob_views, 0)
+        self.cu.execute("delete from test")
+        self.cu.executemany("insert into test(name, income) values (?, ?)",
+                            [(u"n\xe4%d" % i, buffer("blob%d" % i)) for i in range(300)])
+        self.cu.blob_views = 1
+        self.cu.execute("select name, income from test order by id")
+        first = self.cu.fetchone()
+        self.assertEqual(str(first[1]), "blob0")
+        res = self.cu.fetchall()
+        self.assertEqual([(name, str(blob)) for name, blob in res],
+                         [(u"n\xe4%d" % i, "blob%d" % i) for i in range(1, 300)])
+        self.assertEqual(type(res[0][1]), buffer)
+        del res[:-1]
+        self.assertEqual(str(res[0][1]), "blob299")
+        with self.assertRaises(TypeError):
+            res[0][1][0] = "x"
+
+    def CheckBlobViewsSingleRows(self):
+        self.cu.execute("delete from test")
+        self.cu.executemany("insert into test(income) values (?)",
+                            [(buffer("blob%d" % i),) for i in range(4)])
+        self.cx.commit()
+        self.cu.blob_views = 1
+        self.cu.execute("select income from test order by id")
+        first = self.cu.fetchone()
+        self.assertEqual(str(first[0]), "blob0")
+        with self.assertRaises(TypeError):
+            first[0][0] = "x"
+        # fetchmany() copies the rows it returns and moves the cursor on
+        second = self.cu.fetchmany(1)[0]
+        with self.assertRaises(sqlite.ProgrammingError):
+            str(first[0])
+        self.assertEqual(str(self.cu.fetchone()[0]), "blob2")
+        fourth = next(self.cu)
+        self.assertEqual(str(fourth[0]), "blob3")
+        self.assertEqual(str(second[0]), "blob1")
+        self.assertEqual(self.cu.fetchone(), None)
+        with self.assertRaises(sqlite.ProgrammingError):
+            str(fourth[0])
+
+        self.cu.execute("select income from test order by id")
+        self.assertEqual([str(row[0]) for row in self.cu], ["blob%d" % i for i in range(4)])
+
+        self.cu.execute("select income from test order by id")
+        row = self.cu.fetchone()
+        self.cx.execute("insert into test(name) values ('foo')")
+        self.cx.rollback()
+        with self.assertRaises(sqlite.ProgrammingError):
+            str(row[0])
+
+        self.cu.execute("select income from test order by id")
+        row = self.cu.fetchone()
+        self.cu.close()
+        with self.assertRaises(sqlite.ProgrammingError):
+            str(row[0])
+
+    def CheckBlobViewsLargeValues(self):
+        self.cu.execute("delete from test")
+        data = ["%d" % i * 40000 for i in range(5)]
+        self.cu.executemany("insert into test(income) values (?)",
+                            [(buffer(d),) for d in data])
+        self.cu.blob_views = 1
+        self.cu.execute("select income from test order by id")
+        self.assertEqual([str(row[0]) for row in self.cu.fetchall()], data)
+
+    def CheckFetchcolumns(self):
+        self.cu.execute("insert into test(name, income) values (?, ?)", (None, 2.5))
+        self.cu.execute("insert into test(name, income) values (?, ?)", (u"b\xe4r", 3))
+        self.cu.execute("select id, name, income from test order by id")
+        ids, names, incomes = self.cu.fetchcolumns()
+        self.assertEqual(ids.name, "id")
+        self.assertEqual(ids.type, sqlite.SQLITE_INTEGER)
+        self.assertEqual(len(ids), 3)
+        self.assertEqual(ids.tolist(), [1, 2, 3])
+        self.assertEqual(str(buffer(ids)), struct.pack("=3q", 1, 2, 3))
+        self.assertEqual(names.type, sqlite.SQLITE_TEXT)
+        self.assertEqual(names.tolist(), [u"foo", None, u"b\xe4r"])
+        self.assertEqual(names.offsets.tolist(), [0, 3, 3, 7])
+        self.assertEqual(names.nulls.tolist(), [0, 1, 0])
+        self.assertEqual(incomes.type, sqlite.SQLITE_FLOAT)
+        self.assertEqual(incomes.tolist(), [None, 2.5, 3.0])
+        self.assertEqual(self.cu.fetchcolumns(), [])
+
+    def CheckFetchcolumnsSize(self):
+        self.cu.executemany("insert into test(name) values (?)", [("a",), ("b",)])
+        self.cu.execute("select name from test order by id")
+        col, = self.cu.fetchcolumns(2)
+        self.assertEqual(col.tolist(), [u"foo", u"a"])
+        self.assertEqual(self.cu.fetchone(), (u"b",))
+        self.assertEqual(self.cu.fetchcolumns(), [])
+
+    def CheckFetchcolumnsMemoryview(self):
+        self.cu.execute("select 1.5 union all select 2.5")
+        col, = self.cu.fetchcolumns()
+        view = memoryview(col)
+        self.assertEqual(view.format, "d")
+        self.assertEqual(view.shape, (2,))
+        self.assertEqual(view.tobytes(), struct.pack("=2d", 1.5, 2.5))
+
+    def CheckFetchcolumnsMixedTypes(self):
+        self.cu.execute("select 1 union all select 'abc'")
+        self.assertRaises(sqlite.DataError, self.cu.fetchcolumns)
+        self.cu.execute("select 1.5 union all select x'00'")
+        self.assertRaises(sqlite.DataError, self.cu.fetchcolumns)
+        # numbers in a TEXT column are converted to text
+        self.cu.execute("select 'abc' union all select 1")
+        col, = self.cu.fetchcolumns()
+        self.assertEqual(col.tolist(), [u"abc", u"1"])
+
+    def CheckSetinputsizes(self):
+        self.cu.setinputsizes([3, 4, 5])
+
+    def CheckSetoutputsize(self):
+        self.cu.setoutputsize(5, 0)
+
+    def CheckSetoutputsizeNoColumn(self):
+        self.cu.setoutputsize(42)
+
+    def CheckCursorConnection(self):
+        # Optional DB-API extension.
+        self.assertEqual(self.cu.connection, self.cx)
+
+    def CheckWrongCursorCallable(self):
+        try:
+            def f(): pass
+            cur = self.cx.cursor(f)
+            self.fail("should have raised a TypeError")
+        except TypeError:
+            return
+        self.fail("should have raised a ValueError")
+
+    def CheckCursorWrongClass(self):
+        class Foo: pass
+        foo = Foo()
+        try:
+            cur = sqlite.Cursor(foo)
+            self.fail("should have raised a ValueError")
+        except TypeError:
+            pass
+
+@unittest.skipUnless(threading, 'This test requires threading.')
+class ThreadTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+        self.cur = self.con.cursor()
+        self.cur.execute("create table test(id integer primary key, name text, bin binary, ratio number, ts timestamp)")
+
+    def tearDown(self):
+        self.cur.close()
+        self.con.close()
+
+    def CheckConCursor(self):
+        def run(con, errors):
+            try:
+                cur = con.cursor()
+                errors.append("did not raise ProgrammingError")
+                return
+            except sqlite.ProgrammingError:
+                return
+            except:
+                errors.append("raised wrong exception")
+
+        errors = []
+        t = threading.Thread(target=run, kwargs={"con": self.con, "errors": errors})
+        t.start()
+        t.join()
+        if len(errors) > 0:
+            self.fail("\n".join(errors))
+
+    def CheckConCommit(self):
+        def run(con, errors):
+            try:
+                con.commit()
+                errors.append("did not raise ProgrammingError")
+                return
+            except sqlite.ProgrammingError:
+                return
+            except:
+                errors.append("raised wrong exception")
+
+        errors = []
+        t = threading.Thread(target=run, kwargs={"con": self.con, "errors": errors})
+        t.start()
+        t.join()
+        if len(errors) > 0:
+            self.fail("\n".join(errors))
+
+    def CheckConRollback(self):
+        def run(con, errors):
+            try:
+                con.rollback()
+                errors.append("did not raise ProgrammingError")
+                return
+            except sqlite.ProgrammingError:
+                return
+            except:
+                errors.append("raised wrong exception")
+
+        errors = []
+        t = threading.Thread(target=run, kwargs={"con": self.con, "errors": errors})
+        t.start()
+        t.join()
+        if len(errors) > 0:
+            self.fail("\n".join(errors))
+
+    def CheckConClose(self):
+        def run(con, errors):
+            try:
+                con.close()
+                errors.append("did not raise ProgrammingError")
+                return
+            except sqlite.ProgrammingError:
+                return
+            except:
+                errors.append("raised wrong exception")
+
+        errors = []
+        t = threading.Thread(target=run, kwargs={"con": self.con, "errors": errors})
+        t.start()
+        t.join()
+        if len(errors) > 0:
+            self.fail("\n".join(errors))
+
+    def CheckCurImplicitBegin(self):
+        def run(cur, errors):
+            try:
+                cur.execute("insert into test(name) values ('a')")
+                errors.append("did not raise ProgrammingError")
+                return
+            except sqlite.ProgrammingError:
+                return
+            except:
+                errors.append("raised wrong exception")
+
+        errors = []
+        t = threading.Thread(target=run, kwargs={"cur": self.cur, "errors": errors})
+        t.start()
+        t.join()
+        if len(errors) > 0:
+            self.fail("\n".join(errors))
+
+    def CheckCurClose(self):
+        def run(cur, errors):
+            try:
+                cur.close()
+                errors.append("did not raise ProgrammingError")
+                return
+            except sqlite.ProgrammingError:
+                return
+            except:
+                errors.append("raised wrong exception")
+
+        errors = []
+        t = threading.Thread(target=run, kwargs={"cur": self.cur, "errors": errors})
+        t.start()
+        t.join()
+        if len(errors) > 0:
+            self.fail("\n".join(errors))
+
+    def CheckCurExecute(self):
+        def run(cur, errors):
+            try:
+                cur.execute("select name from test")
+                errors.append("did not raise ProgrammingError")
+                return
+            except sqlite.ProgrammingError:
+                return
+            except:
+                errors.append("raised wrong exception")
+
+        errors = []
+        self.cur.execute("insert into test(name) values ('a')")
+        t = threading.Thread(target=run, kwargs={"cur": self.cur, "errors": errors})
+        t.start()
+        t.join()
+        if len(errors) > 0:
+            self.fail("\n".join(errors))
+
+    def CheckCurIterNext(self):
+        def run(cur, errors):
+            try:
+                row = cur.fetchone()
+                errors.append("did not raise ProgrammingError")
+                return
+            except sqlite.ProgrammingError:
+                return
+            except:
+                errors.append("raised wrong exception")
+
+        errors = []
+        self.cur.execute("insert into test(name) values ('a')")
+        self.cur.execute("select name from test")
+        t = threading.Thread(target=run, kwargs={"cur": self.cur, "errors": errors})
+        t.start()
+        t.join()
+        if len(errors) > 0:
+            self.fail("\n".join(errors))
+
+class ConstructorTests(unittest.TestCase):
+    def CheckDate(self):
+        d = sqlite.Date(2004, 10, 28)
+
+    def CheckTime(self):
+        t = sqlite.Time(12, 39, 35)
+
+    def CheckTimestamp(self):
+        ts = sqlite.Timestamp(2004, 10, 28, 12, 39, 35)
+
+    def CheckDateFromTicks(self):
+        d = sqlite.DateFromTicks(42)
+
+    def CheckTimeFromTicks(self):
+        t = sqlite.TimeFromTicks(42)
+
+    def CheckTimestampFromTicks(self):
+        ts = sqlite.TimestampFromTicks(42)
+
+    def CheckBinary(self):
+        b = sqlite.Binary(chr(0) + "'")
+
+class ExtensionTests(unittest.TestCase):
+    def CheckScriptStringSql(self):
+        con = sqlite.connect(":memory:")
+        cur = con.cursor()
+        cur.executescript("""
+            -- bla bla
+            /* a stupid comment */
+            create table a(i);
+            insert into a(i) values (5);
+            """)
+        cur.execute("select i from a")
+        res = cur.fetchone()[0]
+        self.assertEqual(res, 5)
+
+    def CheckScriptStringUnicode(self):
+        con = sqlite.connect(":memory:")
+        cur = con.cursor()
+        cur.executescript(u"""
+            create table a(i);
+            insert into a(i) values (5);
+            select i from a;
+            delete from a;
+            insert into a(i) values (6);
+            """)
+        cur.execute("select i from a")
+        res = cur.fetchone()[0]
+        self.assertEqual(res, 6)
+
+    def CheckScriptSyntaxError(self):
+        con = sqlite.connect(":memory:")
+        cur = con.cursor()
+        raised = False
+        try:
+            cur.executescript("create table test(x); asdf; create table test2(x)")
+        except sqlite.OperationalError:
+            raised = True
+        self.assertEqual(raised, True, "should have raised an exception")
+
+    def CheckScriptErrorNormal(self):
+        con = sqlite.connect(":memory:")
+        cur = con.cursor()
+        raised = False
+        try:
+            cur.executescript("create table test(sadfsadfdsa); select foo from hurz;")
+        except sqlite.OperationalError:
+            raised = True
+        self.assertEqual(raised, True, "should have raised an exception")
+
+    def CheckConnectionExecute(self):
+        con = sqlite.connect(":memory:")
+        result = con.execute("select 5").fetchone()[0]
+        self.assertEqual(result, 5, "Basic test of Connection.execute")
+
+    def CheckConnectionExecutemany(self):
+        con = sqlite.connect(":memory:")
+        con.execute("create table test(foo)")
+        con.executemany("insert into test(foo) values (?)", [(3,), (4,)])
+        result = con.execute("select foo from test order by foo").fetchall()
+        self.assertEqual(result[0][0], 3, "Basic test of Connection.executemany")
+        self.assertEqual(result[1][0], 4, "Basic test of Connection.executemany")
+
+    def CheckConnectionExecutescript(self):
+        con = sqlite.connect(":memory:")
+        con.executescript("create table test(foo); insert into test(foo) values (5);")
+        result = con.execute("select foo from test").fetchone()[0]
+        self.assertEqual(result, 5, "Basic test of Connection.executescript")
+
+class ClosedConTests(unittest.TestCase):
+    def setUp(self):
+        pass
+
+    def tearDown(self):
+        pass
+
+    def CheckClosedConCursor(self):
+        con = sqlite.connect(":memory:")
+        con.close()
+        try:
+            cur = con.cursor()
+            self.fail("Should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+        except:
+            self.fail("Should have raised a ProgrammingError")
+
+    def CheckClosedConCommit(self):
+        con = sqlite.connect(":memory:")
+        con.close()
+        try:
+            con.commit()
+            self.fail("Should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+        except:
+            self.fail("Should have raised a ProgrammingError")
+
+    def CheckClosedConRollback(self):
+        con = sqlite.connect(":memory:")
+        con.close()
+        try:
+            con.rollback()
+            self.fail("Should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+        except:
+            self.fail("Should have raised a ProgrammingError")
+
+    def CheckClosedCurExecute(self):
+        con = sqlite.connect(":memory:")
+        cur = con.cursor()
+        con.close()
+        try:
+            cur.execute("select 4")
+            self.fail("Should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+        except:
+            self.fail("Should have raised a ProgrammingError")
+
+    def CheckClosedCreateFunction(self):
+        con = sqlite.connect(":memory:")
+        con.close()
+        def f(x): return 17
+        try:
+            con.create_function("foo", 1, f)
+            self.fail("Should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+        except:
+            self.fail("Should have raised a ProgrammingError")
+
+    def CheckClosedCreateAggregate(self):
+        con = sqlite.connect(":memory:")
+        con.close()
+        class Agg:
+            def __init__(self):
+                pass
+            def step(self, x):
+                pass
+            def finalize(self):
+                return 17
+        try:
+            con.create_aggregate("foo", 1, Agg)
+            self.fail("Should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+        except:
+            self.fail("Should have raised a ProgrammingError")
+
+    def CheckClosedSetAuthorizer(self):
+        con = sqlite.connect(":memory:")
+        con.close()
+        def authorizer(*args):
+            return sqlite.DENY
+        try:
+            con.set_authorizer(authorizer)
+            self.fail("Should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+        except:
+            self.fail("Should have raised a ProgrammingError")
+
+    def CheckClosedSetProgressCallback(self):
+        con = sqlite.connect(":memory:")
+        con.close()
+        def progress(): pass
+        try:
+            con.set_progress_handler(progress, 100)
+            self.fail("Should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+        except:
+            self.fail("Should have raised a ProgrammingError")
+
+    def CheckClosedCall(self):
+        con = sqlite.connect(":memory:")
+        con.close()
+        try:
+            con()
+            self.fail("Should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+        except:
+            self.fail("Should have raised a ProgrammingError")
+
+class ClosedCurTests(unittest.TestCase):
+    def setUp(self):
+        pass
+
+    def tearDown(self):
+        pass
+
+    def CheckClosed(self):
+        con = sqlite.connect(":memory:")
+        cur = con.cursor()
+        cur.close()
+
+        for method_name in ("execute", "executemany", "executescript", "fetchall", "fetchmany", "fetchone"):
+            if method_name in ("execute", "executescript"):
+                params = ("select 4 union select 5",)
+            elif method_name == "executemany":
+                params = ("insert into foo(bar) values (?)", [(3,), (4,)])
+            else:
+                params = []
+
+            try:
+                method = getattr(cur, method_name)
+
+                method(*params)
+                self.fail("Should have raised a ProgrammingError: method " + method_name)
+            except sqlite.ProgrammingError:
+                pass
+            except:
+                self.fail("Should have raised a ProgrammingError: " + method_name)
+
+did_rollback = False
+
+class MyConnection(sqlite.Connection):
+    def rollback(self):
+        global did_rollback
+        did_rollback = True
+        sqlite.Connection.rollback(self)
+
+class ContextTests(unittest.TestCase):
+    def setUp(self):
+        global did_rollback
+        self.con = sqlite.connect(":memory:", factory=MyConnection)
+        self.con.execute("create table test(c unique)")
+        did_rollback = False
+
+    def tearDown(self):
+        self.con.close()
+
+    def CheckContextManager(self):
+        """Can the connection be used as a context manager at all?"""
+        with self.con:
+            pass
+
+    def CheckContextManagerCommit(self):
+        """Is a commit called in the context manager?"""
+        with self.con:
+            self.con.execute("insert into test(c) values ('foo')")
+        self.con.rollback()
+        count = self.con.execute("select count(*) from test").fetchone()[0]
+        self.assertEqual(count, 1)
+
+    def CheckContextManagerRollback(self):
+        """Is a rollback called in the context manager?"""
+        global did_rollback
+        self.assertEqual(did_rollback, False)
+        try:
+            with self.con:
+                self.con.execute("insert into test(c) values (4)")
+                self.con.execute("insert into test(c) values (4)")
+        except sqlite.IntegrityError:
+            pass
+        self.assertEqual(did_rollback, True)
+
+class BlobTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+        self.con.execute("create table test(id integer primary key, data blob)")
+        self.data = "".join(chr(i % 256) for i in range(1000))
+        self.con.execute("insert into test(id, data) values (1, ?)", (buffer(self.data),))
+        self.blob = self.con.blobopen("test", "data", 1)
+
+    def tearDown(self):
+        self.blob.close()
+        self.con.close()
+
+    def CheckLength(self):
+        self.assertEqual(len(self.blob), 1000)
+
+    def CheckRead(self):
+        self.assertEqual(self.blob.read(10), self.data[:10])
+        self.assertEqual(self.blob.tell(), 10)
+        self.assertEqual(self.blob.read(), self.data[10:])
+        self.assertEqual(self.blob.read(), "")
+
+    def CheckReadinto(self):
+        buf = bytearray(600)
+        self.assertEqual(self.blob.readinto(buf), 600)
+        self.assertEqual(str(buf), self.data[:600])
+        self.assertEqual(self.blob.readinto(buf), 400)
+        self.assertEqual(str(buf[:400]), self.data[600:])
+
+    def CheckSeek(self):
+        self.blob.seek(-10, 2)
+        self.assertEqual(self.blob.read(), self.data[-10:])
+        self.blob.seek(5)
+        self.blob.seek(5, 1)
+        self.assertEqual(self.blob.tell(), 10)
+        self.assertRaises(ValueError, self.blob.seek, 1001)
+        self.assertRaises(ValueError, self.blob.seek, -1)
+        self.assertRaises(ValueError, self.blob.seek, 0, 3)
+
+    def CheckWriteReadOnly(self):
+        self.assertRaises(sqlite.OperationalError, self.blob.write, "x")
+
+    def CheckWrite(self):
+        with self.con.blobopen("test", "data", 1, readonly=False) as blob:
+            blob.seek(10)
+            blob.write("abc")
+            self.assertEqual(blob.tell(), 13)
+            self.assertRaises(ValueError, blob.write, "x" * 988)
+        data = str(self.con.execute("select data from test").fetchone()[0])
+        self.assertEqual(data, self.data[:10] + "abc" + self.data[13:])
+
+    def CheckNoSuchRow(self):
+        self.assertRaises(sqlite.OperationalError, self.con.blobopen, "test", "data", 2)
+
+    def CheckClosed(self):
+        self.blob.close()
+        self.assertRaises(sqlite.ProgrammingError, self.blob.read)
+        self.assertRaises(sqlite.ProgrammingError, len, self.blob)
+
+    def CheckConnectionClosed(self):
+        self.con.close()
+        self.assertRaises(sqlite.ProgrammingError, self.blob.read)
+
+    def CheckReopen(self):
+        self.con.execute("insert into test(id, data) values (2, ?)", (buffer("second"),))
+        self.blob.read(10)
+        self.blob.reopen(2)
+        self.assertEqual(self.blob.tell(), 0)
+        self.assertEqual(len(self.blob), 6)
+        self.assertEqual(self.blob.read(), "second")
+        self.assertRaises(sqlite.OperationalError, self.blob.reopen, 3)
+
+    def CheckReadmany(self):
+        self.con.executemany("insert into test(id, data) values (?, ?)",
+                             [(i, buffer("row%d" % i)) for i in range(2, 12)])
+        buf = bytearray(42)
+        self.assertEqual(self.blob.readmany(range(2, 12), buf[:40]), [4] * 8 + [5])
+        sizes = self.blob.readmany(range(2, 12), buf)
+        self.assertEqual(sizes, [4] * 8 + [5, 5])
+        self.assertEqual(str(buf), "".join("row%d" % i for i in range(2, 12)))
+        sizes = self.blob.readmany([1, 2], buf)
+        self.assertEqual(sizes, [])
+        self.assertRaises(sqlite.OperationalError, self.blob.readmany, [2, 99], buf)
+
+    def CheckRowChanged(self):
+        self.con.execute("update test set data = ? where id = 1", (buffer("x"),))
+        self.assertRaises(sqlite.OperationalError, self.blob.read)
+
+class ConnectionPoolTests(unittest.TestCase):
+    def setUp(self):
+        self.pool = sqlite.ConnectionPool(":memory:", maxsize=2)
+
+    def tearDown(self):
+        self.pool.close()
+
+    def CheckReuse(self):
+        con = self.pool.acquire()
+        self.assertTrue(isinstance(con, sqlite.Connection))
+        con.execute("create table test(x)")
+        self.pool.release(con)
+        self.assertEqual(self.pool.idle, 1)
+        self.assertTrue(self.pool.acquire() is con)
+        self.assertEqual(self.pool.size, 1)
+
+    def CheckMaxSize(self):
+        self.assertEqual(self.pool.maxsize, 2)
+        con1 = self.pool.acquire()
+        con2 = self.pool.acquire()
+        self.assertTrue(con1 is not con2)
+        self.assertRaises(sqlite.OperationalError, self.pool.acquire)
+        self.pool.release(con2)
+        self.assertTrue(self.pool.acquire() is con2)
+
+    def CheckConnectArguments(self):
+        pool = sqlite.ConnectionPool(database=":memory:", factory=MyConnection, isolation_level=None)
+        con = pool.acquire()
+        self.assertTrue(isinstance(con, MyConnection))
+        self.assertEqual(con.isolation_level, None)
+        self.assertEqual(pool.idle_timeout, None)
+        pool.close()
+
+    def CheckPositionalFactory(self):
+        pool = sqlite.ConnectionPool(":memory:", 5.0, 0, None, True, MyConnection)
+        con = pool.acquire()
+        self.assertTrue(isinstance(con, MyConnection))
+        self.assertEqual(con.isolation_level, None)
+        pool.close()
+
+    def CheckBadConnectArguments(self):
+        self.assertRaises(TypeError, sqlite.ConnectionPool)
+        self.assertRaises(TypeError, sqlite.ConnectionPool, ":memory:", timeout="x")
+        self.assertRaises(TypeError, sqlite.ConnectionPool, ":memory:", other=1)
+
+    def CheckUsedAfterReleaseIsDropped(self):
+        con = self.pool.acquire()
+        con.execute("create table test(x)")
+        con.commit()
+        self.pool.release(con)
+        con.execute("insert into test(x) values (1)")
+        self.assertTrue(self.pool.acquire() is not con)
+        self.assertEqual(self.pool.size, 1)
+        self.assertRaises(sqlite.ProgrammingError, con.cursor)
+
+        con = self.pool.acquire()
+        self.pool.release(con)
+        cur = con.execute("select 1 union all select 2")
+        cur.fetchone()
+        self.assertTrue(self.pool.acquire() is not con)
+        self.assertEqual(self.pool.size, 2)
+
+    def CheckReleaseRollsBack(self):
+        con = self.pool.acquire()
+        con.execute("create table test(x)")
+        con.execute("insert into test(x) values (1)")
+        self.pool.release(con)
+        con = self.pool.acquire()
+        self.assertEqual(con.execute("select count(*) from test").fetchone()[0], 0)
+
+    def CheckReleaseForeignConnection(self):
+        con = sqlite.connect(":memory:")
+        self.assertRaises(sqlite.ProgrammingError, self.pool.release, con)
+        con = self.pool.acquire()
+        self.pool.release(con)
+        self.assertRaises(sqlite.ProgrammingError, self.pool.release, con)
+
+    def CheckClosedConnectionIsDropped(self):
+        con = self.pool.acquire()
+        con.close()
+        self.pool.release(con)
+        self.assertTrue(self.pool.acquire() is not con)
+        self.assertEqual(self.pool.size, 1)
+
+    def CheckIdleTimeout(self):
+        pool = sqlite.ConnectionPool(":memory:", idle_timeout=0)
+        con = pool.acquire()
+        pool.release(con)
+        self.assertTrue(pool.acquire() is not con)
+        self.assertEqual(pool.size, 1)
+        self.assertRaises(sqlite.ProgrammingError, con.cursor)
+        pool.close()
+
+    def CheckEvict(self):
+        pool = sqlite.ConnectionPool(":memory:", idle_timeout=0)
+        con1 = pool.acquire()
+        con2 = pool.acquire()
+        pool.release(con1)
+        self.assertEqual(pool.idle, 1)
+        # releasing a connection closes the expired ones
+        pool.release(con2)
+        self.assertEqual(pool.idle, 1)
+        self.assertEqual(pool.size, 1)
+        self.assertRaises(sqlite.ProgrammingError, con1.cursor)
+        pool.evict()
+        self.assertEqual(pool.idle, 0)
+        self.assertEqual(pool.size, 0)
+        self.assertRaises(sqlite.ProgrammingError, con2.cursor)
+        pool.close()
+        self.assertRaises(sqlite.ProgrammingError, pool.evict)
+
+        # without an idle timeout, connections stay open
+        con = self.pool.acquire()
+        self.pool.release(con)
+        self.pool.evict()
+        self.assertEqual(self.pool.idle, 1)
+
+    def CheckClose(self):
+        con1 = self.pool.acquire()
+        con2 = self.pool.acquire()
+        self.pool.release(con1)
+        self.pool.close()
+        self.assertRaises(sqlite.ProgrammingError, con1.cursor)
+        self.assertRaises(sqlite.ProgrammingError, self.pool.acquire)
+        self.pool.release(con2)
+        self.assertRaises(sqlite.ProgrammingError, con2.cursor)
+        self.assertEqual(self.pool.size, 0)
+
+    def CheckThreadAffinity(self):
+        if not threading:
+            return
+        con1 = self.pool.acquire()
+        acquired = threading.Event()
+        released = threading.Event()
+        result = []
+        def run():
+            con = self.pool.acquire()
+            result.append(con)
+            acquired.set()
+            released.wait()
+            con.execute("select 1")
+            self.pool.release(con)
+        t = threading.Thread(target=run)
+        t.start()
+        acquired.wait()
+        self.pool.release(con1)
+        released.set()
+        t.join()
+        con2 = result[0]
+        self.assertTrue(con2 is not con1)
+        # the connection released by this thread is preferred, even though
+        # the other one was released later
+        self.assertTrue(self.pool.acquire() is con1)
+        # the other thread's connection now belongs to this thread
+        self.assertTrue(self.pool.acquire() is con2)
+        con2.execute("select 1")
+
+def suite():
+    module_suite = unittest.makeSuite(ModuleTests, "Check")
+    connection_suite = unittest.makeSuite(ConnectionTests, "Check")
+    cursor_suite = unittest.makeSuite(CursorTests, "Check")
+    thread_suite = unittest.makeSuite(ThreadTests, "Check")
+    constructor_suite = unittest.makeSuite(ConstructorTests, "Check")
+    ext_suite = unittest.makeSuite(ExtensionTests, "Check")
+    closed_con_suite = unittest.makeSuite(ClosedConTests, "Check")
+    closed_cur_suite = unittest.makeSuite(ClosedCurTests, "Check")
+    context_suite = unittest.makeSuite(ContextTests, "Check")
+    blob_suite = unittest.makeSuite(BlobTests, "Check")
+    pool_suite = unittest.makeSuite(ConnectionPoolTests, "Check")
+    return unittest.TestSuite((module_suite, connection_suite, cursor_suite, thread_suite, constructor_suite, ext_suite, closed_con_suite, closed_cur_suite, context_suite, blob_suite, pool_suite))
+
+def test():
+    runner = unittest.TextTestRunner()
+    runner.run(suite())
+
+if __name__ == "__main__":
+    test()
@@ -0,0 +1,400 @@
+#-*- coding: ISO-8859-1 -*-
+# pysqlite2/test/factory.py: tests for the various factories in pysqlite
+#
+# Copyright (C) 2005-2015 Gerhard Hring <gh@ghaering.de>
+#
+# This file is part of pysqlite.
+#
+# This software is provided 'as-is', without any express or implied
+# warranty.  In no event will the authors be held liable for any damages
+# arising from the use of this software.
+#
+# Permission is granted to anyone to use this software for any purpose,
+# including commercial applications, and to alter it and redistribute it
+# freely, subject to the following restrictions:
+#
+# 1. The origin of this software must not be misrepresented; you must not
+#    claim that you wrote the original software. If you use this software
+#    in a product, an acknowledgment in the product documentation would be
+#    appreciated but is not required.
+# 2. Altered source versions must be plainly marked as such, and must not be
+#    misrepresented as being the original software.
+# 3. This notice may not be removed or altered from any source distribution.
+
+import gc
+import sys
+import unittest
+import pysqlite2.dbapi2 as sqlite
+from collections import Sequence
+
+class MyConnection(sqlite.Connection):
+    def __init__(self, *args, **kwargs):
+        sqlite.Connection.__init__(self, *args, **kwargs)
+
+def dict_factory(cursor, row):
+    d = {}
+    for idx, col in enumerate(cursor.description):
+        d[col[0]] = row[idx]
+    return d
+
+class MyCursor(sqlite.Cursor):
+    def __init__(self, *args, **kwargs):
+        sqlite.Cursor.__init__(self, *args, **kwargs)
+        self.row_factory = dict_factory
+
+class ConnectionFactoryTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:", factory=MyConnection)
+
+    def tearDown(self):
+        self.con.close()
+
+    def CheckIsInstance(self):
+        self.assertIsInstance(self.con, MyConnection)
+
+class CursorFactoryTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+
+    def tearDown(self):
+        self.con.close()
+
+    def CheckIsInstance(self):
+        cur = self.con.cursor(factory=MyCursor)
+        self.assertIsInstance(cur, MyCursor)
+
+class RowFactoryTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+
+    def CheckCustomFactory(self):
+        self.con.row_factory = lambda cur, row: list(row)
+        row = self.con.execute("select 1, 2").fetchone()
+        self.assertIsInstance(row, list)
+
+    def CheckSqliteRowIndex(self):
+        self.con.row_factory = sqlite.Row
+        row = self.con.execute("select 1 as a, 2 as b").fetchone()
+        self.assertIsInstance(row, sqlite.Row)
+
+        col1, col2 = row["a"], row["b"]
+        self.assertEqual(col1, 1, "by name: wrong result for column 'a'")
+        self.assertEqual(col2, 2, "by name: wrong result for column 'a'")
+
+        col1, col2 = row["A"], row["B"]
+        self.assertEqual(col1, 1, "by name: wrong result for column 'A'")
+        self.assertEqual(col2, 2, "by name: wrong result for column 'B'")
+
+        self.assertEqual(row[0], 1, "by index: wrong result for column 0")
+        self.assertEqual(row[0L], 1, "by index: wrong result for column 0")
+        self.assertEqual(row[1], 2, "by index: wrong result for column 1")
+        self.assertEqual(row[1L], 2, "by index: wrong result for column 1")
+        self.assertEqual(row[-1], 2, "by index: wrong result for column -1")
+        self.assertEqual(row[-1L], 2, "by index: wrong result for column -1")
+        self.assertEqual(row[-2], 1, "by index: wrong result for column -2")
+        self.assertEqual(row[-2L], 1, "by index: wrong result for column -2")
+
+        with self.assertRaises(IndexError):
+            row['c']
+        with self.assertRaises(IndexError):
+            row[2]
+        with self.assertRaises(IndexError):
+            row[2L]
+        with self.assertRaises(IndexError):
+            row[-3]
+        with self.assertRaises(IndexError):
+            row[-3L]
+        with self.assertRaises(IndexError):
+            row[2**1000]
+
+    def CheckSqliteRowIter(self):
+        """Checks if the row object is iterable"""
+        self.con.row_factory = sqlite.Row
+        row = self.con.execute("select 1 as a, 2 as b").fetchone()
+        for col in row:
+            pass
+
+    def CheckSqliteRowAsTuple(self):
+        """Checks if the row object can be converted to a tuple"""
+        self.con.row_factory = sqlite.Row
+        row = self.con.execute("select 1 as a, 2 as b").fetchone()
+        t = tuple(row)
+        self.assertEqual(t, (row['a'], row['b']))
+
+    def CheckSqliteRowAsDict(self):
+        """Checks if the row object can be correctly converted to a dictionary"""
+        self.con.row_factory = sqlite.Row
+        row = self.con.execute("select 1 as a, 2 as b").fetchone()
+        d = dict(row)
+        self.assertEqual(d["a"], row["a"])
+        self.assertEqual(d["b"], row["b"])
+
+    def CheckSqliteRowHashCmp(self):
+        """Checks if the row object compares and hashes correctly"""
+        self.con.row_factory = sqlite.Row
+        row_1 = self.con.execute("select 1 as a, 2 as b").fetchone()
+        row_2 = self.con.execute("select 1 as a, 2 as b").fetchone()
+        row_3 = self.con.execute("select 1 as a, 3 as b").fetchone()
+
+        self.assertEqual(row_1, row_1)
+        self.assertEqual(row_1, row_2)
+        self.assertTrue(row_2 != row_3)
+
+        self.assertFalse(row_1 != row_1)
+        self.assertFalse(row_1 != row_2)
+        self.assertFalse(row_2 == row_3)
+
+        self.assertEqual(row_1, row_2)
+        self.assertEqual(hash(row_1), hash(row_2))
+        self.assertNotEqual(row_1, row_3)
+        self.assertNotEqual(hash(row_1), hash(row_3))
+
+    def CheckSqliteRowAsSequence(self):
+        """ Checks if the row object can act like a sequence """
+        self.con.row_factory = sqlite.Row
+        row = self.con.execute("select 1 as a, 2 as b").fetchone()
+
+        as_tuple = tuple(row)
+        self.assertEqual(list(reversed(row)), list(reversed(as_tuple)))
+        self.assertIsInstance(row, Sequence)
+
+    def CheckRowUnicodeIndex(self):
+        """Checks if we can use Unicode strings as column index."""
+        self.con.row_factory = sqlite.Row
+        row = self.con.execute("select 5 as a").fetchone()
+        row[u"a"]
+
+    def CheckSqliteRowSlice(self):
+        self.con.row_factory = sqlite.Row
+        row = self.con.execute("select 1, 2, 3, 4, 5").fetchone()
+        self.assertEqual(row[1:3], (2, 3))
+        self.assertEqual(row[::2], (1, 3, 5))
+        self.assertEqual(row[::-1], (5, 4, 3, 2, 1))
+        self.assertEqual(row[-2:], (4, 5))
+        self.assertEqual(row[10:], ())
+        self.assertEqual(row[:], tuple(row))
+
+    def CheckSqliteRowAsdict(self):
+        self.con.row_factory = sqlite.Row
+        row = self.con.execute("select 1 as a, 'x' as b, 3 as a").fetchone()
+        self.assertEqual(row.asdict(), {"a": 1, "b": "x"})
+
+    def CheckSqliteRowHashValue(self):
+        self.con.row_factory = sqlite.Row
+        cur = self.con.execute("select 1 as a, 'x' as b, 2.5 as c, null as d")
+        row = cur.fetchone()
+        # the hash is the same as with the values kept in a tuple
+        self.assertEqual(hash(row), hash(cur.description) ^ hash(tuple(row)))
+        self.assertEqual(hash(row), hash(sqlite.Row(cur, tuple(row))))
+        self.assertRaises(TypeError, hash, sqlite.Row(cur, ([],)))
+
+    def CheckSqliteRowFetchMethods(self):
+        self.con.row_factory = sqlite.Row
+        sql = "select 1 as a union all select 2 union all select 3 union all select 4"
+        cur = self.con.execute(sql)
+        rows = [cur.fetchone()] + cur.fetchmany(2) + cur.fetchall()
+        rows += list(self.con.execute(sql))
+        self.assertEqual([row["a"] for row in rows], [1, 2, 3, 4] * 2)
+        for row in rows:
+            self.assertEqual(type(row), sqlite.Row)
+            self.assertEqual(row.keys(), ["a"])
+        self.assertEqual(rows[0], sqlite.Row(cur, (1,)))
+
+    def CheckSqliteRowSubclass(self):
+        created = []
+        class MyRow(sqlite.Row):
+            def __new__(cls, cursor, data):
+                created.append(data)
+                return sqlite.Row.__new__(cls, cursor, data)
+        self.con.row_factory = MyRow
+        rows = self.con.execute("select 1 as a union all select 2").fetchall()
+        self.assertEqual([type(row) for row in rows], [MyRow, MyRow])
+        self.assertEqual(created, [(1,), (2,)])
+
+    def CheckSqliteRowWideByName(self):
+        self.con.row_factory = sqlite.Row
+        columns = ["col%d" % i for i in range(100)]
+        sql = "select " + ", ".join("%d as %s" % (i, name) for i, name in enumerate(columns))
+        for _ in range(2):
+            rows = self.con.execute(sql + " union all " + sql).fetchall()
+            for row in rows:
+                for i, name in enumerate(columns):
+                    self.assertEqual(row[name], i)
+                    self.assertEqual(row[name.upper()], i)
+                    self.assertEqual(row[unicode(name)], i)
+        self.assertRaises(IndexError, lambda: rows[0]["col100"])
+        self.assertRaises(IndexError, lambda: rows[0][u"\xe4"])
+
+    def CheckSqliteRowDuplicateNames(self):
+        self.con.row_factory = sqlite.Row
+        row = self.con.execute("select 1 as a, 2 as A, 3 as b").fetchone()
+        self.assertEqual(row["A"], 1)
+        self.assertEqual(row["a"], 1)
+        self.assertEqual(row["B"], 3)
+
+    def CheckSqliteRowSchemaChange(self):
+        self.con.row_factory = sqlite.Row
+        self.con.execute("create table test(a)")
+        self.con.execute("insert into test(a) values (1)")
+        self.assertEqual(self.con.execute("select * from test").fetchone()["a"], 1)
+        self.con.execute("alter table test add column b default 2")
+        row = self.con.execute("select * from test").fetchone()
+        self.assertEqual((row["a"], row["B"]), (1, 2))
+
+    def CheckNamedRowAttributes(self):
+        self.con.row_factory = sqlite.NamedRow
+        row = self.con.execute("select 1 as id, 2.5 as Price, 'x' as keys").fetchone()
+        self.assertTrue(isinstance(row, sqlite.Row))
+        self.assertEqual((row.id, row.Price), (1, 2.5))
+        self.assertEqual((row[1], row["price"]), (2.5, 2.5))
+        self.assertEqual(row._fields, ("id", "Price", "keys"))
+        self.assertEqual(row.keys(), ["id", "Price", "keys"])
+        self.assertEqual(row.asdict()["keys"], "x")
+        self.assertRaises(AttributeError, lambda: row.price)
+        self.assertRaises(TypeError, setattr, row, "id", 2)
+        self.assertRaises(AttributeError, setattr, row, "other", 2)
+
+    def CheckNamedRowTypePerStatement(self):
+        self.con.row_factory = sqlite.NamedRow
+        rows = self.con.execute("select 1 as a union all select 2").fetchall()
+        rows.append(self.con.execute("select 3 as a").fetchone())
+        rows.append(self.con.execute("select 1 as a union all select 2").fetchone())
+        self.assertEqual([row.a for row in rows], [1, 2, 3, 1])
+        self.assertTrue(type(rows[0]) is type(rows[1]))
+        self.assertTrue(type(rows[0]) is type(rows[3]))
+        self.assertFalse(type(rows[0]) is type(rows[2]))
+        self.assertEqual(rows[0], rows[3])
+        self.assertEqual(hash(rows[0]), hash(rows[3]))
+
+    def CheckNamedRowDuplicateNames(self):
+        self.con.row_factory = sqlite.NamedRow
+        row = self.con.execute("select 1 as a, 2 as a, 3 as __b").fetchone()
+        self.assertEqual(row.a, 1)
+        self.assertEqual(row["__b"], 3)
+        self.assertFalse(hasattr(row, "__b"))
+
+    def CheckNamedRowCall(self):
+        cur = self.con.execute("select 1 as a, 2 as b")
+        row = sqlite.NamedRow(cur, (3, 4))
+        self.assertEqual((row.a, row.b), (3, 4))
+        self.assertEqual(type(row)(cur, (5, 6)).b, 6)
+        self.assertRaises(ValueError, type(row), cur, (5,))
+
+    def CheckNamedRowMemberOfOtherType(self):
+        self.con.row_factory = sqlite.NamedRow
+        wide = self.con.execute("select 1 as a, 2 as b, 3 as c").fetchone()
+        narrow = self.con.execute("select 1 as a").fetchone()
+        member = type(wide).__dict__["c"]
+        self.assertEqual(member.__get__(wide), 3)
+        self.assertRaises(TypeError, member.__get__, narrow)
+        self.assertRaises(TypeError, member.__get__, sqlite.Row(self.con.cursor(), ()))
+
+    def CheckNamedRowClassAttributesRebound(self):
+        self.con.row_factory = sqlite.NamedRow
+        cur = self.con.execute("select 1 as a, 2 as price")
+        row = cur.fetchone()
+        cls = type(row)
+        cls._fields = None
+        gc.collect()
+        self.assertEqual((row.a, row.price), (1, 2))
+        self.assertRaises(ValueError, cls, cur, (5,))
+        with self.assertRaises(TypeError):
+            class Sub(cls):
+                pass
+
+    def CheckNamedRowNotTracked(self):
+        self.con.row_factory = sqlite.NamedRow
+        row = self.con.execute("select 1 as a, 2 as b").fetchone()
+        self.assertFalse(gc.is_tracked(row))
+        self.assertEqual(sys.getsizeof(row), sys.getsizeof(sqlite.Row(self.con.cursor(), (1, 2))))
+
+    def tearDown(self):
+        self.con.close()
+
+class TextFactoryTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+
+    def CheckUnicode(self):
+        austria = unicode("sterreich", "latin1")
+        row = self.con.execute("select ?", (austria,)).fetchone()
+        self.assertEqual(type(row[0]), unicode, "type of row[0] must be unicode")
+
+    def CheckString(self):
+        self.con.text_factory = str
+        austria = unicode("sterreich", "latin1")
+        row = self.con.execute("select ?", (austria,)).fetchone()
+        self.assertEqual(type(row[0]), str, "type of row[0] must be str")
+        self.assertEqual(row[0], austria.encode("utf-8"), "column must equal original data in UTF-8")
+
+    def CheckCustom(self):
+        self.con.text_factory = lambda x: unicode(x, "utf-8", "ignore")
+        austria = unicode("sterreich", "latin1")
+        row = self.con.execute("select ?", (austria.encode("latin1"),)).fetchone()
+        self.assertEqual(type(row[0]), unicode, "type of row[0] must be unicode")
+        self.assertTrue(row[0].endswith(u"reich"), "column must contain original data")
+
+    def CheckOptimizedUnicode(self):
+        self.con.text_factory = sqlite.OptimizedUnicode
+        austria = unicode("sterreich", "latin1")
+        germany = unicode("Deutchland")
+        a_row = self.con.execute("select ?", (austria,)).fetchone()
+        d_row = self.con.execute("select ?", (germany,)).fetchone()
+        self.assertEqual(type(a_row[0]), unicode, "type of non-ASCII row must be unicode")
+        self.assertEqual(type(d_row[0]), str, "type of ASCII-only row must be str")
+
+    def tearDown(self):
+        self.con.close()
+
+class TextFactoryTestsWithEmbeddedZeroBytes(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+        self.con.execute("create table test (value text)")
+        self.con.execute("insert into test (value) values (?)", ("a\x00b",))
+
+    def CheckString(self):
+        # text_factory defaults to unicode
+        row = self.con.execute("select value from test").fetchone()
+        self.assertIs(type(row[0]), unicode)
+        self.assertEqual(row[0], "a\x00b")
+
+    def CheckCustom(self):
+        # A custom factory should receive an str argument
+        self.con.text_factory = lambda x: x
+        row = self.con.execute("select value from test").fetchone()
+        self.assertIs(type(row[0]), str)
+        self.assertEqual(row[0], "a\x00b")
+
+    def CheckOptimizedUnicodeAsString(self):
+        # ASCII -> str argument
+        self.con.text_factory = sqlite.OptimizedUnicode
+        row = self.con.execute("select value from test").fetchone()
+        self.assertIs(type(row[0]), str)
+        self.assertEqual(row[0], "a\x00b")
+
+    def CheckOptimizedUnicodeAsUnicode(self):
+        # Non-ASCII -> unicode argument
+        self.con.text_factory = sqlite.OptimizedUnicode
+        self.con.execute("delete from test")
+        self.con.execute("insert into test (value) values (?)", (u'\0',))
+        row = self.con.execute("select value from test").fetchone()
+        self.assertIs(type(row[0]), unicode)
+        self.assertEqual(row[0], u"\x00")
+
+    def tearDown(self):
+        self.con.close()
+
+def suite():
+    connection_suite = unittest.makeSuite(ConnectionFactoryTests, "Check")
+    cursor_suite = unittest.makeSuite(CursorFactoryTests, "Check")
+    row_suite = unittest.makeSuite(RowFactoryTests, "Check")
+    text_suite = unittest.makeSuite(TextFactoryTests, "Check")
+    text_zero_bytes_suite = unittest.makeSuite(TextFactoryTestsWithEmbeddedZeroBytes, "Check")
+    return unittest.TestSuite((connection_suite, cursor_suite, row_suite, text_suite, text_zero_bytes_suite))
+
+def test():
+    runner = unittest.TextTestRunner()
+    runner.run(suite())
+
+if __name__ == "__main__":
+    test()
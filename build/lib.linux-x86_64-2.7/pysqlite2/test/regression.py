@@ -0,0 +1,507 @@
+#-*- coding: ISO-8859-1 -*-
+# pysqlite2/test/regression.py: pysqlite regression tests
+#
+# Copyright (C) 2006-2015 Gerhard H�ring <gh@ghaering.de>
+#
+# This file is part of pysqlite.
+#
+# This software is provided 'as-is', without any express or implied
+# warranty.  In no event will the authors be held liable for any damages
+# arising from the use of this software.
+#
+# Permission is granted to anyone to use this software for any purpose,
+# including commercial applications, and to alter it and redistribute it
+# freely, subject to the following restrictions:
+#
+# 1. The origin of this software must not be misrepresented; you must not
+#    claim that you wrote the original software. If you use this software
+#    in a product, an acknowledgment in the product documentation would be
+#    appreciated but is not required.
+# 2. Altered source versions must be plainly marked as such, and must not be
+#    misrepresented as being the original software.
+# 3. This notice may not be removed or altered from any source distribution.
+
+import datetime
+import unittest
+import pysqlite2.dbapi2 as sqlite
+
+class CountingConnection(sqlite.Connection):
+    """Records the SQL of the statements it prepares."""
+    def __init__(self, *args, **kwargs):
+        self.prepared = []
+        sqlite.Connection.__init__(self, *args, **kwargs)
+
+    def __call__(self, sql):
+        self.prepared.append(sql)
+        return sqlite.Connection.__call__(self, sql)
+
+class RegressionTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+
+    def tearDown(self):
+        self.con.close()
+
+    def CheckPragmaUserVersion(self):
+        # This used to crash pysqlite because this pragma command returns NULL for the column name
+        cur = self.con.cursor()
+        cur.execute("pragma user_version")
+
+    def CheckPragmaSchemaVersion(self):
+        # This still crashed pysqlite <= 2.2.1
+        con = sqlite.connect(":memory:", detect_types=sqlite.PARSE_COLNAMES)
+        try:
+            cur = self.con.cursor()
+            cur.execute("pragma schema_version")
+        finally:
+            cur.close()
+            con.close()
+
+    def CheckStatementReset(self):
+        # pysqlite 2.1.0 to 2.2.0 have the problem that not all statements are
+        # reset before a rollback, but only those that are still in the
+        # statement cache. The others are not accessible from the connection object.
+        con = sqlite.connect(":memory:", cached_statements=5)
+        cursors = [con.cursor() for x in xrange(5)]
+        cursors[0].execute("create table test(x)")
+        for i in range(10):
+            cursors[0].executemany("insert into test(x) values (?)", [(x,) for x in xrange(10)])
+
+        for i in range(5):
+            cursors[i].execute(" " * i + "select x from test")
+
+        con.rollback()
+
+    def _make_cache(self, size, policy="lfu"):
+        """Returns a Cache whose factory returns the key, and the list of keys
+        the factory was called with."""
+        created = []
+        def factory(key):
+            created.append(key)
+            return key
+        return sqlite.Cache(factory, size, policy), created
+
+    def CheckCachePolicyLRU(self):
+        cache, created = self._make_cache(5, "lru")
+        for key in range(5) + [0, 5, 0, 1]:
+            self.assertEqual(cache.get(key), key)
+        # 1 was the least recently used entry when 5 was added
+        self.assertEqual(created, [0, 1, 2, 3, 4, 5, 1])
+
+    def CheckCachePolicyLFU(self):
+        cache, created = self._make_cache(5, "lfu")
+        for key in range(5) + [0, 0, 1, 5, 4, 0, 1]:
+            self.assertEqual(cache.get(key), key)
+        # 4 was evicted for 5, being the least frequently used entry added last
+        self.assertEqual(created, [0, 1, 2, 3, 4, 5, 4])
+
+    def CheckCacheEqualKeys(self):
+        cache, created = self._make_cache(5)
+        cache.get("select 1")
+        cache.get("".join(["select", " ", "1"]))
+        cache.get(u"select 1")
+        self.assertEqual(created, ["select 1"])
+
+    def CheckCachePin(self):
+        for policy in ("lfu", "lru"):
+            cache, created = self._make_cache(5, policy)
+            cache.pin("hot")
+            # pinned entries don't take space from the others
+            for key in range(5) + range(5) + ["hot"]:
+                cache.get(key)
+            self.assertEqual(created, ["hot", 0, 1, 2, 3, 4])
+            for key in range(20):
+                cache.get(key)
+            self.assertEqual(cache.get("hot"), "hot")
+            self.assertEqual(created.count("hot"), 1)
+            cache.unpin("hot")
+            cache.unpin("missing")
+            for key in range(20, 25):
+                cache.get(key)
+            if policy == "lru":
+                cache.get("hot")
+                self.assertEqual(created.count("hot"), 2)
+
+    def CheckCacheUnpinOrder(self):
+        cache, created = self._make_cache(5, "lfu")
+        cache.pin("hot")
+        for key in range(4) + [0, 0, 1]:
+            cache.get(key)
+        cache.get("hot")
+        cache.unpin("hot")
+        # "hot" has been used once while pinned, more often than 2 and 3
+        cache.get(4)
+        del created[:]
+        cache.get("hot")
+        cache.get(3)
+        self.assertEqual(created, [3])
+
+    def CheckPinStatement(self):
+        con = sqlite.connect(":memory:", cached_statements=5)
+        con.pin_statement("select 1")
+        cur = con.execute("select 1")
+        # the pinned statement is in use, so a second cursor gets its own
+        self.assertEqual(con.execute("select 1").fetchone(), (1,))
+        self.assertEqual(cur.fetchone(), (1,))
+        con.unpin_statement("select 1")
+        self.assertRaises(sqlite.OperationalError, con.pin_statement, "select * from missing")
+        con.close()
+        self.assertRaises(sqlite.ProgrammingError, con.pin_statement, "select 1")
+
+    def CheckCachePolicyConnect(self):
+        con = sqlite.connect(":memory:", cached_statements=5, cache_policy="lru")
+        for i in range(20):
+            self.assertEqual(con.execute("select %d" % (i % 7)).fetchone(), (i % 7,))
+        con.close()
+        self.assertRaises(ValueError, sqlite.connect, ":memory:", cache_policy="fifo")
+
+    def CheckPrepareOnConnect(self):
+        hot = ["select 1", "select 2"]
+        con = sqlite.connect(":memory:", factory=CountingConnection, cached_statements=5, prepare=hot)
+        self.assertEqual(con.prepared, hot)
+        for i in range(20):
+            con.execute("select %d" % (i + 10))
+        del con.prepared[:]
+        self.assertEqual(con.execute("select 1").fetchone(), (1,))
+        self.assertEqual(con.execute("select 2").fetchone(), (2,))
+        self.assertEqual(con.prepared, [])
+        con.close()
+        self.assertRaises(sqlite.OperationalError, sqlite.connect, ":memory:", prepare=["select * from missing"])
+
+    def CheckNestedCursorsSameStatement(self):
+        con = sqlite.connect(":memory:", factory=CountingConnection)
+        con.execute("create table test(x)")
+        con.executemany("insert into test(x) values (?)", [(i,) for i in range(10)])
+        sql = "select x from test where x >= ?"
+        count = 0
+        for x, in con.execute(sql, (0,)):
+            for y, in con.execute(sql, (x,)):
+                count += 1
+        self.assertEqual(count, 55)
+        # the outer and the inner cursor each reuse one prepared statement
+        self.assertEqual(con.prepared.count(sql), 2)
+        con.close()
+
+    def CheckSpareStatementEvictsNode(self):
+        sql = "select x from test where x >= ?"
+        class EvictingConnection(CountingConnection):
+            def __call__(self, s):
+                if s == sql and s in self.prepared:
+                    # push the statement for sql out of the cache
+                    for i in range(5):
+                        self.execute("select %d" % i)
+                return CountingConnection.__call__(self, s)
+        con = sqlite.connect(":memory:", factory=EvictingConnection, cached_statements=2)
+        con.execute("create table test(x)")
+        con.executemany("insert into test(x) values (?)", [(i,) for i in range(3)])
+        count = 0
+        for x, in con.execute(sql, (0,)):
+            for y, in con.execute(sql, (x,)):
+                count += 1
+        self.assertEqual(count, 6)
+        con.close()
+
+    def CheckFetchmanyDrainsResult(self):
+        con = sqlite.connect(":memory:", factory=CountingConnection)
+        sql = "select 1 union all select 2 union all select 3"
+        cur = con.execute(sql)
+        self.assertEqual(cur.fetchmany(3), [(1,), (2,), (3,)])
+        # the statement was released by fetchmany(), so it is not prepared again
+        self.assertEqual(con.execute(sql).fetchall(), [(1,), (2,), (3,)])
+        self.assertEqual(con.prepared.count(sql), 1)
+        self.assertEqual(cur.fetchmany(3), [])
+        con.close()
+
+    def CheckColumnNameWithSpaces(self):
+        cur = self.con.cursor()
+        cur.execute('select 1 as "foo bar [datetime]"')
+        self.assertEqual(cur.description[0][0], "foo bar")
+
+        cur.execute('select 1 as "foo baz"')
+        self.assertEqual(cur.description[0][0], "foo baz")
+
+    def CheckStatementFinalizationOnCloseDb(self):
+        # pysqlite versions <= 2.3.3 only finalized statements in the statement
+        # cache when closing the database. statements that were still
+        # referenced in cursors weren't closed an could provoke "
+        # "OperationalError: Unable to close due to unfinalised statements".
+        con = sqlite.connect(":memory:")
+        cursors = []
+        # default statement cache size is 100
+        for i in range(105):
+            cur = con.cursor()
+            cursors.append(cur)
+            cur.execute("select 1 x union select " + str(i))
+        con.close()
+
+    def CheckOnConflictRollback(self):
+        con = sqlite.connect(":memory:")
+        con.execute("create table foo(x, unique(x) on conflict rollback)")
+        con.execute("insert into foo(x) values (1)")
+        try:
+            con.execute("insert into foo(x) values (1)")
+        except sqlite.DatabaseError:
+            pass
+        con.execute("insert into foo(x) values (2)")
+        try:
+            con.commit()
+        except sqlite.OperationalError:
+            self.fail("pysqlite knew nothing about the implicit ROLLBACK")
+
+    def CheckWorkaroundForBuggySqliteTransferBindings(self):
+        """
+        pysqlite would crash with older SQLite versions unless
+        a workaround is implemented.
+        """
+        self.con.execute("create table foo(bar)")
+        self.con.execute("drop table foo")
+        self.con.execute("create table foo(bar)")
+
+    def CheckEmptyStatement(self):
+        """
+        pysqlite used to segfault with SQLite versions 3.5.x. These return NULL
+        for "no-operation" statements
+        """
+        self.con.execute("")
+
+    def CheckUnicodeConnect(self):
+        """
+        With pysqlite 2.4.0 you needed to use a string or a APSW connection
+        object for opening database connections.
+
+        Formerly, both bytestrings and unicode strings used to work.
+
+        Let's make sure unicode strings work in the future.
+        """
+        con = sqlite.connect(u":memory:")
+        con.close()
+
+    def CheckTypeMapUsage(self):
+        """
+        pysqlite until 2.4.1 did not rebuild the row_cast_map when recompiling
+        a statement. This test exhibits the problem.
+        """
+        SELECT = "select * from foo"
+        con = sqlite.connect(":memory:",detect_types=sqlite.PARSE_DECLTYPES)
+        con.execute("create table foo(bar timestamp)")
+        con.execute("insert into foo(bar) values (?)", (datetime.datetime.now(),))
+        con.execute(SELECT)
+        con.execute("drop table foo")
+        con.execute("create table foo(bar integer)")
+        con.execute("insert into foo(bar) values (5)")
+        con.execute(SELECT)
+
+    def CheckRegisterAdapter(self):
+        """
+        See issue 3312.
+        """
+        self.assertRaises(TypeError, sqlite.register_adapter, {}, None)
+
+    def CheckSetIsolationLevel(self):
+        """
+        See issue 3312.
+        """
+        con = sqlite.connect(":memory:")
+        self.assertRaises(UnicodeEncodeError, setattr, con,
+                          "isolation_level", u"\xe9")
+
+    def CheckCursorConstructorCallCheck(self):
+        """
+        Verifies that cursor methods check whether base class __init__ was
+        called.
+        """
+        class Cursor(sqlite.Cursor):
+            def __init__(self, con):
+                pass
+
+        con = sqlite.connect(":memory:")
+        cur = Cursor(con)
+        try:
+            cur.execute("select 4+5").fetchall()
+            self.fail("should have raised ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+        except:
+            self.fail("should have raised ProgrammingError")
+
+    def CheckConnectionConstructorCallCheck(self):
+        """
+        Verifies that connection methods check whether base class __init__ was
+        called.
+        """
+        class Connection(sqlite.Connection):
+            def __init__(self, name):
+                pass
+
+        con = Connection(":memory:")
+        try:
+            cur = con.cursor()
+            self.fail("should have raised ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+        except:
+            self.fail("should have raised ProgrammingError")
+
+    def CheckCursorRegistration(self):
+        """
+        Verifies that subclassed cursor classes are correctly registered with
+        the connection object, too.  (fetch-across-rollback problem)
+        """
+        class Connection(sqlite.Connection):
+            def cursor(self):
+                return Cursor(self)
+
+        class Cursor(sqlite.Cursor):
+            def __init__(self, con):
+                sqlite.Cursor.__init__(self, con)
+
+        con = Connection(":memory:")
+        cur = con.cursor()
+        cur.execute("create table foo(x)")
+        cur.executemany("insert into foo(x) values (?)", [(3,), (4,), (5,)])
+        cur.execute("select x from foo")
+        con.rollback()
+        try:
+            cur.fetchall()
+            self.fail("should have raised InterfaceError")
+        except sqlite.InterfaceError:
+            pass
+        except:
+            self.fail("should have raised InterfaceError")
+
+    def CheckAutoCommit(self):
+        """
+        Verifies that creating a connection in autocommit mode works.
+        2.5.3 introduced a regression so that these could no longer
+        be created.
+        """
+        con = sqlite.connect(":memory:", isolation_level=None)
+
+    def CheckPragmaAutocommit(self):
+        """
+        Verifies that running a PRAGMA statement that does an autocommit does
+        work. This did not work in 2.5.3/2.5.4.
+        """
+        cur = self.con.cursor()
+        cur.execute("create table foo(bar)")
+        cur.execute("insert into foo(bar) values (5)")
+
+        cur.execute("pragma page_size")
+        row = cur.fetchone()
+
+    def CheckSetDict(self):
+        """
+        See http://bugs.python.org/issue7478
+
+        It was possible to successfully register callbacks that could not be
+        hashed. Return codes of PyDict_SetItem were not checked properly.
+        """
+        class NotHashable:
+            def __call__(self, *args, **kw):
+                pass
+            def __hash__(self):
+                raise TypeError()
+        var = NotHashable()
+        self.assertRaises(TypeError, self.con.create_function, var)
+        self.assertRaises(TypeError, self.con.create_aggregate, var)
+        self.assertRaises(TypeError, self.con.set_authorizer, var)
+        self.assertRaises(TypeError, self.con.set_progress_handler, var)
+
+    def CheckConnectionCall(self):
+        """
+        Call a connection with a non-string SQL request: check error handling
+        of the statement constructor.
+        """
+        self.assertRaises(sqlite.Warning, self.con, 1)
+
+    def CheckRecursiveCursorUse(self):
+        """
+        http://bugs.python.org/issue10811
+
+        Recursively using a cursor, such as when reusing it from a generator led to segfaults.
+        Now we catch recursive cursor usage and raise a ProgrammingError.
+        """
+        con = sqlite.connect(":memory:")
+
+        cur = con.cursor()
+        cur.execute("create table a (bar)")
+        cur.execute("create table b (baz)")
+
+        def foo():
+            cur.execute("insert into a (bar) values (?)", (1,))
+            yield 1
+
+        with self.assertRaises(sqlite.ProgrammingError):
+            cur.executemany("insert into b (baz) values (?)",
+                            ((i,) for i in foo()))
+
+    def CheckCommitCursorReset(self):
+        """
+        See http://bugs.python.org/issueXXXX
+
+        Connection.commit() did reset cursors, which made pysqlite to return
+        rows multiple times when fetched from cursors after commit.
+        """
+        con = sqlite.connect(":memory:")
+        con.executescript("""
+        create table t(c);
+        create table t2(c);
+        insert into t values(0);
+        insert into t values(1);
+        insert into t values(2);
+        """)
+
+        cur = con.cursor()
+        counter = 0
+        for idx, row in enumerate(con.execute("select c from t")):
+            con.execute("insert into t2(c) values (?)", (idx,))
+            con.commit()
+
+            if counter == 0:
+                self.assertEqual(row[0], 0)
+            elif counter == 1:
+                self.assertEqual(row[0], 1)
+            elif counter == 2:
+                self.assertEqual(row[0], 2)
+            else:
+                self.fail("should have returned exactly three rows")
+
+            counter += 1
+
+    def CheckInvalidIsolationLevelType(self):
+        # isolation level is a string, not an integer
+        self.assertRaises(TypeError,
+                          sqlite.connect, ":memory:", isolation_level=123)
+
+    def CheckNullCharacter(self):
+        # Issue #21147
+        con = sqlite.connect(":memory:")
+        self.assertRaises(ValueError, con, "\0select 1")
+        self.assertRaises(ValueError, con, "select 1\0")
+        cur = con.cursor()
+        self.assertRaises(ValueError, cur.execute, " \0select 2")
+        self.assertRaises(ValueError, cur.execute, "select 2\0")
+
+    def CheckNonSelectCursorDescription(self):
+        # https://github.com/ghaering/pysqlite/issues/104
+        con = sqlite.connect(":memory:")
+        cur = con.cursor()
+        cur.execute("create table test as select 1 foo")
+        self.assertEqual(cur.description, None)
+        cur.execute("delete from test")
+        self.assertEqual(cur.description, None)
+        cur.execute("insert into test values (1)")
+        self.assertEqual(cur.description, None)
+        cur.execute("update test set foo=2")
+        self.assertEqual(cur.description, None)
+
+def suite():
+    regression_suite = unittest.makeSuite(RegressionTests, "Check")
+    return unittest.TestSuite((regression_suite,))
+
+def test():
+    runner = unittest.TextTestRunner()
+    runner.run(suite())
+
+if __name__ == "__main__":
+    test()
@@ -0,0 +1,729 @@
+#-*- coding: ISO-8859-1 -*-
+# pysqlite2/test/types.py: tests for type conversion and detection
+#
+# Copyright (C) 2005-2015 Gerhard Hring <gh@ghaering.de>
+#
+# This file is part of pysqlite.
+#
+# This software is provided 'as-is', without any express or implied
+# warranty.  In no event will the authors be held liable for any damages
+# arising from the use of this software.
+#
+# Permission is granted to anyone to use this software for any purpose,
+# including commercial applications, and to alter it and redistribute it
+# freely, subject to the following restrictions:
+#
+# 1. The origin of this software must not be misrepresented; you must not
+#    claim that you wrote the original software. If you use this software
+#    in a product, an acknowledgment in the product documentation would be
+#    appreciated but is not required.
+# 2. Altered source versions must be plainly marked as such, and must not be
+#    misrepresented as being the original software.
+# 3. This notice may not be removed or altered from any source distribution.
+
+import datetime
+import gc
+import unittest
+import weakref
+import pysqlite2.dbapi2 as sqlite
+try:
+    import zlib
+except:
+    zlib = None
+
+
+class SqliteTypeTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+        self.cur = self.con.cursor()
+        self.cur.execute("create table test(i integer, s varchar, f number, b blob)")
+
+    def tearDown(self):
+        self.cur.close()
+        self.con.close()
+
+    def CheckString(self):
+        self.cur.execute("insert into test(s) values (?)", (u"sterreich",))
+        self.cur.execute("select s from test")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], u"sterreich")
+
+    def CheckSmallInt(self):
+        self.cur.execute("insert into test(i) values (?)", (42,))
+        self.cur.execute("select i from test")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], 42)
+
+    def CheckLargeInt(self):
+        num = 2**40
+        self.cur.execute("insert into test(i) values (?)", (num,))
+        self.cur.execute("select i from test")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], num)
+
+    def CheckFloat(self):
+        val = 3.14
+        self.cur.execute("insert into test(f) values (?)", (val,))
+        self.cur.execute("select f from test")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], val)
+
+    def CheckBlob(self):
+        val = buffer("Guglhupf")
+        self.cur.execute("insert into test(b) values (?)", (val,))
+        self.cur.execute("select b from test")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], val)
+
+    def CheckBlobBytearray(self):
+        self.cur.execute("insert into test(b) values (?)", (bytearray("Guglhupf"),))
+        self.cur.execute("select b from test")
+        self.assertEqual(str(self.cur.fetchone()[0]), "Guglhupf")
+
+    def CheckBlobMemoryview(self):
+        self.cur.execute("insert into test(b) values (?)", (memoryview("Guglhupf")[4:],))
+        self.cur.execute("select b from test")
+        self.assertEqual(str(self.cur.fetchone()[0]), "hupf")
+
+    def CheckBlobEmptyBytearray(self):
+        self.cur.execute("select ?", (bytearray(),))
+        self.assertEqual(str(self.cur.fetchone()[0]), "")
+
+    def CheckBlobPinned(self):
+        val = bytearray("Guglhupf")
+        self.cur.execute("select length(?) union all select 1", (val,))
+        with self.assertRaises(BufferError):
+            val.extend("!")
+        self.assertEqual(self.cur.fetchall(), [(8,), (1,)])
+        val.extend("!")
+
+    def CheckUnicodeExecute(self):
+        self.cur.execute(u"select 'sterreich'")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], u"sterreich")
+
+    def CheckNonUtf8_Default(self):
+        try:
+            self.cur.execute("select ?", (chr(150),))
+            self.fail("should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+
+    def CheckNonUtf8_TextFactoryString(self):
+        orig_text_factory = self.con.text_factory
+        try:
+            self.con.text_factory = str
+            self.cur.execute("select ?", (chr(150),))
+        finally:
+            self.con.text_factory = orig_text_factory
+
+    def CheckNonUtf8_TextFactoryOptimizedUnicode(self):
+        orig_text_factory = self.con.text_factory
+        try:
+            try:
+                self.con.text_factory = sqlite.OptimizedUnicode
+                self.cur.execute("select ?", (chr(150),))
+                self.fail("should have raised a ProgrammingError")
+            except sqlite.ProgrammingError:
+                pass
+        finally:
+            self.con.text_factory = orig_text_factory
+
+    def CheckBinaryString(self):
+        bin_string = u"foo\x00bar"
+        self.cur.execute("select ?", (bin_string,))
+        self.assertEqual(self.cur.fetchone()[0], bin_string)
+
+    def CheckBinaryByteString(self):
+        bin_string = "bla\x00bla"
+        self.cur.execute("select ?", (bin_string,))
+        self.assertEqual(self.cur.fetchone()[0], bin_string)
+
+class DeclTypesTests(unittest.TestCase):
+    class Foo:
+        def __init__(self, _val):
+            self.val = _val
+
+        def __cmp__(self, other):
+            if not isinstance(other, DeclTypesTests.Foo):
+                raise ValueError
+            if self.val == other.val:
+                return 0
+            else:
+                return 1
+
+        def __conform__(self, protocol):
+            if protocol is sqlite.PrepareProtocol:
+                return self.val
+            else:
+                return None
+
+        def __str__(self):
+            return "<%s>" % self.val
+
+    def setUp(self):
+        self.con = sqlite.connect(":memory:", detect_types=sqlite.PARSE_DECLTYPES)
+        self.cur = self.con.cursor()
+        self.cur.execute("create table test(i int, s str, f float, b bool, u unicode, foo foo, bin blob, n1 number, n2 number(5))")
+
+        # override float, make them always return the same number
+        sqlite.converters["FLOAT"] = lambda x: 47.2
+
+        # and implement two custom ones
+        sqlite.converters["BOOL"] = lambda x: bool(int(x))
+        sqlite.converters["FOO"] = DeclTypesTests.Foo
+        sqlite.converters["WRONG"] = lambda x: "WRONG"
+        sqlite.converters["NUMBER"] = float
+        sqlite.converters["TEXT"] = str
+
+    def tearDown(self):
+        del sqlite.converters["FLOAT"]
+        del sqlite.converters["BOOL"]
+        del sqlite.converters["FOO"]
+        del sqlite.converters["NUMBER"]
+        self.cur.close()
+        self.con.close()
+
+    def CheckString(self):
+        # default
+        self.cur.execute("insert into test(s) values (?)", ("foo",))
+        self.cur.execute('select s as "s [WRONG]" from test')
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], "foo")
+
+    def CheckTextEmptyString(self):
+        """
+        Make sure that empty strings are converted to empty strings and not to None.
+        """
+        self.cur.execute("insert into test(s) values (?)", ("",))
+        self.cur.execute("insert into test(s) values (?)", (None,))
+        self.cur.execute('select s as "s [TEXT]" from test')
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], "")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], None)
+
+
+    def CheckSmallInt(self):
+        # default
+        self.cur.execute("insert into test(i) values (?)", (42,))
+        self.cur.execute("select i from test")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], 42)
+
+    def CheckLargeInt(self):
+        # default
+        num = 2**40
+        self.cur.execute("insert into test(i) values (?)", (num,))
+        self.cur.execute("select i from test")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], num)
+
+    def CheckFloat(self):
+        # custom
+        val = 3.14
+        self.cur.execute("insert into test(f) values (?)", (val,))
+        self.cur.execute("select f from test")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], 47.2)
+
+    def CheckBool(self):
+        # custom
+        self.cur.execute("insert into test(b) values (?)", (False,))
+        self.cur.execute("select b from test")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], False)
+
+        self.cur.execute("delete from test")
+        self.cur.execute("insert into test(b) values (?)", (True,))
+        self.cur.execute("select b from test")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], True)
+
+    def CheckUnicode(self):
+        # default
+        val = u"\xd6sterreich"
+        self.cur.execute("insert into test(u) values (?)", (val,))
+        self.cur.execute("select u from test")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], val)
+
+    def CheckFoo(self):
+        val = DeclTypesTests.Foo("bla")
+        self.cur.execute("insert into test(foo) values (?)", (val,))
+        self.cur.execute("select foo from test")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], val)
+
+    def CheckUnsupportedSeq(self):
+        class Bar: pass
+        val = Bar()
+        try:
+            self.cur.execute("insert into test(f) values (?)", (val,))
+            self.fail("should have raised an InterfaceError")
+        except sqlite.InterfaceError:
+            pass
+        except:
+            self.fail("should have raised an InterfaceError")
+
+    def CheckUnsupportedDict(self):
+        class Bar: pass
+        val = Bar()
+        try:
+            self.cur.execute("insert into test(f) values (:val)", {"val": val})
+            self.fail("should have raised an InterfaceError")
+        except sqlite.InterfaceError:
+            pass
+        except:
+            self.fail("should have raised an InterfaceError")
+
+    def CheckBlob(self):
+        # default
+        val = buffer("Guglhupf")
+        self.cur.execute("insert into test(bin) values (?)", (val,))
+        self.cur.execute("select bin from test")
+        row = self.cur.fetchone()
+        self.assertEqual(row[0], val)
+
+    def CheckFetchallManyRows(self):
+        """Checks that converters are applied to all rows fetched in bulk"""
+        self.cur.executemany("insert into test(n1, b) values (?, ?)", [(i, i % 2) for i in range(600)])
+        self.cur.execute("select n1, b from test")
+        rows = self.cur.fetchall()
+        self.assertEqual(len(rows), 600)
+        self.assertEqual(rows[599], (599.0, True))
+        self.assertEqual(type(rows[599][0]), float)
+
+    def CheckConverterChangedBetweenExecutions(self):
+        self.cur.execute("insert into test(b) values (?)", (1,))
+        self.assertEqual(self.cur.execute("select b from test").fetchone()[0], True)
+        sqlite.converters["BOOL"] = lambda x: "changed"
+        self.assertEqual(self.cur.execute("select b from test").fetchone()[0], "changed")
+        sqlite.converters.update({"BOOL": lambda x: "updated"})
+        self.assertEqual(self.cur.execute("select b from test").fetchone()[0], "updated")
+        del sqlite.converters["BOOL"]
+        self.assertEqual(self.cur.execute("select b from test").fetchone()[0], 1)
+        sqlite.converters["BOOL"] = lambda x: bool(int(x))
+
+    def CheckConverterAfterSchemaChange(self):
+        self.cur.execute("create table schema_change(x bool)")
+        self.cur.execute("insert into schema_change(x) values (1)")
+        self.assertEqual(self.cur.execute("select x from schema_change").fetchone()[0], True)
+        self.cur.execute("drop table schema_change")
+        self.cur.execute("create table schema_change(x number)")
+        self.cur.execute("insert into schema_change(x) values (1)")
+        value = self.cur.execute("select x from schema_change").fetchone()[0]
+        self.assertEqual(type(value), float)
+
+    def CheckNumber1(self):
+        self.cur.execute("insert into test(n1) values (5)")
+        value = self.cur.execute("select n1 from test").fetchone()[0]
+        # if the converter is not used, it's an int instead of a float
+        self.assertEqual(type(value), float)
+
+    def CheckNumber2(self):
+        """Checks whether converter names are cut off at '(' characters"""
+        self.cur.execute("insert into test(n2) values (5)")
+        value = self.cur.execute("select n2 from test").fetchone()[0]
+        # if the converter is not used, it's an int instead of a float
+        self.assertEqual(type(value), float)
+
+class ColNamesTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:", detect_types=sqlite.PARSE_COLNAMES)
+        self.cur = self.con.cursor()
+        self.cur.execute("create table test(x foo)")
+
+        sqlite.converters["FOO"] = lambda x: "[%s]" % x
+        sqlite.converters["BAR"] = lambda x: "<%s>" % x
+        sqlite.converters["EXC"] = lambda x: 5 // 0
+        sqlite.converters["B1B1"] = lambda x: "MARKER"
+
+    def tearDown(self):
+        del sqlite.converters["FOO"]
+        del sqlite.converters["BAR"]
+        del sqlite.converters["EXC"]
+        del sqlite.converters["B1B1"]
+        self.cur.close()
+        self.con.close()
+
+    def CheckDeclTypeNotUsed(self):
+        """
+        Assures that the declared type is not used when PARSE_DECLTYPES
+        is not set.
+        """
+        self.cur.execute("insert into test(x) values (?)", ("xxx",))
+        self.cur.execute("select x from test")
+        val = self.cur.fetchone()[0]
+        self.assertEqual(val, "xxx")
+
+    def CheckNone(self):
+        self.cur.execute("insert into test(x) values (?)", (None,))
+        self.cur.execute("select x from test")
+        val = self.cur.fetchone()[0]
+        self.assertEqual(val, None)
+
+    def CheckColName(self):
+        self.cur.execute("insert into test(x) values (?)", ("xxx",))
+        self.cur.execute('select x as "x [bar]" from test')
+        val = self.cur.fetchone()[0]
+        self.assertEqual(val, "<xxx>")
+
+        # Check if the stripping of colnames works. Everything after the first
+        # whitespace should be stripped.
+        self.assertEqual(self.cur.description[0][0], "x")
+
+    def CheckCaseInConverterName(self):
+        self.cur.execute("""select 'other' as "x [b1b1]\"""")
+        val = self.cur.fetchone()[0]
+        self.assertEqual(val, "MARKER")
+
+    def CheckCursorDescriptionNoRow(self):
+        """
+        cursor.description should at least provide the column name(s), even if
+        no row returned.
+        """
+        self.cur.execute("select * from test where 0 = 1")
+        self.assertEqual(self.cur.description[0][0], "x")
+
+class ObjectAdaptationTests(unittest.TestCase):
+    def cast(obj):
+        return float(obj)
+    cast = staticmethod(cast)
+
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+        try:
+            del sqlite.adapters[int]
+        except:
+            pass
+        sqlite.register_adapter(int, ObjectAdaptationTests.cast)
+        self.cur = self.con.cursor()
+
+    def tearDown(self):
+        del sqlite.adapters[(int, sqlite.PrepareProtocol)]
+        self.cur.close()
+        self.con.close()
+
+    def CheckCasterIsUsed(self):
+        self.cur.execute("select ?", (4,))
+        val = self.cur.fetchone()[0]
+        self.assertEqual(type(val), float)
+
+class AdapterCacheTests(unittest.TestCase):
+    class Point(object):
+        def __init__(self, x, y):
+            self.x, self.y = x, y
+
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+
+    def tearDown(self):
+        for key in [(self.Point, sqlite.PrepareProtocol), (int, sqlite.PrepareProtocol)]:
+            sqlite.adapters.pop(key, None)
+        self.con.close()
+
+    def select(self, value):
+        return self.con.execute("select ?", (value,)).fetchone()[0]
+
+    def CheckReplacedAdapter(self):
+        sqlite.register_adapter(self.Point, lambda p: "%d;%d" % (p.x, p.y))
+        self.assertEqual(self.select(self.Point(1, 2)), "1;2")
+        sqlite.register_adapter(self.Point, lambda p: "%d,%d" % (p.x, p.y))
+        self.assertEqual(self.select(self.Point(1, 2)), "1,2")
+
+    def CheckRemovedAdapter(self):
+        sqlite.register_adapter(self.Point, lambda p: "%d;%d" % (p.x, p.y))
+        self.assertEqual(self.select(self.Point(1, 2)), "1;2")
+        del sqlite.adapters[(self.Point, sqlite.PrepareProtocol)]
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+
+    def CheckAdapterAddedDirectly(self):
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+        sqlite.adapters[(self.Point, sqlite.PrepareProtocol)] = lambda p: "%d;%d" % (p.x, p.y)
+        self.assertEqual(self.select(self.Point(1, 2)), "1;2")
+
+    def CheckDictMethodsBypassRegistry(self):
+        # only the registry's own methods revalidate the cached lookups
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+        version = sqlite.adapters.version
+        dict.__setitem__(sqlite.adapters, (self.Point, sqlite.PrepareProtocol),
+                         lambda p: "%d;%d" % (p.x, p.y))
+        dict.update(sqlite.adapters, {})
+        self.assertEqual(sqlite.adapters.version, version)
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+        sqlite.adapters.update({})
+        self.assertNotEqual(sqlite.adapters.version, version)
+        self.assertEqual(self.select(self.Point(1, 2)), "1;2")
+
+    def CheckBaseTypeAdapter(self):
+        sqlite.register_adapter(int, float)
+        self.assertEqual(type(self.select(4)), float)
+        self.assertEqual(self.select("4"), "4")
+        del sqlite.adapters[(int, sqlite.PrepareProtocol)]
+        self.assertEqual(type(self.select(4)), int)
+
+    def CheckCachedTypeNotKeptAlive(self):
+        class Conforming(object):
+            def __conform__(self, protocol):
+                return "conformed"
+        self.assertEqual(self.select(Conforming()), "conformed")
+        ref = weakref.ref(Conforming)
+        del Conforming
+        gc.collect()
+        self.assertEqual(ref(), None)
+
+    def CheckConformAddedToType(self):
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+        self.Point.__conform__ = lambda p, protocol: "%d;%d" % (p.x, p.y)
+        try:
+            self.assertEqual(self.select(self.Point(1, 2)), "1;2")
+        finally:
+            del self.Point.__conform__
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+
+    def CheckConformInInstanceDict(self):
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+        p = self.Point(1, 2)
+        p.__conform__ = lambda protocol: "conformed"
+        self.assertEqual(self.select(p), "conformed")
+
+@unittest.skipUnless(zlib, "requires zlib")
+class BinaryConverterTests(unittest.TestCase):
+    def convert(s):
+        return zlib.decompress(s)
+    convert = staticmethod(convert)
+
+    def setUp(self):
+        self.con = sqlite.connect(":memory:", detect_types=sqlite.PARSE_COLNAMES)
+        sqlite.register_converter("bin", BinaryConverterTests.convert)
+
+    def tearDown(self):
+        self.con.close()
+
+    def CheckBinaryInputForConverter(self):
+        testdata = "abcdefg" * 10
+        result = self.con.execute('select ? as "x [bin]"', (buffer(zlib.compress(testdata)),)).fetchone()[0]
+        self.assertEqual(testdata, result)
+
+class DateTimeTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:", detect_types=sqlite.PARSE_DECLTYPES)
+        self.cur = self.con.cursor()
+        self.cur.execute("create table test(d date, ts timestamp)")
+
+    def tearDown(self):
+        self.cur.close()
+        self.con.close()
+
+    def CheckSqliteDate(self):
+        d = sqlite.Date(2004, 2, 14)
+        self.cur.execute("insert into test(d) values (?)", (d,))
+        self.cur.execute("select d from test")
+        d2 = self.cur.fetchone()[0]
+        self.assertEqual(d, d2)
+
+    def CheckSqliteTimestamp(self):
+        ts = sqlite.Timestamp(2004, 2, 14, 7, 15, 0)
+        self.cur.execute("insert into test(ts) values (?)", (ts,))
+        self.cur.execute("select ts from test")
+        ts2 = self.cur.fetchone()[0]
+        self.assertEqual(ts, ts2)
+
+    def CheckSqlTimestamp(self):
+        # SQLite's current_timestamp uses UTC time, while datetime.datetime.now() uses local time.
+        now = datetime.datetime.now()
+        self.cur.execute("insert into test(ts) values (current_timestamp)")
+        self.cur.execute("select ts from test")
+        ts = self.cur.fetchone()[0]
+        self.assertEqual(type(ts), datetime.datetime)
+        self.assertEqual(ts.year, now.year)
+
+    def CheckDateTimeMicroseconds(self):
+        ts = sqlite.Timestamp(2004, 2, 14, 7, 15, 0, 500000)
+        self.cur.execute("insert into test(ts) values (?)", (ts,))
+        self.cur.execute("select ts from test")
+        ts2 = self.cur.fetchone()[0]
+        self.assertEqual(ts, ts2)
+
+    def CheckDateTimeMicrosecondsFloatingPoint(self):
+        ts = sqlite.Timestamp(2004, 2, 14, 7, 15, 0, 510241)
+        self.cur.execute("insert into test(ts) values (?)", (ts,))
+        self.cur.execute("select ts from test")
+        ts2 = self.cur.fetchone()[0]
+        self.assertEqual(ts, ts2)
+
+    def CheckDateTimeMiliSeconds(self):
+        ts = sqlite.Timestamp(2004, 2, 14, 7, 15, 0, 500000)
+        self.cur.execute("insert into test(ts) values ('2004-02-14 07:15:00.500')")
+        self.cur.execute("select ts from test")
+        ts2 = self.cur.fetchone()[0]
+        self.assertEqual(ts, ts2)
+
+class NativeConverterTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:", detect_types=sqlite.PARSE_COLNAMES)
+        self.saved = sqlite.converters.copy()
+        for name in ("date", "timestamp", "boolean", "decimal", "json"):
+            sqlite.register_converter("native_" + name, name)
+
+    def tearDown(self):
+        sqlite.converters.clear()
+        sqlite.converters.update(self.saved)
+        self.con.close()
+
+    def select(self, typename, value):
+        return self.con.execute('select ? as "x [native_%s]"' % typename, (value,)).fetchone()[0]
+
+    def CheckUnknownName(self):
+        with self.assertRaises(ValueError):
+            sqlite.register_converter("bar", "no_such_converter")
+
+    def CheckCallable(self):
+        self.assertEqual(sqlite.converters["NATIVE_DATE"]("2004-02-14"), datetime.date(2004, 2, 14))
+
+    def CheckDate(self):
+        self.assertEqual(self.select("date", "2004-02-14"), datetime.date(2004, 2, 14))
+
+    def CheckTimestampFraction(self):
+        self.assertEqual(self.select("timestamp", "2004-02-14 07:15:00.5"),
+                         datetime.datetime(2004, 2, 14, 7, 15, 0, 500000))
+        self.assertEqual(self.select("timestamp", "2004-02-14 07:15:00.1234567"),
+                         datetime.datetime(2004, 2, 14, 7, 15, 0, 123456))
+
+    def CheckInvalidDate(self):
+        for value in ("2004-02-30", "2004-02", "2004-02-1x", "1900-02-29"):
+            with self.assertRaises(ValueError):
+                self.select("date", value)
+
+    def CheckInvalidTimestamp(self):
+        for value in ("2004-02-14", "2004-02-14 24:00:00", "2004-02-14 07:15:00.5x"):
+            with self.assertRaises(ValueError):
+                self.select("timestamp", value)
+
+    def CheckBoolean(self):
+        self.assertIs(self.select("boolean", 1), True)
+        self.assertIs(self.select("boolean", 0), False)
+
+    def CheckDecimal(self):
+        import decimal
+        value = self.select("decimal", "1.10")
+        self.assertEqual(type(value), str)
+        self.assertEqual(value, "1.10")
+        self.assertEqual(decimal.Decimal(value), decimal.Decimal("1.10"))
+        self.assertEqual(self.select("decimal", "-12345678901234567890.5e-3"), "-12345678901234567890.5e-3")
+
+    def CheckInvalidDecimal(self):
+        for value in ("1.2.3", "1e", "abc", ".", "1 "):
+            with self.assertRaises(ValueError):
+                self.select("decimal", value)
+
+    def CheckJson(self):
+        value = self.select("json", u'{"a": "\xe4"}')
+        self.assertEqual(value, u'{"a": "\xe4"}')
+        self.assertEqual(type(value), unicode)
+
+class NativeAdapterTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+
+    def tearDown(self):
+        sqlite.register_adapter(datetime.date, "date")
+        sqlite.register_adapter(datetime.datetime, "timestamp")
+        self.con.close()
+
+    def select(self, value):
+        return self.con.execute("select ?", (value,)).fetchone()[0]
+
+    def CheckUnknownName(self):
+        with self.assertRaises(ValueError):
+            sqlite.register_adapter(datetime.date, "no_such_adapter")
+
+    def CheckDate(self):
+        self.assertEqual(self.select(datetime.date(1, 2, 3)), "0001-02-03")
+
+    def CheckTimestamp(self):
+        self.assertEqual(self.select(datetime.datetime(2004, 2, 14, 7, 15)), "2004-02-14 07:15:00")
+        self.assertEqual(self.select(datetime.datetime(2004, 2, 14, 7, 15, 0, 5)), "2004-02-14 07:15:00.000005")
+
+    def CheckTimestampWithTimezone(self):
+        class TZ(datetime.tzinfo):
+            def utcoffset(self, dt):
+                return datetime.timedelta(hours=1)
+        ts = datetime.datetime(2004, 2, 14, 7, 15, tzinfo=TZ())
+        self.assertEqual(self.select(ts), "2004-02-14 07:15:00+01:00")
+
+    def CheckNamedParameters(self):
+        result = self.con.execute("select :d", {"d": datetime.date(2004, 2, 14)}).fetchone()[0]
+        self.assertEqual(result, "2004-02-14")
+
+    def CheckAdapterIsCallable(self):
+        adapter = sqlite.adapters[(datetime.date, sqlite.PrepareProtocol)]
+        self.assertEqual(adapter(datetime.date(2004, 2, 14)), "2004-02-14")
+        with self.assertRaises(TypeError):
+            adapter(42)
+
+    def CheckOverride(self):
+        sqlite.register_adapter(datetime.date, lambda d: d.strftime("%d.%m.%Y"))
+        self.assertEqual(self.select(datetime.date(2004, 2, 14)), "14.02.2004")
+        sqlite.register_adapter(datetime.date, "date")
+        self.assertEqual(self.select(datetime.date(2004, 2, 14)), "2004-02-14")
+
+    def CheckDecimal(self):
+        import decimal
+        class Money(decimal.Decimal):
+            pass
+        sqlite.register_adapter(Money, "decimal")
+        self.assertEqual(self.select(Money("1.10")), "1.10")
+
+    def CheckUuid(self):
+        import uuid
+        class Key(uuid.UUID):
+            pass
+        sqlite.register_adapter(Key, "uuid")
+        key = Key("12345678-9abc-def0-1234-56789abcdef0")
+        self.assertEqual(self.select(key), str(key))
+
+    def CheckAdapterError(self):
+        import uuid
+        class BadKey(uuid.UUID):
+            @property
+            def int(self):
+                raise ZeroDivisionError
+        sqlite.register_adapter(BadKey, "uuid")
+        key = BadKey("12345678-9abc-def0-1234-56789abcdef0")
+        self.con.execute("create table test(x)")
+        # every way of binding raises the error of the adapter
+        with self.assertRaises(ZeroDivisionError):
+            self.con.execute("insert into test(x) values (?)", (key,))
+        with self.assertRaises(ZeroDivisionError):
+            self.con.execute_dml("insert into test(x) values (?)", (key,))
+        with self.assertRaises(ZeroDivisionError):
+            self.con.cursor().executecolumns("insert into test(x) values (?)", [[key]])
+        self.assertEqual(self.con.execute("select count(*) from test").fetchone()[0], 0)
+
+def suite():
+    sqlite_type_suite = unittest.makeSuite(SqliteTypeTests, "Check")
+    decltypes_type_suite = unittest.makeSuite(DeclTypesTests, "Check")
+    colnames_type_suite = unittest.makeSuite(ColNamesTests, "Check")
+    adaptation_suite = unittest.makeSuite(ObjectAdaptationTests, "Check")
+    adapter_cache_suite = unittest.makeSuite(AdapterCacheTests, "Check")
+    bin_suite = unittest.makeSuite(BinaryConverterTests, "Check")
+    date_suite = unittest.makeSuite(DateTimeTests, "Check")
+    native_suite = unittest.makeSuite(NativeConverterTests, "Check")
+    native_adapter_suite = unittest.makeSuite(NativeAdapterTests, "Check")
+    return unittest.TestSuite((sqlite_type_suite, decltypes_type_suite, colnames_type_suite, adaptation_suite, adapter_cache_suite, bin_suite, date_suite, native_suite, native_adapter_suite))
+
+def test():
+    runner = unittest.TextTestRunner()
+    runner.run(suite())
+
+if __name__ == "__main__":
+    test()
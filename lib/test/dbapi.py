@@ -21,6 +21,7 @@
 #    misrepresented as being the original software.
 # 3. This notice may not be removed or altered from any source distribution.
 
+import struct
 import unittest
 try:
     import threading
@@ -145,6 +146,32 @@ class ConnectionTests(unittest.TestCase):
         # exception will be raised because of readonly database
         self.assertRaises(sqlite.OperationalError, con.execute, "create table test(foo)")
 
+    def CheckExecuteDml(self):
+        rowcount, lastrowid = self.cx.execute_dml("insert into test(name) values (?)", ("bar",))
+        self.assertEqual(rowcount, 1)
+        self.assertEqual(lastrowid, 2)
+        rowcount, lastrowid = self.cx.execute_dml("update test set name=:name", {"name": u"baz"})
+        self.assertEqual(rowcount, 2)
+        self.assertEqual(self.cx.execute("select count(*) from test where name='baz'").fetchone()[0], 2)
+
+    def CheckExecuteDmlImplicitTransaction(self):
+        self.cx.commit()
+        self.cx.execute_dml("insert into test(name) values (?)", ("bar",))
+        self.cx.rollback()
+        self.assertEqual(self.cx.execute("select count(*) from test").fetchone()[0], 1)
+
+    def CheckExecuteDmlRejectsQueries(self):
+        self.assertRaises(sqlite.ProgrammingError, self.cx.execute_dml, "select name from test")
+
+    def CheckExecuteDmlWrongNumberOfBindings(self):
+        self.assertRaises(sqlite.ProgrammingError, self.cx.execute_dml, "insert into test(name) values (?)")
+        self.assertRaises(sqlite.ProgrammingError, self.cx.execute_dml, "insert into test(name) values (?)", (1, 2))
+
+    def CheckExecuteDmlError(self):
+        self.assertRaises(sqlite.IntegrityError, self.cx.execute_dml, "insert into test(id, name) values (?, ?)", (1, "bar"))
+        # the cached statement can be used again after the error
+        self.cx.execute_dml("insert into test(id, name) values (?, ?)", (5, "bar"))
+
 class CursorTests(unittest.TestCase):
     def setUp(self):
         self.cx = sqlite.connect(":memory:")
@@ -355,6 +382,20 @@ class CursorTests(unittest.TestCase):
 
         self.cu.executemany("insert into test(income) values (?)", mygen())
 
+    def CheckExecuteManyRepeatedString(self):
+        name = u"H\xfcgo" * 100
+        rows = [(name,), (name,), (u"Egon",), (name,)]
+        self.cu.execute("delete from test")
+        self.cu.executemany("insert into test(name) values (?)", rows)
+        self.cu.execute("select name from test order by id")
+        self.assertEqual(self.cu.fetchall(), rows)
+
+    def CheckBoundStringOutlivesParameters(self):
+        self.cu.execute("delete from test")
+        self.cu.executemany("insert into test(name) values (?)", [(u"x%d" % i,) for i in range(10)])
+        self.cu.execute("select name from test where name >= ? order by name", (u"x" + u"5",))
+        self.assertEqual([row[0] for row in self.cu], [u"x5", u"x6", u"x7", u"x8", u"x9"])
+
     def CheckExecuteManyWrongSqlArg(self):
         try:
             self.cu.executemany(42, [(3,)])
@@ -444,6 +485,203 @@ class CursorTests(unittest.TestCase):
         res = self.cu.fetchall()
         self.assertEqual(res, [])
 
+    def CheckExecutecolumns(self):
+        self.cu.execute("delete from test")
+        names = [u"n\xe4%d" % i for i in range(3000)]
+        incomes = [None, 1, 2.5] * 1000
+        self.cu.executecolumns("insert into test(name, income) values (?, ?)", [names, incomes])
+        self.assertEqual(self.cu.rowcount, 3000)
+        self.cu.execute("select name, income from test order by id")
+        self.assertEqual(self.cu.fetchall(), zip(names, incomes))
+
+    def CheckExecutecolumnsBuffers(self):
+        self.cu.execute("delete from test")
+        self.cu.executecolumns("insert into test(id, income) values (?, ?)",
+                               [memoryview(bytearray("\x01\x02\xff")), [1, 2, 3]])
+        self.cu.execute("select id from test order by id")
+        ids, = self.cu.fetchcolumns()
+        self.cu.executecolumns("update test set income = ? where id = ?", [ids, ids])
+        self.assertEqual(self.cu.rowcount, 3)
+        self.cu.execute("select id, income from test order by id")
+        self.assertEqual(self.cu.fetchall(), [(1, 1), (2, 2), (255, 255)])
+
+    def CheckExecutecolumnsWrongLength(self):
+        try:
+            self.cu.executecolumns("insert into test(id, name) values (?, ?)", [[1, 2], ["a"]])
+            self.fail("should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+
+    def CheckExecutecolumnsNotDML(self):
+        try:
+            self.cu.executecolumns("select ?", [[1, 2]])
+            self.fail("should have raised a ProgrammingError")
+        except sqlite.ProgrammingError:
+            pass
+
+    def CheckDescriptionShared(self):
+        self.cu.execute("select id, name from test").fetchall()
+        description = self.cu.description
+        cu = self.cx.cursor()
+        cu.execute("select id, name from test")
+        self.assertTrue(cu.description is description)
+        self.assertEqual([d[0] for d in description], ["id", "name"])
+
+    def CheckDescriptionAfterSchemaChange(self):
+        self.cu.execute("create table schema_change(a)")
+        self.cu.execute("select * from schema_change")
+        self.assertEqual([d[0] for d in self.cu.description], ["a"])
+        self.cu.execute("alter table schema_change add column b")
+        self.cu.execute("select * from schema_change")
+        self.assertEqual([d[0] for d in self.cu.description], ["a", "b"])
+
+    def CheckFetchmanyBatches(self):
+        """Checks fetchmany across the boundaries of the internal fetch batches"""
+        self.cu.executemany("insert into test(name) values (?)", [("n%d" % i,) for i in range(1000)])
+        self.cu.execute("select id from test order by id")
+        res = self.cu.fetchmany(300)
+        self.assertEqual([r[0] for r in res], range(1, 301))
+        self.assertEqual(self.cu.fetchone(), (301,))
+        res = self.cu.fetchmany(700)
+        self.assertEqual([r[0] for r in res], range(302, 1002))
+        self.assertEqual(self.cu.fetchmany(10), [])
+
+    def CheckFetchallBatches(self):
+        """Checks fetchall across the boundaries of the internal fetch batches"""
+        self.cu.executemany("insert into test(name, income) values (?, ?)",
+                            [(u"n\xe4%d" % i, i / 2.0) for i in range(1000)])
+        self.cu.execute("select id, name, income from test order by id")
+        self.cu.fetchone()
+        res = self.cu.fetchall()
+        self.assertEqual(len(res), 1000)
+        self.assertEqual(res[0], (2, u"n\xe40", 0.0))
+        self.assertEqual(res[-1], (1001, u"n\xe4999", 499.5))
+        self.assertEqual(self.cu.fetchall(), [])
+
+    def CheckFetchLargeValues(self):
+        """Checks rows with values too large for the fetch batches between others"""
+        def value(i):
+            return "v%d" % i * (3000 if i % 3 == 0 else 1)
+        rows = [(unicode(value(i)), buffer(value(i))) for i in range(20)]
+        self.cu.execute("delete from test")
+        self.cu.executemany("insert into test(name, income) values (?, ?)", rows)
+        self.cu.execute("select name, income from test order by id")
+        res = self.cu.fetchmany(3) + self.cu.fetchmany(1) + [self.cu.fetchone()]
+        res += self.cu.fetchmany(4) + self.cu.fetchall()
+        self.assertEqual([(name, str(blob)) for name, blob in res],
+                         [(name, str(blob)) for name, blob in rows])
+        self.assertEqual(self.cu.fetchall(), [])
+
+    def CheckBlobViews(self):
+        self.assertEqual(self.cu.blob_views, 0)
+        self.cu.execute("delete from test")
+        self.cu.executemany("insert into test(name, income) values (?, ?)",
+                            [(u"n\xe4%d" % i, buffer("blob%d" % i)) for i in range(300)])
+        self.cu.blob_views = 1
+        self.cu.execute("select name, income from test order by id")
+        first = self.cu.fetchone()
+        self.assertEqual(str(first[1]), "blob0")
+        res = self.cu.fetchall()
+        self.assertEqual([(name, str(blob)) for name, blob in res],
+                         [(u"n\xe4%d" % i, "blob%d" % i) for i in range(1, 300)])
+        self.assertEqual(type(res[0][1]), buffer)
+        del res[:-1]
+        self.assertEqual(str(res[0][1]), "blob299")
+        with self.assertRaises(TypeError):
+            res[0][1][0] = "x"
+
+    def CheckBlobViewsSingleRows(self):
+        self.cu.execute("delete from test")
+        self.cu.executemany("insert into test(income) values (?)",
+                            [(buffer("blob%d" % i),) for i in range(4)])
+        self.cx.commit()
+        self.cu.blob_views = 1
+        self.cu.execute("select income from test order by id")
+        first = self.cu.fetchone()
+        self.assertEqual(str(first[0]), "blob0")
+        with self.assertRaises(TypeError):
+            first[0][0] = "x"
+        # fetchmany() copies the rows it returns and moves the cursor on
+        second = self.cu.fetchmany(1)[0]
+        with self.assertRaises(sqlite.ProgrammingError):
+            str(first[0])
+        self.assertEqual(str(self.cu.fetchone()[0]), "blob2")
+        fourth = next(self.cu)
+        self.assertEqual(str(fourth[0]), "blob3")
+        self.assertEqual(str(second[0]), "blob1")
+        self.assertEqual(self.cu.fetchone(), None)
+        with self.assertRaises(sqlite.ProgrammingError):
+            str(fourth[0])
+
+        self.cu.execute("select income from test order by id")
+        self.assertEqual([str(row[0]) for row in self.cu], ["blob%d" % i for i in range(4)])
+
+        self.cu.execute("select income from test order by id")
+        row = self.cu.fetchone()
+        self.cx.execute("insert into test(name) values ('foo')")
+        self.cx.rollback()
+        with self.assertRaises(sqlite.ProgrammingError):
+            str(row[0])
+
+        self.cu.execute("select income from test order by id")
+        row = self.cu.fetchone()
+        self.cu.close()
+        with self.assertRaises(sqlite.ProgrammingError):
+            str(row[0])
+
+    def CheckBlobViewsLargeValues(self):
+        self.cu.execute("delete from test")
+        data = ["%d" % i * 40000 for i in range(5)]
+        self.cu.executemany("insert into test(income) values (?)",
+                            [(buffer(d),) for d in data])
+        self.cu.blob_views = 1
+        self.cu.execute("select income from test order by id")
+        self.assertEqual([str(row[0]) for row in self.cu.fetchall()], data)
+
+    def CheckFetchcolumns(self):
+        self.cu.execute("insert into test(name, income) values (?, ?)", (None, 2.5))
+        self.cu.execute("insert into test(name, income) values (?, ?)", (u"b\xe4r", 3))
+        self.cu.execute("select id, name, income from test order by id")
+        ids, names, incomes = self.cu.fetchcolumns()
+        self.assertEqual(ids.name, "id")
+        self.assertEqual(ids.type, sqlite.SQLITE_INTEGER)
+        self.assertEqual(len(ids), 3)
+        self.assertEqual(ids.tolist(), [1, 2, 3])
+        self.assertEqual(str(buffer(ids)), struct.pack("=3q", 1, 2, 3))
+        self.assertEqual(names.type, sqlite.SQLITE_TEXT)
+        self.assertEqual(names.tolist(), [u"foo", None, u"b\xe4r"])
+        self.assertEqual(names.offsets.tolist(), [0, 3, 3, 7])
+        self.assertEqual(names.nulls.tolist(), [0, 1, 0])
+        self.assertEqual(incomes.type, sqlite.SQLITE_FLOAT)
+        self.assertEqual(incomes.tolist(), [None, 2.5, 3.0])
+        self.assertEqual(self.cu.fetchcolumns(), [])
+
+    def CheckFetchcolumnsSize(self):
+        self.cu.executemany("insert into test(name) values (?)", [("a",), ("b",)])
+        self.cu.execute("select name from test order by id")
+        col, = self.cu.fetchcolumns(2)
+        self.assertEqual(col.tolist(), [u"foo", u"a"])
+        self.assertEqual(self.cu.fetchone(), (u"b",))
+        self.assertEqual(self.cu.fetchcolumns(), [])
+
+    def CheckFetchcolumnsMemoryview(self):
+        self.cu.execute("select 1.5 union all select 2.5")
+        col, = self.cu.fetchcolumns()
+        view = memoryview(col)
+        self.assertEqual(view.format, "d")
+        self.assertEqual(view.shape, (2,))
+        self.assertEqual(view.tobytes(), struct.pack("=2d", 1.5, 2.5))
+
+    def CheckFetchcolumnsMixedTypes(self):
+        self.cu.execute("select 1 union all select 'abc'")
+        self.assertRaises(sqlite.DataError, self.cu.fetchcolumns)
+        self.cu.execute("select 1.5 union all select x'00'")
+        self.assertRaises(sqlite.DataError, self.cu.fetchcolumns)
+        # numbers in a TEXT column are converted to text
+        self.cu.execute("select 'abc' union all select 1")
+        col, = self.cu.fetchcolumns()
+        self.assertEqual(col.tolist(), [u"abc", u"1"])
+
     def CheckSetinputsizes(self):
         self.cu.setinputsizes([3, 4, 5])
 
@@ -913,6 +1151,250 @@ class ContextTests(unittest.TestCase):
             pass
         self.assertEqual(did_rollback, True)
 
+class BlobTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+        self.con.execute("create table test(id integer primary key, data blob)")
+        self.data = "".join(chr(i % 256) for i in range(1000))
+        self.con.execute("insert into test(id, data) values (1, ?)", (buffer(self.data),))
+        self.blob = self.con.blobopen("test", "data", 1)
+
+    def tearDown(self):
+        self.blob.close()
+        self.con.close()
+
+    def CheckLength(self):
+        self.assertEqual(len(self.blob), 1000)
+
+    def CheckRead(self):
+        self.assertEqual(self.blob.read(10), self.data[:10])
+        self.assertEqual(self.blob.tell(), 10)
+        self.assertEqual(self.blob.read(), self.data[10:])
+        self.assertEqual(self.blob.read(), "")
+
+    def CheckReadinto(self):
+        buf = bytearray(600)
+        self.assertEqual(self.blob.readinto(buf), 600)
+        self.assertEqual(str(buf), self.data[:600])
+        self.assertEqual(self.blob.readinto(buf), 400)
+        self.assertEqual(str(buf[:400]), self.data[600:])
+
+    def CheckSeek(self):
+        self.blob.seek(-10, 2)
+        self.assertEqual(self.blob.read(), self.data[-10:])
+        self.blob.seek(5)
+        self.blob.seek(5, 1)
+        self.assertEqual(self.blob.tell(), 10)
+        self.assertRaises(ValueError, self.blob.seek, 1001)
+        self.assertRaises(ValueError, self.blob.seek, -1)
+        self.assertRaises(ValueError, self.blob.seek, 0, 3)
+
+    def CheckWriteReadOnly(self):
+        self.assertRaises(sqlite.OperationalError, self.blob.write, "x")
+
+    def CheckWrite(self):
+        with self.con.blobopen("test", "data", 1, readonly=False) as blob:
+            blob.seek(10)
+            blob.write("abc")
+            self.assertEqual(blob.tell(), 13)
+            self.assertRaises(ValueError, blob.write, "x" * 988)
+        data = str(self.con.execute("select data from test").fetchone()[0])
+        self.assertEqual(data, self.data[:10] + "abc" + self.data[13:])
+
+    def CheckNoSuchRow(self):
+        self.assertRaises(sqlite.OperationalError, self.con.blobopen, "test", "data", 2)
+
+    def CheckClosed(self):
+        self.blob.close()
+        self.assertRaises(sqlite.ProgrammingError, self.blob.read)
+        self.assertRaises(sqlite.ProgrammingError, len, self.blob)
+
+    def CheckConnectionClosed(self):
+        self.con.close()
+        self.assertRaises(sqlite.ProgrammingError, self.blob.read)
+
+    def CheckReopen(self):
+        self.con.execute("insert into test(id, data) values (2, ?)", (buffer("second"),))
+        self.blob.read(10)
+        self.blob.reopen(2)
+        self.assertEqual(self.blob.tell(), 0)
+        self.assertEqual(len(self.blob), 6)
+        self.assertEqual(self.blob.read(), "second")
+        self.assertRaises(sqlite.OperationalError, self.blob.reopen, 3)
+
+    def CheckReadmany(self):
+        self.con.executemany("insert into test(id, data) values (?, ?)",
+                             [(i, buffer("row%d" % i)) for i in range(2, 12)])
+        buf = bytearray(42)
+        self.assertEqual(self.blob.readmany(range(2, 12), buf[:40]), [4] * 8 + [5])
+        sizes = self.blob.readmany(range(2, 12), buf)
+        self.assertEqual(sizes, [4] * 8 + [5, 5])
+        self.assertEqual(str(buf), "".join("row%d" % i for i in range(2, 12)))
+        sizes = self.blob.readmany([1, 2], buf)
+        self.assertEqual(sizes, [])
+        self.assertRaises(sqlite.OperationalError, self.blob.readmany, [2, 99], buf)
+
+    def CheckRowChanged(self):
+        self.con.execute("update test set data = ? where id = 1", (buffer("x"),))
+        self.assertRaises(sqlite.OperationalError, self.blob.read)
+
+class ConnectionPoolTests(unittest.TestCase):
+    def setUp(self):
+        self.pool = sqlite.ConnectionPool(":memory:", maxsize=2)
+
+    def tearDown(self):
+        self.pool.close()
+
+    def CheckReuse(self):
+        con = self.pool.acquire()
+        self.assertTrue(isinstance(con, sqlite.Connection))
+        con.execute("create table test(x)")
+        self.pool.release(con)
+        self.assertEqual(self.pool.idle, 1)
+        self.assertTrue(self.pool.acquire() is con)
+        self.assertEqual(self.pool.size, 1)
+
+    def CheckMaxSize(self):
+        self.assertEqual(self.pool.maxsize, 2)
+        con1 = self.pool.acquire()
+        con2 = self.pool.acquire()
+        self.assertTrue(con1 is not con2)
+        self.assertRaises(sqlite.OperationalError, self.pool.acquire)
+        self.pool.release(con2)
+        self.assertTrue(self.pool.acquire() is con2)
+
+    def CheckConnectArguments(self):
+        pool = sqlite.ConnectionPool(database=":memory:", factory=MyConnection, isolation_level=None)
+        con = pool.acquire()
+        self.assertTrue(isinstance(con, MyConnection))
+        self.assertEqual(con.isolation_level, None)
+        self.assertEqual(pool.idle_timeout, None)
+        pool.close()
+
+    def CheckPositionalFactory(self):
+        pool = sqlite.ConnectionPool(":memory:", 5.0, 0, None, True, MyConnection)
+        con = pool.acquire()
+        self.assertTrue(isinstance(con, MyConnection))
+        self.assertEqual(con.isolation_level, None)
+        pool.close()
+
+    def CheckBadConnectArguments(self):
+        self.assertRaises(TypeError, sqlite.ConnectionPool)
+        self.assertRaises(TypeError, sqlite.ConnectionPool, ":memory:", timeout="x")
+        self.assertRaises(TypeError, sqlite.ConnectionPool, ":memory:", other=1)
+
+    def CheckUsedAfterReleaseIsDropped(self):
+        con = self.pool.acquire()
+        con.execute("create table test(x)")
+        con.commit()
+        self.pool.release(con)
+        con.execute("insert into test(x) values (1)")
+        self.assertTrue(self.pool.acquire() is not con)
+        self.assertEqual(self.pool.size, 1)
+        self.assertRaises(sqlite.ProgrammingError, con.cursor)
+
+        con = self.pool.acquire()
+        self.pool.release(con)
+        cur = con.execute("select 1 union all select 2")
+        cur.fetchone()
+        self.assertTrue(self.pool.acquire() is not con)
+        self.assertEqual(self.pool.size, 2)
+
+    def CheckReleaseRollsBack(self):
+        con = self.pool.acquire()
+        con.execute("create table test(x)")
+        con.execute("insert into test(x) values (1)")
+        self.pool.release(con)
+        con = self.pool.acquire()
+        self.assertEqual(con.execute("select count(*) from test").fetchone()[0], 0)
+
+    def CheckReleaseForeignConnection(self):
+        con = sqlite.connect(":memory:")
+        self.assertRaises(sqlite.ProgrammingError, self.pool.release, con)
+        con = self.pool.acquire()
+        self.pool.release(con)
+        self.assertRaises(sqlite.ProgrammingError, self.pool.release, con)
+
+    def CheckClosedConnectionIsDropped(self):
+        con = self.pool.acquire()
+        con.close()
+        self.pool.release(con)
+        self.assertTrue(self.pool.acquire() is not con)
+        self.assertEqual(self.pool.size, 1)
+
+    def CheckIdleTimeout(self):
+        pool = sqlite.ConnectionPool(":memory:", idle_timeout=0)
+        con = pool.acquire()
+        pool.release(con)
+        self.assertTrue(pool.acquire() is not con)
+        self.assertEqual(pool.size, 1)
+        self.assertRaises(sqlite.ProgrammingError, con.cursor)
+        pool.close()
+
+    def CheckEvict(self):
+        pool = sqlite.ConnectionPool(":memory:", idle_timeout=0)
+        con1 = pool.acquire()
+        con2 = pool.acquire()
+        pool.release(con1)
+        self.assertEqual(pool.idle, 1)
+        # releasing a connection closes the expired ones
+        pool.release(con2)
+        self.assertEqual(pool.idle, 1)
+        self.assertEqual(pool.size, 1)
+        self.assertRaises(sqlite.ProgrammingError, con1.cursor)
+        pool.evict()
+        self.assertEqual(pool.idle, 0)
+        self.assertEqual(pool.size, 0)
+        self.assertRaises(sqlite.ProgrammingError, con2.cursor)
+        pool.close()
+        self.assertRaises(sqlite.ProgrammingError, pool.evict)
+
+        # without an idle timeout, connections stay open
+        con = self.pool.acquire()
+        self.pool.release(con)
+        self.pool.evict()
+        self.assertEqual(self.pool.idle, 1)
+
+    def CheckClose(self):
+        con1 = self.pool.acquire()
+        con2 = self.pool.acquire()
+        self.pool.release(con1)
+        self.pool.close()
+        self.assertRaises(sqlite.ProgrammingError, con1.cursor)
+        self.assertRaises(sqlite.ProgrammingError, self.pool.acquire)
+        self.pool.release(con2)
+        self.assertRaises(sqlite.ProgrammingError, con2.cursor)
+        self.assertEqual(self.pool.size, 0)
+
+    def CheckThreadAffinity(self):
+        if not threading:
+            return
+        con1 = self.pool.acquire()
+        acquired = threading.Event()
+        released = threading.Event()
+        result = []
+        def run():
+            con = self.pool.acquire()
+            result.append(con)
+            acquired.set()
+            released.wait()
+            con.execute("select 1")
+            self.pool.release(con)
+        t = threading.Thread(target=run)
+        t.start()
+        acquired.wait()
+        self.pool.release(con1)
+        released.set()
+        t.join()
+        con2 = result[0]
+        self.assertTrue(con2 is not con1)
+        # the connection released by this thread is preferred, even though
+        # the other one was released later
+        self.assertTrue(self.pool.acquire() is con1)
+        # the other thread's connection now belongs to this thread
+        self.assertTrue(self.pool.acquire() is con2)
+        con2.execute("select 1")
+
 def suite():
     module_suite = unittest.makeSuite(ModuleTests, "Check")
     connection_suite = unittest.makeSuite(ConnectionTests, "Check")
@@ -923,7 +1405,9 @@ def suite():
     closed_con_suite = unittest.makeSuite(ClosedConTests, "Check")
     closed_cur_suite = unittest.makeSuite(ClosedCurTests, "Check")
     context_suite = unittest.makeSuite(ContextTests, "Check")
-    return unittest.TestSuite((module_suite, connection_suite, cursor_suite, thread_suite, constructor_suite, ext_suite, closed_con_suite, closed_cur_suite, context_suite))
+    blob_suite = unittest.makeSuite(BlobTests, "Check")
+    pool_suite = unittest.makeSuite(ConnectionPoolTests, "Check")
+    return unittest.TestSuite((module_suite, connection_suite, cursor_suite, thread_suite, constructor_suite, ext_suite, closed_con_suite, closed_cur_suite, context_suite, blob_suite, pool_suite))
 
 def test():
     runner = unittest.TextTestRunner()
@@ -21,6 +21,8 @@
 #    misrepresented as being the original software.
 # 3. This notice may not be removed or altered from any source distribution.
 
+import gc
+import sys
 import unittest
 import pysqlite2.dbapi2 as sqlite
 from collections import Sequence
@@ -162,6 +164,150 @@ class RowFactoryTests(unittest.TestCase):
         row = self.con.execute("select 5 as a").fetchone()
         row[u"a"]
 
+    def CheckSqliteRowSlice(self):
+        self.con.row_factory = sqlite.Row
+        row = self.con.execute("select 1, 2, 3, 4, 5").fetchone()
+        self.assertEqual(row[1:3], (2, 3))
+        self.assertEqual(row[::2], (1, 3, 5))
+        self.assertEqual(row[::-1], (5, 4, 3, 2, 1))
+        self.assertEqual(row[-2:], (4, 5))
+        self.assertEqual(row[10:], ())
+        self.assertEqual(row[:], tuple(row))
+
+    def CheckSqliteRowAsdict(self):
+        self.con.row_factory = sqlite.Row
+        row = self.con.execute("select 1 as a, 'x' as b, 3 as a").fetchone()
+        self.assertEqual(row.asdict(), {"a": 1, "b": "x"})
+
+    def CheckSqliteRowHashValue(self):
+        self.con.row_factory = sqlite.Row
+        cur = self.con.execute("select 1 as a, 'x' as b, 2.5 as c, null as d")
+        row = cur.fetchone()
+        # the hash is the same as with the values kept in a tuple
+        self.assertEqual(hash(row), hash(cur.description) ^ hash(tuple(row)))
+        self.assertEqual(hash(row), hash(sqlite.Row(cur, tuple(row))))
+        self.assertRaises(TypeError, hash, sqlite.Row(cur, ([],)))
+
+    def CheckSqliteRowFetchMethods(self):
+        self.con.row_factory = sqlite.Row
+        sql = "select 1 as a union all select 2 union all select 3 union all select 4"
+        cur = self.con.execute(sql)
+        rows = [cur.fetchone()] + cur.fetchmany(2) + cur.fetchall()
+        rows += list(self.con.execute(sql))
+        self.assertEqual([row["a"] for row in rows], [1, 2, 3, 4] * 2)
+        for row in rows:
+            self.assertEqual(type(row), sqlite.Row)
+            self.assertEqual(row.keys(), ["a"])
+        self.assertEqual(rows[0], sqlite.Row(cur, (1,)))
+
+    def CheckSqliteRowSubclass(self):
+        created = []
+        class MyRow(sqlite.Row):
+            def __new__(cls, cursor, data):
+                created.append(data)
+                return sqlite.Row.__new__(cls, cursor, data)
+        self.con.row_factory = MyRow
+        rows = self.con.execute("select 1 as a union all select 2").fetchall()
+        self.assertEqual([type(row) for row in rows], [MyRow, MyRow])
+        self.assertEqual(created, [(1,), (2,)])
+
+    def CheckSqliteRowWideByName(self):
+        self.con.row_factory = sqlite.Row
+        columns = ["col%d" % i for i in range(100)]
+        sql = "select " + ", ".join("%d as %s" % (i, name) for i, name in enumerate(columns))
+        for _ in range(2):
+            rows = self.con.execute(sql + " union all " + sql).fetchall()
+            for row in rows:
+                for i, name in enumerate(columns):
+                    self.assertEqual(row[name], i)
+                    self.assertEqual(row[name.upper()], i)
+                    self.assertEqual(row[unicode(name)], i)
+        self.assertRaises(IndexError, lambda: rows[0]["col100"])
+        self.assertRaises(IndexError, lambda: rows[0][u"\xe4"])
+
+    def CheckSqliteRowDuplicateNames(self):
+        self.con.row_factory = sqlite.Row
+        row = self.con.execute("select 1 as a, 2 as A, 3 as b").fetchone()
+        self.assertEqual(row["A"], 1)
+        self.assertEqual(row["a"], 1)
+        self.assertEqual(row["B"], 3)
+
+    def CheckSqliteRowSchemaChange(self):
+        self.con.row_factory = sqlite.Row
+        self.con.execute("create table test(a)")
+        self.con.execute("insert into test(a) values (1)")
+        self.assertEqual(self.con.execute("select * from test").fetchone()["a"], 1)
+        self.con.execute("alter table test add column b default 2")
+        row = self.con.execute("select * from test").fetchone()
+        self.assertEqual((row["a"], row["B"]), (1, 2))
+
+    def CheckNamedRowAttributes(self):
+        self.con.row_factory = sqlite.NamedRow
+        row = self.con.execute("select 1 as id, 2.5 as Price, 'x' as keys").fetchone()
+        self.assertTrue(isinstance(row, sqlite.Row))
+        self.assertEqual((row.id, row.Price), (1, 2.5))
+        self.assertEqual((row[1], row["price"]), (2.5, 2.5))
+        self.assertEqual(row._fields, ("id", "Price", "keys"))
+        self.assertEqual(row.keys(), ["id", "Price", "keys"])
+        self.assertEqual(row.asdict()["keys"], "x")
+        self.assertRaises(AttributeError, lambda: row.price)
+        self.assertRaises(TypeError, setattr, row, "id", 2)
+        self.assertRaises(AttributeError, setattr, row, "other", 2)
+
+    def CheckNamedRowTypePerStatement(self):
+        self.con.row_factory = sqlite.NamedRow
+        rows = self.con.execute("select 1 as a union all select 2").fetchall()
+        rows.append(self.con.execute("select 3 as a").fetchone())
+        rows.append(self.con.execute("select 1 as a union all select 2").fetchone())
+        self.assertEqual([row.a for row in rows], [1, 2, 3, 1])
+        self.assertTrue(type(rows[0]) is type(rows[1]))
+        self.assertTrue(type(rows[0]) is type(rows[3]))
+        self.assertFalse(type(rows[0]) is type(rows[2]))
+        self.assertEqual(rows[0], rows[3])
+        self.assertEqual(hash(rows[0]), hash(rows[3]))
+
+    def CheckNamedRowDuplicateNames(self):
+        self.con.row_factory = sqlite.NamedRow
+        row = self.con.execute("select 1 as a, 2 as a, 3 as __b").fetchone()
+        self.assertEqual(row.a, 1)
+        self.assertEqual(row["__b"], 3)
+        self.assertFalse(hasattr(row, "__b"))
+
+    def CheckNamedRowCall(self):
+        cur = self.con.execute("select 1 as a, 2 as b")
+        row = sqlite.NamedRow(cur, (3, 4))
+        self.assertEqual((row.a, row.b), (3, 4))
+        self.assertEqual(type(row)(cur, (5, 6)).b, 6)
+        self.assertRaises(ValueError, type(row), cur, (5,))
+
+    def CheckNamedRowMemberOfOtherType(self):
+        self.con.row_factory = sqlite.NamedRow
+        wide = self.con.execute("select 1 as a, 2 as b, 3 as c").fetchone()
+        narrow = self.con.execute("select 1 as a").fetchone()
+        member = type(wide).__dict__["c"]
+        self.assertEqual(member.__get__(wide), 3)
+        self.assertRaises(TypeError, member.__get__, narrow)
+        self.assertRaises(TypeError, member.__get__, sqlite.Row(self.con.cursor(), ()))
+
+    def CheckNamedRowClassAttributesRebound(self):
+        self.con.row_factory = sqlite.NamedRow
+        cur = self.con.execute("select 1 as a, 2 as price")
+        row = cur.fetchone()
+        cls = type(row)
+        cls._fields = None
+        gc.collect()
+        self.assertEqual((row.a, row.price), (1, 2))
+        self.assertRaises(ValueError, cls, cur, (5,))
+        with self.assertRaises(TypeError):
+            class Sub(cls):
+                pass
+
+    def CheckNamedRowNotTracked(self):
+        self.con.row_factory = sqlite.NamedRow
+        row = self.con.execute("select 1 as a, 2 as b").fetchone()
+        self.assertFalse(gc.is_tracked(row))
+        self.assertEqual(sys.getsizeof(row), sys.getsizeof(sqlite.Row(self.con.cursor(), (1, 2))))
+
     def tearDown(self):
         self.con.close()
 
@@ -25,6 +25,16 @@ import datetime
 import unittest
 import pysqlite2.dbapi2 as sqlite
 
+class CountingConnection(sqlite.Connection):
+    """Records the SQL of the statements it prepares."""
+    def __init__(self, *args, **kwargs):
+        self.prepared = []
+        sqlite.Connection.__init__(self, *args, **kwargs)
+
+    def __call__(self, sql):
+        self.prepared.append(sql)
+        return sqlite.Connection.__call__(self, sql)
+
 class RegressionTests(unittest.TestCase):
     def setUp(self):
         self.con = sqlite.connect(":memory:")
@@ -62,6 +72,146 @@ class RegressionTests(unittest.TestCase):
 
         con.rollback()
 
+    def _make_cache(self, size, policy="lfu"):
+        """Returns a Cache whose factory returns the key, and the list of keys
+        the factory was called with."""
+        created = []
+        def factory(key):
+            created.append(key)
+            return key
+        return sqlite.Cache(factory, size, policy), created
+
+    def CheckCachePolicyLRU(self):
+        cache, created = self._make_cache(5, "lru")
+        for key in range(5) + [0, 5, 0, 1]:
+            self.assertEqual(cache.get(key), key)
+        # 1 was the least recently used entry when 5 was added
+        self.assertEqual(created, [0, 1, 2, 3, 4, 5, 1])
+
+    def CheckCachePolicyLFU(self):
+        cache, created = self._make_cache(5, "lfu")
+        for key in range(5) + [0, 0, 1, 5, 4, 0, 1]:
+            self.assertEqual(cache.get(key), key)
+        # 4 was evicted for 5, being the least frequently used entry added last
+        self.assertEqual(created, [0, 1, 2, 3, 4, 5, 4])
+
+    def CheckCacheEqualKeys(self):
+        cache, created = self._make_cache(5)
+        cache.get("select 1")
+        cache.get("".join(["select", " ", "1"]))
+        cache.get(u"select 1")
+        self.assertEqual(created, ["select 1"])
+
+    def CheckCachePin(self):
+        for policy in ("lfu", "lru"):
+            cache, created = self._make_cache(5, policy)
+            cache.pin("hot")
+            # pinned entries don't take space from the others
+            for key in range(5) + range(5) + ["hot"]:
+                cache.get(key)
+            self.assertEqual(created, ["hot", 0, 1, 2, 3, 4])
+            for key in range(20):
+                cache.get(key)
+            self.assertEqual(cache.get("hot"), "hot")
+            self.assertEqual(created.count("hot"), 1)
+            cache.unpin("hot")
+            cache.unpin("missing")
+            for key in range(20, 25):
+                cache.get(key)
+            if policy == "lru":
+                cache.get("hot")
+                self.assertEqual(created.count("hot"), 2)
+
+    def CheckCacheUnpinOrder(self):
+        cache, created = self._make_cache(5, "lfu")
+        cache.pin("hot")
+        for key in range(4) + [0, 0, 1]:
+            cache.get(key)
+        cache.get("hot")
+        cache.unpin("hot")
+        # "hot" has been used once while pinned, more often than 2 and 3
+        cache.get(4)
+        del created[:]
+        cache.get("hot")
+        cache.get(3)
+        self.assertEqual(created, [3])
+
+    def CheckPinStatement(self):
+        con = sqlite.connect(":memory:", cached_statements=5)
+        con.pin_statement("select 1")
+        cur = con.execute("select 1")
+        # the pinned statement is in use, so a second cursor gets its own
+        self.assertEqual(con.execute("select 1").fetchone(), (1,))
+        self.assertEqual(cur.fetchone(), (1,))
+        con.unpin_statement("select 1")
+        self.assertRaises(sqlite.OperationalError, con.pin_statement, "select * from missing")
+        con.close()
+        self.assertRaises(sqlite.ProgrammingError, con.pin_statement, "select 1")
+
+    def CheckCachePolicyConnect(self):
+        con = sqlite.connect(":memory:", cached_statements=5, cache_policy="lru")
+        for i in range(20):
+            self.assertEqual(con.execute("select %d" % (i % 7)).fetchone(), (i % 7,))
+        con.close()
+        self.assertRaises(ValueError, sqlite.connect, ":memory:", cache_policy="fifo")
+
+    def CheckPrepareOnConnect(self):
+        hot = ["select 1", "select 2"]
+        con = sqlite.connect(":memory:", factory=CountingConnection, cached_statements=5, prepare=hot)
+        self.assertEqual(con.prepared, hot)
+        for i in range(20):
+            con.execute("select %d" % (i + 10))
+        del con.prepared[:]
+        self.assertEqual(con.execute("select 1").fetchone(), (1,))
+        self.assertEqual(con.execute("select 2").fetchone(), (2,))
+        self.assertEqual(con.prepared, [])
+        con.close()
+        self.assertRaises(sqlite.OperationalError, sqlite.connect, ":memory:", prepare=["select * from missing"])
+
+    def CheckNestedCursorsSameStatement(self):
+        con = sqlite.connect(":memory:", factory=CountingConnection)
+        con.execute("create table test(x)")
+        con.executemany("insert into test(x) values (?)", [(i,) for i in range(10)])
+        sql = "select x from test where x >= ?"
+        count = 0
+        for x, in con.execute(sql, (0,)):
+            for y, in con.execute(sql, (x,)):
+                count += 1
+        self.assertEqual(count, 55)
+        # the outer and the inner cursor each reuse one prepared statement
+        self.assertEqual(con.prepared.count(sql), 2)
+        con.close()
+
+    def CheckSpareStatementEvictsNode(self):
+        sql = "select x from test where x >= ?"
+        class EvictingConnection(CountingConnection):
+            def __call__(self, s):
+                if s == sql and s in self.prepared:
+                    # push the statement for sql out of the cache
+                    for i in range(5):
+                        self.execute("select %d" % i)
+                return CountingConnection.__call__(self, s)
+        con = sqlite.connect(":memory:", factory=EvictingConnection, cached_statements=2)
+        con.execute("create table test(x)")
+        con.executemany("insert into test(x) values (?)", [(i,) for i in range(3)])
+        count = 0
+        for x, in con.execute(sql, (0,)):
+            for y, in con.execute(sql, (x,)):
+                count += 1
+        self.assertEqual(count, 6)
+        con.close()
+
+    def CheckFetchmanyDrainsResult(self):
+        con = sqlite.connect(":memory:", factory=CountingConnection)
+        sql = "select 1 union all select 2 union all select 3"
+        cur = con.execute(sql)
+        self.assertEqual(cur.fetchmany(3), [(1,), (2,), (3,)])
+        # the statement was released by fetchmany(), so it is not prepared again
+        self.assertEqual(con.execute(sql).fetchall(), [(1,), (2,), (3,)])
+        self.assertEqual(con.prepared.count(sql), 1)
+        self.assertEqual(cur.fetchmany(3), [])
+        con.close()
+
     def CheckColumnNameWithSpaces(self):
         cur = self.con.cursor()
         cur.execute('select 1 as "foo bar [datetime]"')
@@ -139,6 +139,40 @@ class TransactionTests(unittest.TestCase):
         # NO self.con2.rollback() HERE!!!
         self.con1.commit()
 
+    def CheckChangeIsolationLevel(self):
+        self.cur1.execute("create table test(i)")
+        self.con1.commit()
+        self.cur1.execute("insert into test(i) values (5)")
+        self.con1.commit()
+
+        # the next transaction must begin with the new isolation level
+        self.con1.isolation_level = "EXCLUSIVE"
+        self.cur1.execute("insert into test(i) values (6)")
+        self.assertRaises(sqlite.OperationalError, self.cur2.execute, "select i from test")
+        self.con1.commit()
+        self.cur2.execute("select i from test")
+        self.assertEqual(len(self.cur2.fetchall()), 2)
+
+    def CheckManyTransactions(self):
+        self.cur1.execute("create table test(i)")
+        self.con1.commit()
+        for i in range(10):
+            self.cur1.execute("insert into test(i) values (?)", (i,))
+            self.con1.commit()
+            self.con1.execute_dml("insert into test(i) values (?)", (i,))
+            self.con1.rollback()
+        self.cur2.execute("select i from test")
+        self.assertEqual([row[0] for row in self.cur2.fetchall()], range(10))
+
+    def CheckBadIsolationLevel(self):
+        self.cur1.execute("create table test(i)")
+        self.con1.commit()
+        self.con1.isolation_level = "NONSENSE"
+        self.assertRaises(sqlite.OperationalError, self.cur1.execute, "insert into test(i) values (5)")
+        self.con1.isolation_level = "DEFERRED"
+        self.cur1.execute("insert into test(i) values (5)")
+        self.con1.commit()
+
     def CheckRollbackCursorConsistency(self):
         """
         Checks if cursors on the connection are set into a "reset" state
@@ -22,7 +22,9 @@
 # 3. This notice may not be removed or altered from any source distribution.
 
 import datetime
+import gc
 import unittest
+import weakref
 import pysqlite2.dbapi2 as sqlite
 try:
     import zlib
@@ -73,6 +75,28 @@ class SqliteTypeTests(unittest.TestCase):
         row = self.cur.fetchone()
         self.assertEqual(row[0], val)
 
+    def CheckBlobBytearray(self):
+        self.cur.execute("insert into test(b) values (?)", (bytearray("Guglhupf"),))
+        self.cur.execute("select b from test")
+        self.assertEqual(str(self.cur.fetchone()[0]), "Guglhupf")
+
+    def CheckBlobMemoryview(self):
+        self.cur.execute("insert into test(b) values (?)", (memoryview("Guglhupf")[4:],))
+        self.cur.execute("select b from test")
+        self.assertEqual(str(self.cur.fetchone()[0]), "hupf")
+
+    def CheckBlobEmptyBytearray(self):
+        self.cur.execute("select ?", (bytearray(),))
+        self.assertEqual(str(self.cur.fetchone()[0]), "")
+
+    def CheckBlobPinned(self):
+        val = bytearray("Guglhupf")
+        self.cur.execute("select length(?) union all select 1", (val,))
+        with self.assertRaises(BufferError):
+            val.extend("!")
+        self.assertEqual(self.cur.fetchall(), [(8,), (1,)])
+        val.extend("!")
+
     def CheckUnicodeExecute(self):
         self.cur.execute(u"select 'sterreich'")
         row = self.cur.fetchone()
@@ -261,6 +285,36 @@ class DeclTypesTests(unittest.TestCase):
         row = self.cur.fetchone()
         self.assertEqual(row[0], val)
 
+    def CheckFetchallManyRows(self):
+        """Checks that converters are applied to all rows fetched in bulk"""
+        self.cur.executemany("insert into test(n1, b) values (?, ?)", [(i, i % 2) for i in range(600)])
+        self.cur.execute("select n1, b from test")
+        rows = self.cur.fetchall()
+        self.assertEqual(len(rows), 600)
+        self.assertEqual(rows[599], (599.0, True))
+        self.assertEqual(type(rows[599][0]), float)
+
+    def CheckConverterChangedBetweenExecutions(self):
+        self.cur.execute("insert into test(b) values (?)", (1,))
+        self.assertEqual(self.cur.execute("select b from test").fetchone()[0], True)
+        sqlite.converters["BOOL"] = lambda x: "changed"
+        self.assertEqual(self.cur.execute("select b from test").fetchone()[0], "changed")
+        sqlite.converters.update({"BOOL": lambda x: "updated"})
+        self.assertEqual(self.cur.execute("select b from test").fetchone()[0], "updated")
+        del sqlite.converters["BOOL"]
+        self.assertEqual(self.cur.execute("select b from test").fetchone()[0], 1)
+        sqlite.converters["BOOL"] = lambda x: bool(int(x))
+
+    def CheckConverterAfterSchemaChange(self):
+        self.cur.execute("create table schema_change(x bool)")
+        self.cur.execute("insert into schema_change(x) values (1)")
+        self.assertEqual(self.cur.execute("select x from schema_change").fetchone()[0], True)
+        self.cur.execute("drop table schema_change")
+        self.cur.execute("create table schema_change(x number)")
+        self.cur.execute("insert into schema_change(x) values (1)")
+        value = self.cur.execute("select x from schema_change").fetchone()[0]
+        self.assertEqual(type(value), float)
+
     def CheckNumber1(self):
         self.cur.execute("insert into test(n1) values (5)")
         value = self.cur.execute("select n1 from test").fetchone()[0]
@@ -356,6 +410,91 @@ class ObjectAdaptationTests(unittest.TestCase):
         val = self.cur.fetchone()[0]
         self.assertEqual(type(val), float)
 
+class AdapterCacheTests(unittest.TestCase):
+    class Point(object):
+        def __init__(self, x, y):
+            self.x, self.y = x, y
+
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+
+    def tearDown(self):
+        for key in [(self.Point, sqlite.PrepareProtocol), (int, sqlite.PrepareProtocol)]:
+            sqlite.adapters.pop(key, None)
+        self.con.close()
+
+    def select(self, value):
+        return self.con.execute("select ?", (value,)).fetchone()[0]
+
+    def CheckReplacedAdapter(self):
+        sqlite.register_adapter(self.Point, lambda p: "%d;%d" % (p.x, p.y))
+        self.assertEqual(self.select(self.Point(1, 2)), "1;2")
+        sqlite.register_adapter(self.Point, lambda p: "%d,%d" % (p.x, p.y))
+        self.assertEqual(self.select(self.Point(1, 2)), "1,2")
+
+    def CheckRemovedAdapter(self):
+        sqlite.register_adapter(self.Point, lambda p: "%d;%d" % (p.x, p.y))
+        self.assertEqual(self.select(self.Point(1, 2)), "1;2")
+        del sqlite.adapters[(self.Point, sqlite.PrepareProtocol)]
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+
+    def CheckAdapterAddedDirectly(self):
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+        sqlite.adapters[(self.Point, sqlite.PrepareProtocol)] = lambda p: "%d;%d" % (p.x, p.y)
+        self.assertEqual(self.select(self.Point(1, 2)), "1;2")
+
+    def CheckDictMethodsBypassRegistry(self):
+        # only the registry's own methods revalidate the cached lookups
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+        version = sqlite.adapters.version
+        dict.__setitem__(sqlite.adapters, (self.Point, sqlite.PrepareProtocol),
+                         lambda p: "%d;%d" % (p.x, p.y))
+        dict.update(sqlite.adapters, {})
+        self.assertEqual(sqlite.adapters.version, version)
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+        sqlite.adapters.update({})
+        self.assertNotEqual(sqlite.adapters.version, version)
+        self.assertEqual(self.select(self.Point(1, 2)), "1;2")
+
+    def CheckBaseTypeAdapter(self):
+        sqlite.register_adapter(int, float)
+        self.assertEqual(type(self.select(4)), float)
+        self.assertEqual(self.select("4"), "4")
+        del sqlite.adapters[(int, sqlite.PrepareProtocol)]
+        self.assertEqual(type(self.select(4)), int)
+
+    def CheckCachedTypeNotKeptAlive(self):
+        class Conforming(object):
+            def __conform__(self, protocol):
+                return "conformed"
+        self.assertEqual(self.select(Conforming()), "conformed")
+        ref = weakref.ref(Conforming)
+        del Conforming
+        gc.collect()
+        self.assertEqual(ref(), None)
+
+    def CheckConformAddedToType(self):
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+        self.Point.__conform__ = lambda p, protocol: "%d;%d" % (p.x, p.y)
+        try:
+            self.assertEqual(self.select(self.Point(1, 2)), "1;2")
+        finally:
+            del self.Point.__conform__
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+
+    def CheckConformInInstanceDict(self):
+        with self.assertRaises(sqlite.InterfaceError):
+            self.select(self.Point(1, 2))
+        p = self.Point(1, 2)
+        p.__conform__ = lambda protocol: "conformed"
+        self.assertEqual(self.select(p), "conformed")
+
 @unittest.skipUnless(zlib, "requires zlib")
 class BinaryConverterTests(unittest.TestCase):
     def convert(s):
@@ -428,14 +567,159 @@ class DateTimeTests(unittest.TestCase):
         ts2 = self.cur.fetchone()[0]
         self.assertEqual(ts, ts2)
 
+class NativeConverterTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:", detect_types=sqlite.PARSE_COLNAMES)
+        self.saved = sqlite.converters.copy()
+        for name in ("date", "timestamp", "boolean", "decimal", "json"):
+            sqlite.register_converter("native_" + name, name)
+
+    def tearDown(self):
+        sqlite.converters.clear()
+        sqlite.converters.update(self.saved)
+        self.con.close()
+
+    def select(self, typename, value):
+        return self.con.execute('select ? as "x [native_%s]"' % typename, (value,)).fetchone()[0]
+
+    def CheckUnknownName(self):
+        with self.assertRaises(ValueError):
+            sqlite.register_converter("bar", "no_such_converter")
+
+    def CheckCallable(self):
+        self.assertEqual(sqlite.converters["NATIVE_DATE"]("2004-02-14"), datetime.date(2004, 2, 14))
+
+    def CheckDate(self):
+        self.assertEqual(self.select("date", "2004-02-14"), datetime.date(2004, 2, 14))
+
+    def CheckTimestampFraction(self):
+        self.assertEqual(self.select("timestamp", "2004-02-14 07:15:00.5"),
+                         datetime.datetime(2004, 2, 14, 7, 15, 0, 500000))
+        self.assertEqual(self.select("timestamp", "2004-02-14 07:15:00.1234567"),
+                         datetime.datetime(2004, 2, 14, 7, 15, 0, 123456))
+
+    def CheckInvalidDate(self):
+        for value in ("2004-02-30", "2004-02", "2004-02-1x", "1900-02-29"):
+            with self.assertRaises(ValueError):
+                self.select("date", value)
+
+    def CheckInvalidTimestamp(self):
+        for value in ("2004-02-14", "2004-02-14 24:00:00", "2004-02-14 07:15:00.5x"):
+            with self.assertRaises(ValueError):
+                self.select("timestamp", value)
+
+    def CheckBoolean(self):
+        self.assertIs(self.select("boolean", 1), True)
+        self.assertIs(self.select("boolean", 0), False)
+
+    def CheckDecimal(self):
+        import decimal
+        value = self.select("decimal", "1.10")
+        self.assertEqual(type(value), str)
+        self.assertEqual(value, "1.10")
+        self.assertEqual(decimal.Decimal(value), decimal.Decimal("1.10"))
+        self.assertEqual(self.select("decimal", "-12345678901234567890.5e-3"), "-12345678901234567890.5e-3")
+
+    def CheckInvalidDecimal(self):
+        for value in ("1.2.3", "1e", "abc", ".", "1 "):
+            with self.assertRaises(ValueError):
+                self.select("decimal", value)
+
+    def CheckJson(self):
+        value = self.select("json", u'{"a": "\xe4"}')
+        self.assertEqual(value, u'{"a": "\xe4"}')
+        self.assertEqual(type(value), unicode)
+
+class NativeAdapterTests(unittest.TestCase):
+    def setUp(self):
+        self.con = sqlite.connect(":memory:")
+
+    def tearDown(self):
+        sqlite.register_adapter(datetime.date, "date")
+        sqlite.register_adapter(datetime.datetime, "timestamp")
+        self.con.close()
+
+    def select(self, value):
+        return self.con.execute("select ?", (value,)).fetchone()[0]
+
+    def CheckUnknownName(self):
+        with self.assertRaises(ValueError):
+            sqlite.register_adapter(datetime.date, "no_such_adapter")
+
+    def CheckDate(self):
+        self.assertEqual(self.select(datetime.date(1, 2, 3)), "0001-02-03")
+
+    def CheckTimestamp(self):
+        self.assertEqual(self.select(datetime.datetime(2004, 2, 14, 7, 15)), "2004-02-14 07:15:00")
+        self.assertEqual(self.select(datetime.datetime(2004, 2, 14, 7, 15, 0, 5)), "2004-02-14 07:15:00.000005")
+
+    def CheckTimestampWithTimezone(self):
+        class TZ(datetime.tzinfo):
+            def utcoffset(self, dt):
+                return datetime.timedelta(hours=1)
+        ts = datetime.datetime(2004, 2, 14, 7, 15, tzinfo=TZ())
+        self.assertEqual(self.select(ts), "2004-02-14 07:15:00+01:00")
+
+    def CheckNamedParameters(self):
+        result = self.con.execute("select :d", {"d": datetime.date(2004, 2, 14)}).fetchone()[0]
+        self.assertEqual(result, "2004-02-14")
+
+    def CheckAdapterIsCallable(self):
+        adapter = sqlite.adapters[(datetime.date, sqlite.PrepareProtocol)]
+        self.assertEqual(adapter(datetime.date(2004, 2, 14)), "2004-02-14")
+        with self.assertRaises(TypeError):
+            adapter(42)
+
+    def CheckOverride(self):
+        sqlite.register_adapter(datetime.date, lambda d: d.strftime("%d.%m.%Y"))
+        self.assertEqual(self.select(datetime.date(2004, 2, 14)), "14.02.2004")
+        sqlite.register_adapter(datetime.date, "date")
+        self.assertEqual(self.select(datetime.date(2004, 2, 14)), "2004-02-14")
+
+    def CheckDecimal(self):
+        import decimal
+        class Money(decimal.Decimal):
+            pass
+        sqlite.register_adapter(Money, "decimal")
+        self.assertEqual(self.select(Money("1.10")), "1.10")
+
+    def CheckUuid(self):
+        import uuid
+        class Key(uuid.UUID):
+            pass
+        sqlite.register_adapter(Key, "uuid")
+        key = Key("12345678-9abc-def0-1234-56789abcdef0")
+        self.assertEqual(self.select(key), str(key))
+
+    def CheckAdapterError(self):
+        import uuid
+        class BadKey(uuid.UUID):
+            @property
+            def int(self):
+                raise ZeroDivisionError
+        sqlite.register_adapter(BadKey, "uuid")
+        key = BadKey("12345678-9abc-def0-1234-56789abcdef0")
+        self.con.execute("create table test(x)")
+        # every way of binding raises the error of the adapter
+        with self.assertRaises(ZeroDivisionError):
+            self.con.execute("insert into test(x) values (?)", (key,))
+        with self.assertRaises(ZeroDivisionError):
+            self.con.execute_dml("insert into test(x) values (?)", (key,))
+        with self.assertRaises(ZeroDivisionError):
+            self.con.cursor().executecolumns("insert into test(x) values (?)", [[key]])
+        self.assertEqual(self.con.execute("select count(*) from test").fetchone()[0], 0)
+
 def suite():
     sqlite_type_suite = unittest.makeSuite(SqliteTypeTests, "Check")
     decltypes_type_suite = unittest.makeSuite(DeclTypesTests, "Check")
     colnames_type_suite = unittest.makeSuite(ColNamesTests, "Check")
     adaptation_suite = unittest.makeSuite(ObjectAdaptationTests, "Check")
+    adapter_cache_suite = unittest.makeSuite(AdapterCacheTests, "Check")
     bin_suite = unittest.makeSuite(BinaryConverterTests, "Check")
     date_suite = unittest.makeSuite(DateTimeTests, "Check")
-    return unittest.TestSuite((sqlite_type_suite, decltypes_type_suite, colnames_type_suite, adaptation_suite, bin_suite, date_suite))
+    native_suite = unittest.makeSuite(NativeConverterTests, "Check")
+    native_adapter_suite = unittest.makeSuite(NativeAdapterTests, "Check")
+    return unittest.TestSuite((sqlite_type_suite, decltypes_type_suite, colnames_type_suite, adaptation_suite, adapter_cache_suite, bin_suite, date_suite, native_suite, native_adapter_suite))
 
 def test():
     runner = unittest.TextTestRunner()
@@ -26,7 +26,7 @@ else:
 OPT = "-O2"
 
 # pysqlite sources + SQLite amalgamation
-SRC = "src/module.c src/connection.c src/cursor.c src/cache.c src/microprotocols.c src/prepare_protocol.c src/statement.c src/util.c src/row.c amalgamation/sqlite3.c"
+SRC = "src/module.c src/connection.c src/cursor.c src/cache.c src/microprotocols.c src/prepare_protocol.c src/statement.c src/util.c src/row.c src/column.c src/registry.c src/converters.c src/adapters.c src/blob.c src/pool.c amalgamation/sqlite3.c"
 
 # You will need to fetch these from
 # https://pyext-cross.pysqlite.googlecode.com/hg/
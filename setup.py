@@ -49,7 +49,9 @@ PYSQLITE_EXPERIMENTAL = False
 
 sources = ["src/module.c", "src/connection.c", "src/cursor.c", "src/cache.c",
            "src/microprotocols.c", "src/prepare_protocol.c", "src/statement.c",
-           "src/util.c", "src/row.c"]
+           "src/util.c", "src/row.c", "src/column.c", "src/registry.c",
+           "src/converters.c", "src/adapters.c", "src/blob.c",
+           "src/pool.c"]
 
 if PYSQLITE_EXPERIMENTAL:
     sources.append("src/backup.c")
@@ -0,0 +1,321 @@
+/* adapters.c - adapters implemented in C
+ *
+ * Copyright (C) 2016 Gerhard Hring <gh@ghaering.de>
+ *
+ * This file is part of pysqlite.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "adapters.h"
+#include "module.h"
+#include "cursor.h"
+#include "microprotocols.h"
+#include "datetime.h"
+#include "structmember.h"
+
+enum {
+    ADAPTER_DATE,
+    ADAPTER_TIMESTAMP,
+    ADAPTER_DECIMAL,
+    ADAPTER_UUID,
+    ADAPTER_COUNT
+};
+
+static const char* adapter_names[] = {"date", "timestamp", "decimal", "uuid"};
+
+static PyObject* native_adapters[ADAPTER_COUNT];
+
+static const char hexdigits[] = "0123456789abcdef";
+
+static int _pysqlite_adapt_date(PyObject* obj, pysqlite_Value* value, char* buf)
+{
+    if (!PyDate_Check(obj)) {
+        return 0;
+    }
+
+    value->nbytes = PyOS_snprintf(buf, PYSQLITE_NATIVE_ADAPT_BUFSIZE, "%04d-%02d-%02d",
+            PyDateTime_GET_YEAR(obj), PyDateTime_GET_MONTH(obj), PyDateTime_GET_DAY(obj));
+    value->data = buf;
+
+    return 1;
+}
+
+static int _pysqlite_adapt_timestamp(PyObject* obj, pysqlite_Value* value, char* buf)
+{
+    PyObject* text;
+    int microsecond;
+
+    if (!PyDateTime_Check(obj)) {
+        return 0;
+    }
+
+    if (((_PyDateTime_BaseTZInfo*)obj)->hastzinfo) {
+        /* the UTC offset comes from a Python method anyway */
+        text = PyObject_CallMethod(obj, "isoformat", "s", " ");
+        if (!text) {
+            return -1;
+        }
+        if (!PyString_Check(text)) {
+            Py_DECREF(text);
+            PyErr_SetString(PyExc_TypeError, "isoformat() must return a str");
+            return -1;
+        }
+        value->data = PyString_AS_STRING(text);
+        value->nbytes = PyString_GET_SIZE(text);
+        value->owner = text;
+        return 1;
+    }
+
+    value->nbytes = PyOS_snprintf(buf, PYSQLITE_NATIVE_ADAPT_BUFSIZE, "%04d-%02d-%02d %02d:%02d:%02d",
+            PyDateTime_GET_YEAR(obj), PyDateTime_GET_MONTH(obj), PyDateTime_GET_DAY(obj),
+            PyDateTime_DATE_GET_HOUR(obj), PyDateTime_DATE_GET_MINUTE(obj), PyDateTime_DATE_GET_SECOND(obj));
+
+    microsecond = PyDateTime_DATE_GET_MICROSECOND(obj);
+    if (microsecond) {
+        value->nbytes += PyOS_snprintf(buf + value->nbytes, PYSQLITE_NATIVE_ADAPT_BUFSIZE - value->nbytes,
+                ".%06d", microsecond);
+    }
+    value->data = buf;
+
+    return 1;
+}
+
+static int _pysqlite_adapt_decimal(PyObject* obj, pysqlite_Value* value, char* buf)
+{
+    PyObject* text;
+
+    /* Decimal formats itself in Python; this only skips the registry */
+    text = PyObject_Str(obj);
+    if (!text) {
+        return -1;
+    }
+
+    value->data = PyString_AS_STRING(text);
+    value->nbytes = PyString_GET_SIZE(text);
+    value->owner = text;
+
+    return 1;
+}
+
+static int _pysqlite_adapt_uuid(PyObject* obj, pysqlite_Value* value, char* buf)
+{
+    PyObject* number;
+    PyObject* long_number;
+    unsigned char bytes[16];
+    char* pos;
+    int rc;
+    int i;
+
+    /* the same text as str(uuid), formatted from the 128 bit integer */
+    number = PyObject_GetAttrString(obj, "int");
+    if (!number) {
+        return -1;
+    }
+
+    if (PyInt_Check(number)) {
+        long_number = PyLong_FromLong(PyInt_AS_LONG(number));
+        Py_DECREF(number);
+        number = long_number;
+        if (!number) {
+            return -1;
+        }
+    } else if (!PyLong_Check(number)) {
+        Py_DECREF(number);
+        PyErr_SetString(PyExc_TypeError, "UUID.int must be an integer");
+        return -1;
+    }
+
+    rc = _PyLong_AsByteArray((PyLongObject*)number, bytes, sizeof(bytes), 0, 0);
+    Py_DECREF(number);
+    if (rc != 0) {
+        return -1;
+    }
+
+    pos = buf;
+    for (i = 0; i < 16; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) {
+            *pos++ = '-';
+        }
+        *pos++ = hexdigits[bytes[i] >> 4];
+        *pos++ = hexdigits[bytes[i] & 0x0f];
+    }
+
+    value->data = buf;
+    value->nbytes = pos - buf;
+
+    return 1;
+}
+
+static int _pysqlite_native_adapt(int kind, PyObject* obj, pysqlite_Value* value, char* buf)
+{
+    value->type = SQLITE_TEXT;
+    value->owner = NULL;
+
+    switch (kind) {
+        case ADAPTER_DATE:
+            return _pysqlite_adapt_date(obj, value, buf);
+        case ADAPTER_TIMESTAMP:
+            return _pysqlite_adapt_timestamp(obj, value, buf);
+        case ADAPTER_DECIMAL:
+            return _pysqlite_adapt_decimal(obj, value, buf);
+        default:
+            return _pysqlite_adapt_uuid(obj, value, buf);
+    }
+}
+
+int pysqlite_native_adapt(PyObject* obj, pysqlite_Value* value, char* buf)
+{
+    PyObject* adapter;
+
+    adapter = pysqlite_microprotocols_lookup(Py_TYPE(obj));
+    if (!adapter) {
+        return PyErr_Occurred() ? -1 : 0;
+    }
+
+    if (!pysqlite_NativeAdapter_Check(adapter)) {
+        return 0;
+    }
+
+    return _pysqlite_native_adapt(((pysqlite_NativeAdapter*)adapter)->kind, obj, value, buf);
+}
+
+PyObject* pysqlite_native_adapter_get(const char* name)
+{
+    int i;
+
+    for (i = 0; i < ADAPTER_COUNT; i++) {
+        if (strcmp(name, adapter_names[i]) == 0) {
+            Py_INCREF(native_adapters[i]);
+            return native_adapters[i];
+        }
+    }
+
+    PyErr_Format(PyExc_ValueError, "unknown native adapter '%.100s'", name);
+    return NULL;
+}
+
+static PyObject* pysqlite_native_adapter_call(pysqlite_NativeAdapter* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* obj;
+    pysqlite_Value value;
+    char buf[PYSQLITE_NATIVE_ADAPT_BUFSIZE];
+    int rc;
+
+    if (!_PyArg_NoKeywords("NativeAdapter()", kwargs)) {
+        return NULL;
+    }
+
+    if (!PyArg_ParseTuple(args, "O", &obj)) {
+        return NULL;
+    }
+
+    rc = _pysqlite_native_adapt(self->kind, obj, &value, buf);
+    if (rc == 0) {
+        PyErr_Format(PyExc_TypeError, "native adapter '%s' can't adapt %.200s objects",
+                     self->name, Py_TYPE(obj)->tp_name);
+        return NULL;
+    } else if (rc < 0) {
+        return NULL;
+    }
+
+    if (value.owner) {
+        return value.owner;
+    }
+
+    return PyString_FromStringAndSize(value.data, value.nbytes);
+}
+
+static PyObject* pysqlite_native_adapter_repr(pysqlite_NativeAdapter* self)
+{
+    return PyString_FromFormat("<native adapter '%s'>", self->name);
+}
+
+static struct PyMemberDef native_adapter_members[] =
+{
+    {"name", T_STRING, offsetof(pysqlite_NativeAdapter, name), RO},
+    {NULL}
+};
+
+PyTypeObject pysqlite_NativeAdapterType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        MODULE_NAME ".NativeAdapter",                   /* tp_name */
+        sizeof(pysqlite_NativeAdapter),                 /* tp_basicsize */
+        0,                                              /* tp_itemsize */
+        0,                                              /* tp_dealloc */
+        0,                                              /* tp_print */
+        0,                                              /* tp_getattr */
+        0,                                              /* tp_setattr */
+        0,                                              /* tp_compare */
+        (reprfunc)pysqlite_native_adapter_repr,         /* tp_repr */
+        0,                                              /* tp_as_number */
+        0,                                              /* tp_as_sequence */
+        0,                                              /* tp_as_mapping */
+        0,                                              /* tp_hash */
+        (ternaryfunc)pysqlite_native_adapter_call,      /* tp_call */
+        0,                                              /* tp_str */
+        0,                                              /* tp_getattro */
+        0,                                              /* tp_setattro */
+        0,                                              /* tp_as_buffer */
+        Py_TPFLAGS_DEFAULT,                             /* tp_flags */
+        0,                                              /* tp_doc */
+        0,                                              /* tp_traverse */
+        0,                                              /* tp_clear */
+        0,                                              /* tp_richcompare */
+        0,                                              /* tp_weaklistoffset */
+        0,                                              /* tp_iter */
+        0,                                              /* tp_iternext */
+        0,                                              /* tp_methods */
+        native_adapter_members,                         /* tp_members */
+        0,                                              /* tp_getset */
+        0,                                              /* tp_base */
+        0,                                              /* tp_dict */
+        0,                                              /* tp_descr_get */
+        0,                                              /* tp_descr_set */
+        0,                                              /* tp_dictoffset */
+        0,                                              /* tp_init */
+        0,                                              /* tp_alloc */
+        0,                                              /* tp_new */
+        0                                               /* tp_free */
+};
+
+extern int pysqlite_adapters_setup_types(void)
+{
+    pysqlite_NativeAdapter* adapter;
+    int i;
+
+    PyDateTime_IMPORT;
+    if (!PyDateTimeAPI) {
+        return -1;
+    }
+
+    if (PyType_Ready(&pysqlite_NativeAdapterType) < 0) {
+        return -1;
+    }
+
+    for (i = 0; i < ADAPTER_COUNT; i++) {
+        adapter = PyObject_New(pysqlite_NativeAdapter, &pysqlite_NativeAdapterType);
+        if (!adapter) {
+            return -1;
+        }
+        adapter->kind = i;
+        adapter->name = adapter_names[i];
+        native_adapters[i] = (PyObject*)adapter;
+    }
+
+    return 0;
+}
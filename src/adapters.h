@@ -0,0 +1,64 @@
+/* adapters.h - adapters implemented in C
+ *
+ * Copyright (C) 2016 Gerhard Hring <gh@ghaering.de>
+ *
+ * This file is part of pysqlite.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PYSQLITE_ADAPTERS_H
+#define PYSQLITE_ADAPTERS_H
+#include "Python.h"
+
+#include "statement.h"
+
+/* An adapter implemented in C. Instances are callable like any other
+ * adapter, but when one is registered for a type the statement formats
+ * parameters of exactly that type with pysqlite_native_adapt(), without
+ * calling into Python. */
+
+typedef struct
+{
+    PyObject_HEAD
+    int kind;
+    const char* name;
+} pysqlite_NativeAdapter;
+
+extern PyTypeObject pysqlite_NativeAdapterType;
+
+#define pysqlite_NativeAdapter_Check(op) (Py_TYPE(op) == &pysqlite_NativeAdapterType)
+
+/* large enough for every text the native adapters format in place */
+#define PYSQLITE_NATIVE_ADAPT_BUFSIZE 64
+
+/* returns a new reference to the native adapter called name, or NULL with
+ * a ValueError set if there is none */
+PyObject* pysqlite_native_adapter_get(const char* name);
+
+/*
+ * Formats obj with the native adapter registered for its type. The text is
+ * written to buf, which must hold PYSQLITE_NATIVE_ADAPT_BUFSIZE bytes, or
+ * is owned by value->owner.
+ *
+ * 1 => value filled in; 0 => no native adapter for obj; -1 => error
+ */
+int pysqlite_native_adapt(PyObject* obj, pysqlite_Value* value, char* buf);
+
+int pysqlite_adapters_setup_types(void);
+
+#endif
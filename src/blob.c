@@ -0,0 +1,501 @@
+/* blob.c - incremental BLOB I/O
+ *
+ * Copyright (C) 2016 Gerhard Hring <gh@ghaering.de>
+ *
+ * This file is part of pysqlite.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "blob.h"
+#include "module.h"
+#include "util.h"
+
+int pysqlite_blob_close_handle(pysqlite_Blob* self)
+{
+    int rc = SQLITE_OK;
+
+    if (self->blob) {
+        Py_BEGIN_ALLOW_THREADS
+        rc = sqlite3_blob_close(self->blob);
+        Py_END_ALLOW_THREADS
+        self->blob = NULL;
+    }
+
+    return rc;
+}
+
+static void pysqlite_blob_dealloc(pysqlite_Blob* self)
+{
+    (void)pysqlite_blob_close_handle(self);
+
+    Py_XDECREF(self->connection);
+
+    if (self->in_weakreflist != NULL) {
+        PyObject_ClearWeakRefs((PyObject*)self);
+    }
+
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+/*
+ * Checks if the blob is usable from this thread.
+ *
+ * 0 => error; 1 => ok
+ */
+static int check_blob(pysqlite_Blob* self)
+{
+    if (!pysqlite_check_thread(self->connection) || !pysqlite_check_connection(self->connection)) {
+        return 0;
+    }
+
+    if (!self->blob) {
+        PyErr_SetString(pysqlite_ProgrammingError, "Cannot operate on a closed blob.");
+        return 0;
+    }
+
+    return 1;
+}
+
+/* reads nbytes bytes at the current position into buf and advances it */
+static int _pysqlite_blob_read(pysqlite_Blob* self, void* buf, int nbytes)
+{
+    int rc;
+
+    Py_BEGIN_ALLOW_THREADS
+    rc = sqlite3_blob_read(self->blob, buf, nbytes, self->offset);
+    Py_END_ALLOW_THREADS
+
+    if (rc != SQLITE_OK) {
+        _pysqlite_seterror(self->connection->db, NULL);
+        return -1;
+    }
+
+    self->offset += nbytes;
+
+    return 0;
+}
+
+/* the number of bytes from the current position up to nbytes */
+static int _pysqlite_blob_available(pysqlite_Blob* self, Py_ssize_t nbytes)
+{
+    int remaining = sqlite3_blob_bytes(self->blob) - self->offset;
+
+    if (remaining < 0) {
+        remaining = 0;
+    }
+
+    if (nbytes < 0 || nbytes > remaining) {
+        return remaining;
+    }
+
+    return (int)nbytes;
+}
+
+PyObject* pysqlite_blob_read(pysqlite_Blob* self, PyObject* args)
+{
+    Py_ssize_t size = -1;
+    int nbytes;
+    PyObject* data;
+
+    if (!PyArg_ParseTuple(args, "|n", &size)) {
+        return NULL;
+    }
+
+    if (!check_blob(self)) {
+        return NULL;
+    }
+
+    nbytes = _pysqlite_blob_available(self, size);
+
+    data = PyString_FromStringAndSize(NULL, nbytes);
+    if (!data) {
+        return NULL;
+    }
+
+    if (nbytes > 0 && _pysqlite_blob_read(self, PyString_AS_STRING(data), nbytes) != 0) {
+        Py_DECREF(data);
+        return NULL;
+    }
+
+    return data;
+}
+
+PyObject* pysqlite_blob_readinto(pysqlite_Blob* self, PyObject* args)
+{
+    Py_buffer view;
+    int nbytes;
+
+    if (!PyArg_ParseTuple(args, "w*", &view)) {
+        return NULL;
+    }
+
+    if (!check_blob(self)) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    nbytes = _pysqlite_blob_available(self, view.len);
+
+    if (nbytes > 0 && _pysqlite_blob_read(self, view.buf, nbytes) != 0) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    PyBuffer_Release(&view);
+
+    return PyInt_FromLong(nbytes);
+}
+
+PyObject* pysqlite_blob_write(pysqlite_Blob* self, PyObject* args)
+{
+    Py_buffer view;
+    int rc;
+
+    if (!PyArg_ParseTuple(args, "s*", &view)) {
+        return NULL;
+    }
+
+    if (!check_blob(self)) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    /* a blob can't change its size */
+    if (view.len > sqlite3_blob_bytes(self->blob) - self->offset) {
+        PyBuffer_Release(&view);
+        PyErr_SetString(PyExc_ValueError, "data longer than the rest of the blob");
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    rc = sqlite3_blob_write(self->blob, view.buf, (int)view.len, self->offset);
+    Py_END_ALLOW_THREADS
+
+    if (rc != SQLITE_OK) {
+        PyBuffer_Release(&view);
+        _pysqlite_seterror(self->connection->db, NULL);
+        return NULL;
+    }
+
+    self->offset += (int)view.len;
+    PyBuffer_Release(&view);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyObject* pysqlite_blob_seek(pysqlite_Blob* self, PyObject* args)
+{
+    Py_ssize_t offset;
+    int whence = 0;
+
+    if (!PyArg_ParseTuple(args, "n|i", &offset, &whence)) {
+        return NULL;
+    }
+
+    if (!check_blob(self)) {
+        return NULL;
+    }
+
+    switch (whence) {
+        case 0:
+            break;
+        case 1:
+            offset += self->offset;
+            break;
+        case 2:
+            offset += sqlite3_blob_bytes(self->blob);
+            break;
+        default:
+            PyErr_SetString(PyExc_ValueError, "whence must be 0, 1 or 2");
+            return NULL;
+    }
+
+    if (offset < 0 || offset > sqlite3_blob_bytes(self->blob)) {
+        PyErr_SetString(PyExc_ValueError, "offset out of blob range");
+        return NULL;
+    }
+
+    self->offset = (int)offset;
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyObject* pysqlite_blob_tell(pysqlite_Blob* self, PyObject* args)
+{
+    if (!check_blob(self)) {
+        return NULL;
+    }
+
+    return PyInt_FromLong(self->offset);
+}
+
+PyObject* pysqlite_blob_reopen(pysqlite_Blob* self, PyObject* args)
+{
+    sqlite_int64 rowid;
+    int rc;
+
+    if (!PyArg_ParseTuple(args, "L", &rowid)) {
+        return NULL;
+    }
+
+    if (!check_blob(self)) {
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    rc = sqlite3_blob_reopen(self->blob, rowid);
+    Py_END_ALLOW_THREADS
+
+    if (rc != SQLITE_OK) {
+        _pysqlite_seterror(self->connection->db, NULL);
+        return NULL;
+    }
+
+    self->offset = 0;
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+/*
+ * Reads the values of the rows in rowids one after the other into buffer,
+ * moving the blob to each row in turn, with the GIL released for the whole
+ * loop. Returns the list of the sizes of the values read, which is shorter
+ * than rowids if the next value didn't fit into the rest of buffer.
+ */
+PyObject* pysqlite_blob_readmany(pysqlite_Blob* self, PyObject* args)
+{
+    PyObject* rowid_list;
+    PyObject* rowid_seq = NULL;
+    PyObject* sizes = NULL;
+    PyObject* size;
+    Py_buffer view;
+    sqlite_int64* rowids = NULL;
+    int* nbytes = NULL;
+    Py_ssize_t count;
+    Py_ssize_t done = 0;
+    Py_ssize_t position = 0;
+    Py_ssize_t i;
+    int rc = SQLITE_OK;
+
+    if (!PyArg_ParseTuple(args, "Ow*", &rowid_list, &view)) {
+        return NULL;
+    }
+
+    if (!check_blob(self)) {
+        goto error;
+    }
+
+    rowid_seq = PySequence_Fast(rowid_list, "rowids must be a sequence");
+    if (!rowid_seq) {
+        goto error;
+    }
+
+    count = PySequence_Fast_GET_SIZE(rowid_seq);
+    rowids = PyMem_New(sqlite_int64, count ? count : 1);
+    nbytes = PyMem_New(int, count ? count : 1);
+    if (!rowids || !nbytes) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (i = 0; i < count; i++) {
+        rowids[i] = PyLong_AsLongLong(PySequence_Fast_GET_ITEM(rowid_seq, i));
+        if (rowids[i] == -1 && PyErr_Occurred()) {
+            goto error;
+        }
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    for (done = 0; done < count; done++) {
+        rc = sqlite3_blob_reopen(self->blob, rowids[done]);
+        if (rc != SQLITE_OK) {
+            break;
+        }
+
+        nbytes[done] = sqlite3_blob_bytes(self->blob);
+        if (nbytes[done] > view.len - position) {
+            break;
+        }
+
+        rc = sqlite3_blob_read(self->blob, (char*)view.buf + position, nbytes[done], 0);
+        if (rc != SQLITE_OK) {
+            break;
+        }
+        position += nbytes[done];
+    }
+    Py_END_ALLOW_THREADS
+
+    self->offset = 0;
+
+    if (rc != SQLITE_OK) {
+        _pysqlite_seterror(self->connection->db, NULL);
+        goto error;
+    }
+
+    sizes = PyList_New(done);
+    if (!sizes) {
+        goto error;
+    }
+
+    for (i = 0; i < done; i++) {
+        size = PyInt_FromLong(nbytes[i]);
+        if (!size) {
+            Py_CLEAR(sizes);
+            goto error;
+        }
+        PyList_SET_ITEM(sizes, i, size);
+    }
+
+error:
+    PyBuffer_Release(&view);
+    Py_XDECREF(rowid_seq);
+    PyMem_Free(rowids);
+    PyMem_Free(nbytes);
+
+    return sizes;
+}
+
+PyObject* pysqlite_blob_close(pysqlite_Blob* self, PyObject* args)
+{
+    if (!pysqlite_check_thread(self->connection)) {
+        return NULL;
+    }
+
+    /* sqlite3_blob_close() repeats the error of a failed read or write,
+     * which has been reported already */
+    (void)pysqlite_blob_close_handle(self);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* pysqlite_blob_enter(pysqlite_Blob* self, PyObject* args)
+{
+    if (!check_blob(self)) {
+        return NULL;
+    }
+
+    Py_INCREF(self);
+    return (PyObject*)self;
+}
+
+static PyObject* pysqlite_blob_exit(pysqlite_Blob* self, PyObject* args)
+{
+    PyObject* result;
+
+    result = pysqlite_blob_close(self, NULL);
+    if (!result) {
+        return NULL;
+    }
+    Py_DECREF(result);
+
+    Py_RETURN_FALSE;
+}
+
+static Py_ssize_t pysqlite_blob_length(pysqlite_Blob* self)
+{
+    if (!check_blob(self)) {
+        return -1;
+    }
+
+    return sqlite3_blob_bytes(self->blob);
+}
+
+static PyMethodDef blob_methods[] = {
+    {"read", (PyCFunction)pysqlite_blob_read, METH_VARARGS,
+        PyDoc_STR("Reads up to size bytes, or the rest of the blob.")},
+    {"readinto", (PyCFunction)pysqlite_blob_readinto, METH_VARARGS,
+        PyDoc_STR("Reads into a writable buffer. Returns the number of bytes read.")},
+    {"write", (PyCFunction)pysqlite_blob_write, METH_VARARGS,
+        PyDoc_STR("Writes data at the current position. The blob can't grow.")},
+    {"seek", (PyCFunction)pysqlite_blob_seek, METH_VARARGS,
+        PyDoc_STR("Changes the position, relative to whence like for files.")},
+    {"tell", (PyCFunction)pysqlite_blob_tell, METH_NOARGS,
+        PyDoc_STR("Returns the current position.")},
+    {"reopen", (PyCFunction)pysqlite_blob_reopen, METH_VARARGS,
+        PyDoc_STR("Moves the blob to the same column of another row.")},
+    {"readmany", (PyCFunction)pysqlite_blob_readmany, METH_VARARGS,
+        PyDoc_STR("Reads the values of several rows into a writable buffer. Returns their sizes.")},
+    {"close", (PyCFunction)pysqlite_blob_close, METH_NOARGS,
+        PyDoc_STR("Closes the blob.")},
+    {"__enter__", (PyCFunction)pysqlite_blob_enter, METH_NOARGS,
+        PyDoc_STR("For context manager. Non-standard.")},
+    {"__exit__", (PyCFunction)pysqlite_blob_exit, METH_VARARGS,
+        PyDoc_STR("For context manager. Non-standard.")},
+    {NULL, NULL}
+};
+
+static PySequenceMethods blob_as_sequence = {
+   /* sq_length */         (lenfunc)pysqlite_blob_length,
+   /* sq_concat */         0,
+   /* sq_repeat */         0,
+   /* sq_item */           0,
+};
+
+static char blob_doc[] =
+PyDoc_STR("Incremental I/O on a SQLite BLOB.");
+
+PyTypeObject pysqlite_BlobType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        MODULE_NAME ".Blob",                            /* tp_name */
+        sizeof(pysqlite_Blob),                          /* tp_basicsize */
+        0,                                              /* tp_itemsize */
+        (destructor)pysqlite_blob_dealloc,              /* tp_dealloc */
+        0,                                              /* tp_print */
+        0,                                              /* tp_getattr */
+        0,                                              /* tp_setattr */
+        0,                                              /* tp_compare */
+        0,                                              /* tp_repr */
+        0,                                              /* tp_as_number */
+        &blob_as_sequence,                              /* tp_as_sequence */
+        0,                                              /* tp_as_mapping */
+        0,                                              /* tp_hash */
+        0,                                              /* tp_call */
+        0,                                              /* tp_str */
+        0,                                              /* tp_getattro */
+        0,                                              /* tp_setattro */
+        0,                                              /* tp_as_buffer */
+        Py_TPFLAGS_DEFAULT|Py_TPFLAGS_HAVE_WEAKREFS,    /* tp_flags */
+        blob_doc,                                       /* tp_doc */
+        0,                                              /* tp_traverse */
+        0,                                              /* tp_clear */
+        0,                                              /* tp_richcompare */
+        offsetof(pysqlite_Blob, in_weakreflist),        /* tp_weaklistoffset */
+        0,                                              /* tp_iter */
+        0,                                              /* tp_iternext */
+        blob_methods,                                   /* tp_methods */
+        0,                                              /* tp_members */
+        0,                                              /* tp_getset */
+        0,                                              /* tp_base */
+        0,                                              /* tp_dict */
+        0,                                              /* tp_descr_get */
+        0,                                              /* tp_descr_set */
+        0,                                              /* tp_dictoffset */
+        (initproc)0,                                    /* tp_init */
+        0,                                              /* tp_alloc */
+        0,                                              /* tp_new */
+        0                                               /* tp_free */
+};
+
+extern int pysqlite_blob_setup_types(void)
+{
+    return PyType_Ready(&pysqlite_BlobType);
+}
@@ -22,46 +22,72 @@
  */
 
 #include "cache.h"
+#include "connection.h"
+#include "statement.h"
 #include <limits.h>
 
-/* only used internally */
-pysqlite_Node* pysqlite_new_node(PyObject* key, PyObject* data)
+/* number of hash table slots a new cache starts with */
+#define PYSQLITE_CACHE_MINSLOTS 16
+
+static pysqlite_Node* pysqlite_new_node(PyObject* key, long hash, PyObject* data)
 {
     pysqlite_Node* node;
 
-    node = (pysqlite_Node*) (pysqlite_NodeType.tp_alloc(&pysqlite_NodeType, 0));
+    node = PyMem_New(pysqlite_Node, 1);
     if (!node) {
+        PyErr_NoMemory();
         return NULL;
     }
 
     Py_INCREF(key);
     node->key = key;
+    node->hash = hash;
 
     Py_INCREF(data);
     node->data = data;
 
+    node->count = 0;
+    memset(node->spares, 0, sizeof(node->spares));
+    node->pinned = 0;
     node->prev = NULL;
     node->next = NULL;
+    node->chain = NULL;
+    node->bucket = NULL;
 
     return node;
 }
 
-void pysqlite_node_dealloc(pysqlite_Node* self)
+static void pysqlite_free_node(pysqlite_Node* node)
 {
-    Py_DECREF(self->key);
-    Py_DECREF(self->data);
+    int i;
 
-    Py_TYPE(self)->tp_free((PyObject*)self);
+    Py_DECREF(node->key);
+    Py_DECREF(node->data);
+    for (i = 0; i < PYSQLITE_CACHE_SPARES; i++) {
+        Py_XDECREF(node->spares[i]);
+    }
+
+    PyMem_Free(node);
 }
 
 int pysqlite_cache_init(pysqlite_Cache* self, PyObject* args, PyObject* kwargs)
 {
     PyObject* factory;
     int size = 10;
+    const char* policy = "lfu";
 
     self->factory = NULL;
 
-    if (!PyArg_ParseTuple(args, "O|i", &factory, &size)) {
+    if (!PyArg_ParseTuple(args, "O|is", &factory, &size, &policy)) {
+        return -1;
+    }
+
+    if (strcmp(policy, "lfu") == 0) {
+        self->policy = PYSQLITE_CACHE_LFU;
+    } else if (strcmp(policy, "lru") == 0) {
+        self->policy = PYSQLITE_CACHE_LRU;
+    } else {
+        PyErr_Format(PyExc_ValueError, "unknown cache policy '%s', use 'lfu' or 'lru'", policy);
         return -1;
     }
 
@@ -72,11 +98,19 @@ int pysqlite_cache_init(pysqlite_Cache* self, PyObject* args, PyObject* kwargs)
     self->size = size;
     self->first = NULL;
     self->last = NULL;
-
-    self->mapping = PyDict_New();
-    if (!self->mapping) {
+    self->first_bucket = NULL;
+    self->last_bucket = NULL;
+    self->pinned = NULL;
+    self->npinned = 0;
+    self->used = 0;
+
+    self->table = PyMem_New(pysqlite_Node*, PYSQLITE_CACHE_MINSLOTS);
+    if (!self->table) {
+        PyErr_NoMemory();
         return -1;
     }
+    memset(self->table, 0, PYSQLITE_CACHE_MINSLOTS * sizeof(pysqlite_Node*));
+    self->mask = PYSQLITE_CACHE_MINSLOTS - 1;
 
     Py_INCREF(factory);
     self->factory = factory;
@@ -90,6 +124,8 @@ void pysqlite_cache_dealloc(pysqlite_Cache* self)
 {
     pysqlite_Node* node;
     pysqlite_Node* delete_node;
+    pysqlite_Bucket* bucket;
+    pysqlite_Bucket* delete_bucket;
 
     if (!self->factory) {
         /* constructor failed, just get out of here */
@@ -101,116 +137,562 @@ void pysqlite_cache_dealloc(pysqlite_Cache* self)
     while (node) {
         delete_node = node;
         node = node->next;
-        Py_DECREF(delete_node);
+        pysqlite_free_node(delete_node);
+    }
+    node = self->pinned;
+    while (node) {
+        delete_node = node;
+        node = node->next;
+        pysqlite_free_node(delete_node);
+    }
+    PyMem_Free(self->table);
+
+    bucket = self->first_bucket;
+    while (bucket) {
+        delete_bucket = bucket;
+        bucket = bucket->next;
+        PyMem_Free(delete_bucket);
     }
 
     if (self->decref_factory) {
         Py_DECREF(self->factory);
     }
-    Py_DECREF(self->mapping);
 
     Py_TYPE(self)->tp_free((PyObject*)self);
 }
 
-PyObject* pysqlite_cache_get(pysqlite_Cache* self, PyObject* args)
+/* removes node from the list of nodes */
+static void pysqlite_cache_unlink(pysqlite_Cache* self, pysqlite_Node* node)
 {
-    PyObject* key = args;
-    pysqlite_Node* node;
-    pysqlite_Node* ptr;
-    PyObject* data;
+    if (node->prev) {
+        node->prev->next = node->next;
+    } else {
+        self->first = node->next;
+    }
+    if (node->next) {
+        node->next->prev = node->prev;
+    } else {
+        self->last = node->prev;
+    }
+    node->prev = NULL;
+    node->next = NULL;
+}
 
-    node = (pysqlite_Node*)PyDict_GetItem(self->mapping, key);
-    if (node) {
-        /* an entry for this key already exists in the cache */
+/* inserts node into the list of nodes after the node 'after', or at the front
+ * if 'after' is NULL */
+static void pysqlite_cache_link(pysqlite_Cache* self, pysqlite_Node* node, pysqlite_Node* after)
+{
+    node->prev = after;
+    if (after) {
+        node->next = after->next;
+        after->next = node;
+    } else {
+        node->next = self->first;
+        self->first = node;
+    }
+    if (node->next) {
+        node->next->prev = node;
+    } else {
+        self->last = node;
+    }
+}
+
+/* creates an empty bucket for count and inserts it before the bucket 'before',
+ * or at the end if 'before' is NULL */
+static pysqlite_Bucket* pysqlite_cache_new_bucket(pysqlite_Cache* self, long count, pysqlite_Bucket* before)
+{
+    pysqlite_Bucket* bucket;
 
-        /* increase usage counter of the node found */
-        if (node->count < LONG_MAX) {
+    bucket = PyMem_New(pysqlite_Bucket, 1);
+    if (!bucket) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    bucket->count = count;
+    bucket->head = NULL;
+    bucket->tail = NULL;
+    bucket->next = before;
+    bucket->prev = before ? before->prev : self->last_bucket;
+
+    if (bucket->prev) {
+        bucket->prev->next = bucket;
+    } else {
+        self->first_bucket = bucket;
+    }
+    if (before) {
+        before->prev = bucket;
+    } else {
+        self->last_bucket = bucket;
+    }
+
+    return bucket;
+}
+
+/* removes node from its bucket, and the bucket if it becomes empty. Must be
+ * called before the node is unlinked from the list of nodes. */
+static void pysqlite_cache_leave_bucket(pysqlite_Cache* self, pysqlite_Node* node)
+{
+    pysqlite_Bucket* bucket = node->bucket;
+
+    if (!bucket) {
+        return;
+    }
+    node->bucket = NULL;
+
+    if (bucket->head == node && bucket->tail == node) {
+        if (bucket->prev) {
+            bucket->prev->next = bucket->next;
+        } else {
+            self->first_bucket = bucket->next;
+        }
+        if (bucket->next) {
+            bucket->next->prev = bucket->prev;
+        } else {
+            self->last_bucket = bucket->prev;
+        }
+        PyMem_Free(bucket);
+    } else if (bucket->head == node) {
+        bucket->head = node->next;
+    } else if (bucket->tail == node) {
+        bucket->tail = node->prev;
+    }
+}
+
+/* appends node to the run of nodes in bucket. An empty bucket's run starts
+ * right after the run of the bucket before it. */
+static void pysqlite_cache_enter_bucket(pysqlite_Cache* self, pysqlite_Node* node, pysqlite_Bucket* bucket)
+{
+    pysqlite_cache_link(self, node, bucket->tail ? bucket->tail : (bucket->prev ? bucket->prev->tail : NULL));
+
+    if (!bucket->head) {
+        bucket->head = node;
+    }
+    bucket->tail = node;
+    node->bucket = bucket;
+}
+
+/* the node was used again, move it towards the front of the list */
+static int pysqlite_cache_promote(pysqlite_Cache* self, pysqlite_Node* node)
+{
+    pysqlite_Bucket* bucket;
+    pysqlite_Bucket* target;
+
+    if (node->pinned) {
+        /* keep counting, so that the node gets its place when unpinned */
+        if (self->policy == PYSQLITE_CACHE_LFU && node->count < LONG_MAX) {
             node->count++;
         }
+        return 0;
+    }
 
-        /* if necessary, reorder entries in the cache by swapping positions */
-        if (node->prev && node->count > node->prev->count) {
-            ptr = node->prev;
+    if (self->policy == PYSQLITE_CACHE_LRU) {
+        if (node != self->first) {
+            pysqlite_cache_unlink(self, node);
+            pysqlite_cache_link(self, node, NULL);
+        }
+        return 0;
+    }
 
-            while (ptr->prev && node->count > ptr->prev->count) {
-                ptr = ptr->prev;
-            }
+    /* LFU: move the node behind all nodes that have been used more often
+     * than it has been used now, and in front of all others */
+    if (node->count == LONG_MAX) {
+        return 0;
+    }
 
-            if (node->next) {
-                node->next->prev = node->prev;
-            } else {
-                self->last = node->prev;
-            }
-            if (node->prev) {
-                node->prev->next = node->next;
-            }
-            if (ptr->prev) {
-                ptr->prev->next = node;
-            } else {
-                self->first = node;
+    bucket = node->bucket;
+    if (bucket->prev && bucket->prev->count == node->count + 1) {
+        target = bucket->prev;
+    } else {
+        target = pysqlite_cache_new_bucket(self, node->count + 1, bucket);
+        if (!target) {
+            return -1;
+        }
+    }
+
+    pysqlite_cache_leave_bucket(self, node);
+    pysqlite_cache_unlink(self, node);
+    pysqlite_cache_enter_bucket(self, node, target);
+    node->count++;
+
+    return 0;
+}
+
+/* adds a new node to the list */
+static int pysqlite_cache_insert(pysqlite_Cache* self, pysqlite_Node* node)
+{
+    pysqlite_Bucket* target;
+
+    if (self->policy == PYSQLITE_CACHE_LRU) {
+        pysqlite_cache_link(self, node, NULL);
+        return 0;
+    }
+
+    /* LFU: unused nodes go to the end of the list */
+    if (self->last_bucket && self->last_bucket->count == node->count) {
+        target = self->last_bucket;
+    } else {
+        target = pysqlite_cache_new_bucket(self, node->count, NULL);
+        if (!target) {
+            return -1;
+        }
+    }
+
+    pysqlite_cache_enter_bucket(self, node, target);
+
+    return 0;
+}
+
+/* returns the node for key, or NULL if there is none or an error occurred */
+static pysqlite_Node* pysqlite_cache_lookup(pysqlite_Cache* self, PyObject* key, long hash)
+{
+    pysqlite_Node* node;
+    pysqlite_Node* slot;
+    int cmp;
+
+    slot = self->table[hash & self->mask];
+
+    /* the SQL is usually a constant, so try an identity match first */
+    for (node = slot; node; node = node->chain) {
+        if (node->key == key) {
+            return node;
+        }
+    }
+
+    for (node = slot; node; node = node->chain) {
+        if (node->hash == hash) {
+            cmp = PyObject_RichCompareBool(node->key, key, Py_EQ);
+            if (cmp < 0) {
+                return NULL;
+            } else if (cmp > 0) {
+                return node;
             }
+        }
+    }
 
-            node->next = ptr;
-            node->prev = ptr->prev;
-            if (!node->prev) {
-                self->first = node;
+    return NULL;
+}
+
+static void pysqlite_cache_table_remove(pysqlite_Cache* self, pysqlite_Node* node)
+{
+    pysqlite_Node** ptr;
+
+    for (ptr = &self->table[node->hash & self->mask]; *ptr; ptr = &(*ptr)->chain) {
+        if (*ptr == node) {
+            *ptr = node->chain;
+            break;
+        }
+    }
+    node->chain = NULL;
+    self->used--;
+}
+
+static int pysqlite_cache_table_insert(pysqlite_Cache* self, pysqlite_Node* node)
+{
+    pysqlite_Node** table;
+    pysqlite_Node* ptr;
+    Py_ssize_t slots;
+    Py_ssize_t i;
+
+    /* keep the table at most half full */
+    slots = self->mask + 1;
+    if ((Py_ssize_t)(self->used + 1) * 2 > slots) {
+        table = PyMem_New(pysqlite_Node*, slots * 2);
+        if (!table) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        memset(table, 0, slots * 2 * sizeof(pysqlite_Node*));
+
+        for (i = 0; i < slots; i++) {
+            while (self->table[i]) {
+                ptr = self->table[i];
+                self->table[i] = ptr->chain;
+                ptr->chain = table[ptr->hash & (slots * 2 - 1)];
+                table[ptr->hash & (slots * 2 - 1)] = ptr;
             }
-            ptr->prev = node;
         }
+
+        PyMem_Free(self->table);
+        self->table = table;
+        self->mask = slots * 2 - 1;
+    }
+
+    node->chain = self->table[node->hash & self->mask];
+    self->table[node->hash & self->mask] = node;
+    self->used++;
+
+    return 0;
+}
+
+/* produces the data for a key that is not in the cache yet */
+static PyObject* pysqlite_cache_create(pysqlite_Cache* self, PyObject* key)
+{
+    pysqlite_Connection* connection;
+
+    /* for the statement cache of a connection, create the statement directly
+     * instead of going through Connection.__call__ */
+    if ((PyString_Check(key) || PyUnicode_Check(key))
+            && PyObject_TypeCheck(self->factory, &pysqlite_ConnectionType)
+            && Py_TYPE(self->factory)->tp_call == (ternaryfunc)pysqlite_connection_call) {
+        connection = (pysqlite_Connection*)self->factory;
+        if (!pysqlite_check_thread(connection) || !pysqlite_check_connection(connection)) {
+            return NULL;
+        }
+        return pysqlite_connection_create_statement(connection, key);
+    }
+
+    return PyObject_CallFunction(self->factory, "O", key);
+}
+
+/* returns the node for key, creating it if necessary, or NULL on error */
+static pysqlite_Node* pysqlite_cache_get_node(pysqlite_Cache* self, PyObject* key)
+{
+    long hash;
+    pysqlite_Node* node;
+    PyObject* data;
+
+    hash = PyObject_Hash(key);
+    if (hash == -1) {
+        return NULL;
+    }
+
+    node = pysqlite_cache_lookup(self, key, hash);
+    if (node) {
+        /* an entry for this key already exists in the cache */
+        if (pysqlite_cache_promote(self, node) != 0) {
+            return NULL;
+        }
+    } else if (PyErr_Occurred()) {
+        return NULL;
     } else {
         /* There is no entry for this key in the cache, yet. We'll insert a new
          * entry in the cache, and make space if necessary by throwing the
-         * least used item out of the cache. */
+         * least valuable item out of the cache. */
 
-        if (PyDict_Size(self->mapping) == self->size) {
-            if (self->last) {
-                node = self->last;
+        if (self->used - self->npinned >= self->size && self->last) {
+            node = self->last;
 
-                if (PyDict_DelItem(self->mapping, self->last->key) != 0) {
-                    return NULL;
-                }
+            pysqlite_cache_leave_bucket(self, node);
+            pysqlite_cache_unlink(self, node);
+            pysqlite_cache_table_remove(self, node);
 
-                if (node->prev) {
-                    node->prev->next = NULL;
-                }
-                self->last = node->prev;
-                node->prev = NULL;
-
-                Py_DECREF(node);
-            }
+            pysqlite_free_node(node);
         }
 
-        data = PyObject_CallFunction(self->factory, "O", key);
-
+        data = pysqlite_cache_create(self, key);
         if (!data) {
             return NULL;
         }
 
-        node = pysqlite_new_node(key, data);
+        node = pysqlite_new_node(key, hash, data);
+        Py_DECREF(data);
         if (!node) {
             return NULL;
         }
-        node->prev = self->last;
-
-        Py_DECREF(data);
 
-        if (PyDict_SetItem(self->mapping, key, (PyObject*)node) != 0) {
-            Py_DECREF(node);
+        if (pysqlite_cache_table_insert(self, node) != 0) {
+            pysqlite_free_node(node);
             return NULL;
         }
 
-        if (self->last) {
-            self->last->next = node;
-        } else {
-            self->first = node;
+        if (pysqlite_cache_insert(self, node) != 0) {
+            pysqlite_cache_table_remove(self, node);
+            pysqlite_free_node(node);
+            return NULL;
         }
-        self->last = node;
+    }
+
+    return node;
+}
+
+PyObject* pysqlite_cache_get(pysqlite_Cache* self, PyObject* args)
+{
+    pysqlite_Node* node;
+
+    node = pysqlite_cache_get_node(self, args);
+    if (!node) {
+        return NULL;
     }
 
     Py_INCREF(node->data);
     return node->data;
 }
 
+PyObject* pysqlite_cache_get_statement(pysqlite_Cache* self, PyObject* sql)
+{
+    pysqlite_Node* node;
+    PyObject* statement;
+    long hash;
+    int i;
+
+    node = pysqlite_cache_get_node(self, sql);
+    if (!node) {
+        return NULL;
+    }
+
+    statement = node->data;
+    for (i = 0; ((pysqlite_Statement*)statement)->in_use; i++) {
+        if (i == PYSQLITE_CACHE_SPARES || !node->spares[i]) {
+            /* all statements for sql are in use, prepare another one */
+            hash = node->hash;
+            statement = pysqlite_cache_create(self, sql);
+            if (!statement) {
+                return NULL;
+            }
+
+            /* creating the statement can run Python code that uses the
+             * cache and evicts the node, so look it up again */
+            node = pysqlite_cache_lookup(self, sql, hash);
+            if (!node) {
+                if (PyErr_Occurred()) {
+                    Py_DECREF(statement);
+                    return NULL;
+                }
+                return statement;
+            }
+
+            for (i = 0; i < PYSQLITE_CACHE_SPARES; i++) {
+                if (!node->spares[i]) {
+                    Py_INCREF(statement);
+                    node->spares[i] = statement;
+                    break;
+                }
+            }
+            return statement;
+        }
+        statement = node->spares[i];
+    }
+
+    Py_INCREF(statement);
+    return statement;
+}
+
+int pysqlite_cache_pin(pysqlite_Cache* self, PyObject* key)
+{
+    pysqlite_Node* node;
+
+    node = pysqlite_cache_get_node(self, key);
+    if (!node) {
+        return -1;
+    }
+
+    if (!node->pinned) {
+        pysqlite_cache_leave_bucket(self, node);
+        pysqlite_cache_unlink(self, node);
+
+        node->prev = NULL;
+        node->next = self->pinned;
+        if (self->pinned) {
+            self->pinned->prev = node;
+        }
+        self->pinned = node;
+
+        node->pinned = 1;
+        self->npinned++;
+    }
+
+    return 0;
+}
+
+/* puts an unpinned node back into the list at the place its count earns it */
+static int pysqlite_cache_reinsert(pysqlite_Cache* self, pysqlite_Node* node)
+{
+    pysqlite_Bucket* bucket;
+
+    if (self->policy == PYSQLITE_CACHE_LRU) {
+        pysqlite_cache_link(self, node, NULL);
+        return 0;
+    }
+
+    bucket = self->first_bucket;
+    while (bucket && bucket->count > node->count) {
+        bucket = bucket->next;
+    }
+
+    if (!bucket || bucket->count != node->count) {
+        bucket = pysqlite_cache_new_bucket(self, node->count, bucket);
+        if (!bucket) {
+            return -1;
+        }
+    }
+
+    pysqlite_cache_enter_bucket(self, node, bucket);
+
+    return 0;
+}
+
+int pysqlite_cache_unpin(pysqlite_Cache* self, PyObject* key)
+{
+    long hash;
+    pysqlite_Node* node;
+
+    hash = PyObject_Hash(key);
+    if (hash == -1) {
+        return -1;
+    }
+
+    node = pysqlite_cache_lookup(self, key, hash);
+    if (!node) {
+        return PyErr_Occurred() ? -1 : 0;
+    }
+    if (!node->pinned) {
+        return 0;
+    }
+
+    if (node->prev) {
+        node->prev->next = node->next;
+    } else {
+        self->pinned = node->next;
+    }
+    if (node->next) {
+        node->next->prev = node->prev;
+    }
+    node->prev = NULL;
+    node->next = NULL;
+    node->pinned = 0;
+    self->npinned--;
+
+    if (pysqlite_cache_reinsert(self, node) != 0) {
+        pysqlite_cache_table_remove(self, node);
+        pysqlite_free_node(node);
+        return -1;
+    }
+
+    /* the entry counts against the size of the cache again */
+    while (self->used - self->npinned > self->size) {
+        node = self->last;
+
+        pysqlite_cache_leave_bucket(self, node);
+        pysqlite_cache_unlink(self, node);
+        pysqlite_cache_table_remove(self, node);
+
+        pysqlite_free_node(node);
+    }
+
+    return 0;
+}
+
+static PyObject* pysqlite_cache_pin_method(pysqlite_Cache* self, PyObject* key)
+{
+    if (pysqlite_cache_pin(self, key) != 0) {
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* pysqlite_cache_unpin_method(pysqlite_Cache* self, PyObject* key)
+{
+    if (pysqlite_cache_unpin(self, key) != 0) {
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
 PyObject* pysqlite_cache_display(pysqlite_Cache* self, PyObject* args)
 {
     pysqlite_Node* ptr;
@@ -268,53 +750,15 @@ PyObject* pysqlite_cache_display(pysqlite_Cache* self, PyObject* args)
 static PyMethodDef cache_methods[] = {
     {"get", (PyCFunction)pysqlite_cache_get, METH_O,
         PyDoc_STR("Gets an entry from the cache or calls the factory function to produce one.")},
+    {"pin", (PyCFunction)pysqlite_cache_pin_method, METH_O,
+        PyDoc_STR("Gets an entry like get(), and exempts it from eviction.")},
+    {"unpin", (PyCFunction)pysqlite_cache_unpin_method, METH_O,
+        PyDoc_STR("Makes a pinned entry evictable again.")},
     {"display", (PyCFunction)pysqlite_cache_display, METH_NOARGS,
         PyDoc_STR("For debugging only.")},
     {NULL, NULL}
 };
 
-PyTypeObject pysqlite_NodeType = {
-        PyVarObject_HEAD_INIT(NULL, 0)
-        MODULE_NAME "Node",                             /* tp_name */
-        sizeof(pysqlite_Node),                          /* tp_basicsize */
-        0,                                              /* tp_itemsize */
-        (destructor)pysqlite_node_dealloc,              /* tp_dealloc */
-        0,                                              /* tp_print */
-        0,                                              /* tp_getattr */
-        0,                                              /* tp_setattr */
-        0,                                              /* tp_compare */
-        0,                                              /* tp_repr */
-        0,                                              /* tp_as_number */
-        0,                                              /* tp_as_sequence */
-        0,                                              /* tp_as_mapping */
-        0,                                              /* tp_hash */
-        0,                                              /* tp_call */
-        0,                                              /* tp_str */
-        0,                                              /* tp_getattro */
-        0,                                              /* tp_setattro */
-        0,                                              /* tp_as_buffer */
-        Py_TPFLAGS_DEFAULT|Py_TPFLAGS_BASETYPE,         /* tp_flags */
-        0,                                              /* tp_doc */
-        0,                                              /* tp_traverse */
-        0,                                              /* tp_clear */
-        0,                                              /* tp_richcompare */
-        0,                                              /* tp_weaklistoffset */
-        0,                                              /* tp_iter */
-        0,                                              /* tp_iternext */
-        0,                                              /* tp_methods */
-        0,                                              /* tp_members */
-        0,                                              /* tp_getset */
-        0,                                              /* tp_base */
-        0,                                              /* tp_dict */
-        0,                                              /* tp_descr_get */
-        0,                                              /* tp_descr_set */
-        0,                                              /* tp_dictoffset */
-        (initproc)0,                                    /* tp_init */
-        0,                                              /* tp_alloc */
-        0,                                              /* tp_new */
-        0                                               /* tp_free */
-};
-
 PyTypeObject pysqlite_CacheType = {
         PyVarObject_HEAD_INIT(NULL, 0)
         MODULE_NAME ".Cache",                           /* tp_name */
@@ -361,14 +805,8 @@ extern int pysqlite_cache_setup_types(void)
 {
     int rc;
 
-    pysqlite_NodeType.tp_new = PyType_GenericNew;
     pysqlite_CacheType.tp_new = PyType_GenericNew;
 
-    rc = PyType_Ready(&pysqlite_NodeType);
-    if (rc < 0) {
-        return rc;
-    }
-
     rc = PyType_Ready(&pysqlite_CacheType);
     return rc;
 }
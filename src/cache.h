@@ -25,27 +25,76 @@
 #define PYSQLITE_CACHE_H
 #include "Python.h"
 
-/* The LRU cache is implemented as a combination of a doubly-linked with a
- * dictionary. The list items are of type 'Node' and the dictionary has the
- * nodes as values. */
+/* The cache is implemented as a combination of a doubly-linked list with a
+ * hash table. The list and the hash chains are made of 'Node' entries, which
+ * are plain C structs. The least valuable entry is always at the end of the
+ * list, so all operations are O(1).
+ *
+ * With the LRU policy, entries are moved to the front of the list when they
+ * are used. With the LFU policy, the list is sorted by usage count, and the
+ * nodes with the same count are grouped in a Bucket, so that a node can be
+ * moved past all nodes with its old count in one step.
+ *
+ * Pinned entries are not part of that list, and they don't count against the
+ * size of the cache. */
+
+#define PYSQLITE_CACHE_LFU 0
+#define PYSQLITE_CACHE_LRU 1
+
+/* the number of additional statements kept per SQL string, for cursors that
+ * execute it while the cached statement is in use */
+#define PYSQLITE_CACHE_SPARES 4
+
+struct _pysqlite_Bucket;
 
 typedef struct _pysqlite_Node
 {
-    PyObject_HEAD
     PyObject* key;
+    long hash;
     PyObject* data;
     long count;
+
+    /* more statements for the same SQL, see pysqlite_cache_get_statement() */
+    PyObject* spares[PYSQLITE_CACHE_SPARES];
     struct _pysqlite_Node* prev;
     struct _pysqlite_Node* next;
+
+    /* pinned nodes are never evicted. They are kept in a list of their own,
+     * outside of the list sorted by value. */
+    int pinned;
+
+    /* the next node in the same hash table slot */
+    struct _pysqlite_Node* chain;
+
+    /* the bucket of nodes with the same count, LFU policy only */
+    struct _pysqlite_Bucket* bucket;
 } pysqlite_Node;
 
+/* a run of nodes with the same count, sorted by descending count like the
+ * nodes themselves */
+typedef struct _pysqlite_Bucket
+{
+    long count;
+    pysqlite_Node* head;
+    pysqlite_Node* tail;
+    struct _pysqlite_Bucket* prev;
+    struct _pysqlite_Bucket* next;
+} pysqlite_Bucket;
+
 typedef struct
 {
     PyObject_HEAD
     int size;
 
-    /* a dictionary mapping keys to Node entries */
-    PyObject* mapping;
+    /* PYSQLITE_CACHE_LFU or PYSQLITE_CACHE_LRU */
+    int policy;
+
+    /* hash table of the nodes, its size is mask + 1, a power of two */
+    pysqlite_Node** table;
+    Py_ssize_t mask;
+
+    /* the number of nodes */
+    int used;
 
     /* the factory callable */
     PyObject* factory;
@@ -53,21 +102,38 @@ typedef struct
     pysqlite_Node* first;
     pysqlite_Node* last;
 
+    pysqlite_Bucket* first_bucket;
+    pysqlite_Bucket* last_bucket;
+
+    /* the pinned nodes, and how many there are */
+    pysqlite_Node* pinned;
+    int npinned;
+
     /* if set, decrement the factory function when the Cache is deallocated.
      * this is almost always desirable, but not in the pysqlite context */
     int decref_factory;
 } pysqlite_Cache;
 
-extern PyTypeObject pysqlite_NodeType;
 extern PyTypeObject pysqlite_CacheType;
 
-int pysqlite_node_init(pysqlite_Node* self, PyObject* args, PyObject* kwargs);
-void pysqlite_node_dealloc(pysqlite_Node* self);
-
 int pysqlite_cache_init(pysqlite_Cache* self, PyObject* args, PyObject* kwargs);
 void pysqlite_cache_dealloc(pysqlite_Cache* self);
 PyObject* pysqlite_cache_get(pysqlite_Cache* self, PyObject* args);
 
+/* gets the entry for key like pysqlite_cache_get(), and exempts it from
+ * eviction. 0 => ok; -1 => error */
+int pysqlite_cache_pin(pysqlite_Cache* self, PyObject* key);
+
+/* makes a pinned entry evictable again, nothing happens if there is no pinned
+ * entry for key. 0 => ok; -1 => error */
+int pysqlite_cache_unpin(pysqlite_Cache* self, PyObject* key);
+
+/* for the statement cache of a connection: returns a statement for sql that
+ * is not in use. If the cached statement is, one of the node's spare
+ * statements is returned, or a new one that is kept as a spare if there is
+ * room. */
+PyObject* pysqlite_cache_get_statement(pysqlite_Cache* self, PyObject* sql);
+
 int pysqlite_cache_setup_types(void);
 
 #endif
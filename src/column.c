@@ -0,0 +1,506 @@
+/* column.c - the column type
+ *
+ * Copyright (C) 2016 Gerhard Hring <gh@ghaering.de>
+ *
+ * This file is part of pysqlite.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "column.h"
+#include "module.h"
+#include "util.h"
+
+static pysqlite_Column* _pysqlite_column_alloc(PyObject* name, int coltype, char format, Py_ssize_t itemsize)
+{
+    pysqlite_Column* self;
+
+    self = PyObject_New(pysqlite_Column, &pysqlite_ColumnType);
+    if (!self) {
+        return NULL;
+    }
+
+    if (!name) {
+        name = Py_None;
+    }
+    Py_INCREF(name);
+    self->name = name;
+
+    self->coltype = coltype;
+    self->rows = 0;
+    self->data = NULL;
+    self->nbytes = 0;
+    self->allocated = 0;
+    self->offsets = NULL;
+    self->nulls = NULL;
+
+    self->format[0] = format;
+    self->format[1] = 0;
+    self->itemsize = itemsize;
+    self->shape[0] = 0;
+    self->strides[0] = itemsize;
+
+    return self;
+}
+
+pysqlite_Column* pysqlite_column_new(PyObject* name)
+{
+    pysqlite_Column* self;
+
+    self = _pysqlite_column_alloc(name, SQLITE_NULL, 'B', 1);
+    if (!self) {
+        return NULL;
+    }
+
+    /* both are allocated here, because the values are appended without the
+     * GIL; offsets is dropped in pysqlite_column_finish() if the column turns
+     * out not to be TEXT or BLOB */
+    self->nulls = _pysqlite_column_alloc(NULL, SQLITE_INTEGER, 'B', 1);
+    self->offsets = _pysqlite_column_alloc(NULL, SQLITE_INTEGER, 'q', 8);
+    if (!self->nulls || !self->offsets) {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+static void pysqlite_column_dealloc(pysqlite_Column* self)
+{
+    free(self->data);
+    Py_XDECREF(self->name);
+    Py_XDECREF(self->offsets);
+    Py_XDECREF(self->nulls);
+
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+/* makes room for nbytes more bytes in the value buffer; -1 if out of memory */
+static int _pysqlite_column_reserve(pysqlite_Column* self, Py_ssize_t nbytes)
+{
+    Py_ssize_t new_allocated;
+    char* new_data;
+
+    if (self->nbytes + nbytes <= self->allocated) {
+        return 0;
+    }
+
+    new_allocated = self->allocated ? self->allocated : 256;
+    while (new_allocated < self->nbytes + nbytes) {
+        if (new_allocated > PY_SSIZE_T_MAX / 2) {
+            return -1;
+        }
+        new_allocated *= 2;
+    }
+
+    new_data = realloc(self->data, new_allocated);
+    if (!new_data) {
+        return -1;
+    }
+
+    self->data = new_data;
+    self->allocated = new_allocated;
+    return 0;
+}
+
+static int _pysqlite_column_append_bytes(pysqlite_Column* self, const void* value, Py_ssize_t nbytes)
+{
+    if (_pysqlite_column_reserve(self, nbytes) != 0) {
+        return -1;
+    }
+
+    if (nbytes > 0) {
+        if (value) {
+            memcpy(self->data + self->nbytes, value, nbytes);
+        } else {
+            memset(self->data + self->nbytes, 0, nbytes);
+        }
+    }
+    self->nbytes += nbytes;
+
+    return 0;
+}
+
+/* Called when the first non-NULL value is seen. The rows seen so far are all
+ * NULL and get zero values/empty strings. */
+static int _pysqlite_column_set_type(pysqlite_Column* self, int coltype)
+{
+    Py_ssize_t i;
+    sqlite_int64 offset = 0;
+
+    self->coltype = coltype;
+
+    if (coltype == SQLITE_INTEGER || coltype == SQLITE_FLOAT) {
+        self->format[0] = (coltype == SQLITE_INTEGER) ? 'q' : 'd';
+        self->itemsize = 8;
+        return _pysqlite_column_append_bytes(self, NULL, self->rows * 8);
+    }
+
+    /* TEXT or BLOB */
+    for (i = 0; i <= self->rows; i++) {
+        if (_pysqlite_column_append_bytes(self->offsets, &offset, sizeof(offset)) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* An INTEGER column that encounters a FLOAT value becomes a FLOAT column */
+static void _pysqlite_column_promote_to_float(pysqlite_Column* self)
+{
+    Py_ssize_t i;
+    sqlite_int64* intvals = (sqlite_int64*)self->data;
+    double* dblvals = (double*)self->data;
+
+    for (i = 0; i < self->rows; i++) {
+        dblvals[i] = (double)intvals[i];
+    }
+
+    self->coltype = SQLITE_FLOAT;
+    self->format[0] = 'd';
+}
+
+int pysqlite_column_append(pysqlite_Column* self, sqlite3_stmt* statement, int i)
+{
+    int coltype;
+    char isnull;
+    sqlite_int64 intval;
+    double dblval;
+    const void* value;
+    Py_ssize_t nbytes;
+    sqlite_int64 offset;
+
+    coltype = sqlite3_column_type(statement, i);
+    isnull = (coltype == SQLITE_NULL);
+
+    if (self->coltype == SQLITE_NULL && !isnull) {
+        /* the first non-NULL value determines the type of the column */
+        if (_pysqlite_column_set_type(self, coltype) != 0) {
+            return -1;
+        }
+    }
+
+    if ((self->coltype == SQLITE_INTEGER || self->coltype == SQLITE_FLOAT)
+            && (coltype == SQLITE_TEXT || coltype == SQLITE_BLOB)) {
+        /* converting it would silently turn it into a number */
+        return -2;
+    }
+
+    if (_pysqlite_column_append_bytes(self->nulls, &isnull, 1) != 0) {
+        return -1;
+    }
+
+    switch (self->coltype) {
+        case SQLITE_NULL:
+            break;
+        case SQLITE_INTEGER:
+            if (coltype == SQLITE_FLOAT) {
+                _pysqlite_column_promote_to_float(self);
+                dblval = sqlite3_column_double(statement, i);
+                if (_pysqlite_column_append_bytes(self, &dblval, sizeof(dblval)) != 0) {
+                    return -1;
+                }
+            } else {
+                intval = isnull ? 0 : sqlite3_column_int64(statement, i);
+                if (_pysqlite_column_append_bytes(self, &intval, sizeof(intval)) != 0) {
+                    return -1;
+                }
+            }
+            break;
+        case SQLITE_FLOAT:
+            dblval = isnull ? 0.0 : sqlite3_column_double(statement, i);
+            if (_pysqlite_column_append_bytes(self, &dblval, sizeof(dblval)) != 0) {
+                return -1;
+            }
+            break;
+        default:
+            /* TEXT or BLOB */
+            if (isnull) {
+                value = NULL;
+                nbytes = 0;
+            } else {
+                if (self->coltype == SQLITE_TEXT) {
+                    value = sqlite3_column_text(statement, i);
+                } else {
+                    value = sqlite3_column_blob(statement, i);
+                }
+                nbytes = sqlite3_column_bytes(statement, i);
+            }
+            if (_pysqlite_column_append_bytes(self, value, nbytes) != 0) {
+                return -1;
+            }
+            offset = self->nbytes;
+            if (_pysqlite_column_append_bytes(self->offsets, &offset, sizeof(offset)) != 0) {
+                return -1;
+            }
+    }
+
+    self->rows++;
+
+    return 0;
+}
+
+static void _pysqlite_column_finish_array(pysqlite_Column* self)
+{
+    if (self) {
+        self->shape[0] = self->nbytes / self->itemsize;
+        self->strides[0] = self->itemsize;
+        self->rows = self->shape[0];
+    }
+}
+
+void pysqlite_column_finish(pysqlite_Column* self)
+{
+    if (self->coltype != SQLITE_TEXT && self->coltype != SQLITE_BLOB) {
+        Py_CLEAR(self->offsets);
+    }
+
+    _pysqlite_column_finish_array(self->offsets);
+    _pysqlite_column_finish_array(self->nulls);
+
+    self->shape[0] = self->nbytes / self->itemsize;
+    self->strides[0] = self->itemsize;
+}
+
+static Py_ssize_t pysqlite_column_length(pysqlite_Column* self)
+{
+    return self->rows;
+}
+
+static PyObject* pysqlite_column_item(pysqlite_Column* self, Py_ssize_t i)
+{
+    sqlite_int64 start, end;
+    PyObject* buffer;
+    void* raw_buffer;
+    Py_ssize_t nbytes;
+
+    if (i < 0 || i >= self->rows) {
+        PyErr_SetString(PyExc_IndexError, "column index out of range");
+        return NULL;
+    }
+
+    if (self->nulls && self->nulls->data[i]) {
+        Py_INCREF(Py_None);
+        return Py_None;
+    }
+
+    switch (self->coltype) {
+        case SQLITE_INTEGER:
+            if (self->itemsize == 1) {
+                return PyInt_FromLong(((unsigned char*)self->data)[i]);
+            }
+            return _pysqlite_long_from_int64(((sqlite_int64*)self->data)[i]);
+        case SQLITE_FLOAT:
+            return PyFloat_FromDouble(((double*)self->data)[i]);
+        case SQLITE_TEXT:
+        case SQLITE_BLOB:
+            start = ((sqlite_int64*)self->offsets->data)[i];
+            end = ((sqlite_int64*)self->offsets->data)[i + 1];
+            if (self->coltype == SQLITE_TEXT) {
+                return PyUnicode_DecodeUTF8(self->data + start, (Py_ssize_t)(end - start), NULL);
+            }
+            nbytes = (Py_ssize_t)(end - start);
+            buffer = PyBuffer_New(nbytes);
+            if (!buffer) {
+                return NULL;
+            }
+            if (PyObject_AsWriteBuffer(buffer, &raw_buffer, &nbytes)) {
+                Py_DECREF(buffer);
+                return NULL;
+            }
+            memcpy(raw_buffer, self->data + start, nbytes);
+            return buffer;
+        default:
+            Py_INCREF(Py_None);
+            return Py_None;
+    }
+}
+
+static PyObject* pysqlite_column_tolist(pysqlite_Column* self, PyObject* args)
+{
+    PyObject* list;
+    PyObject* item;
+    Py_ssize_t i;
+
+    list = PyList_New(self->rows);
+    if (!list) {
+        return NULL;
+    }
+
+    for (i = 0; i < self->rows; i++) {
+        item = pysqlite_column_item(self, i);
+        if (!item) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+
+    return list;
+}
+
+static PyObject* pysqlite_column_get_offsets(pysqlite_Column* self, void* unused)
+{
+    PyObject* offsets = self->offsets ? (PyObject*)self->offsets : Py_None;
+
+    Py_INCREF(offsets);
+    return offsets;
+}
+
+static PyObject* pysqlite_column_get_nulls(pysqlite_Column* self, void* unused)
+{
+    PyObject* nulls = self->nulls ? (PyObject*)self->nulls : Py_None;
+
+    Py_INCREF(nulls);
+    return nulls;
+}
+
+static PyObject* pysqlite_column_get_format(pysqlite_Column* self, void* unused)
+{
+    return PyString_FromString(self->format);
+}
+
+/* old-style buffer interface */
+
+static Py_ssize_t pysqlite_column_getreadbuf(pysqlite_Column* self, Py_ssize_t segment, void** ptrptr)
+{
+    if (segment != 0) {
+        PyErr_SetString(PyExc_SystemError, "accessing non-existent column segment");
+        return -1;
+    }
+
+    *ptrptr = self->data ? self->data : "";
+    return self->nbytes;
+}
+
+static Py_ssize_t pysqlite_column_getsegcount(pysqlite_Column* self, Py_ssize_t* lenp)
+{
+    if (lenp) {
+        *lenp = self->nbytes;
+    }
+
+    return 1;
+}
+
+/* new-style buffer interface */
+
+static int pysqlite_column_getbuffer(pysqlite_Column* self, Py_buffer* view, int flags)
+{
+    if (PyBuffer_FillInfo(view, (PyObject*)self, self->data ? self->data : "", self->nbytes, 1, flags) != 0) {
+        return -1;
+    }
+
+    view->itemsize = self->itemsize;
+    if ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) {
+        view->format = self->format;
+    }
+    if ((flags & PyBUF_ND) == PyBUF_ND) {
+        view->shape = self->shape;
+    }
+    if ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) {
+        view->strides = self->strides;
+    }
+
+    return 0;
+}
+
+static PyBufferProcs pysqlite_column_as_buffer = {
+    (readbufferproc)pysqlite_column_getreadbuf,     /* bf_getreadbuffer */
+    0,                                              /* bf_getwritebuffer */
+    (segcountproc)pysqlite_column_getsegcount,      /* bf_getsegcount */
+    (charbufferproc)pysqlite_column_getreadbuf,     /* bf_getcharbuffer */
+    (getbufferproc)pysqlite_column_getbuffer,       /* bf_getbuffer */
+    0,                                              /* bf_releasebuffer */
+};
+
+static PySequenceMethods pysqlite_column_as_sequence = {
+   /* sq_length */         (lenfunc)pysqlite_column_length,
+   /* sq_concat */         0,
+   /* sq_repeat */         0,
+   /* sq_item */           (ssizeargfunc)pysqlite_column_item,
+};
+
+static PyMethodDef pysqlite_column_methods[] = {
+    {"tolist", (PyCFunction)pysqlite_column_tolist, METH_NOARGS,
+        PyDoc_STR("Returns the values of the column as a list.")},
+    {NULL, NULL}
+};
+
+static struct PyMemberDef pysqlite_column_members[] =
+{
+    {"name", T_OBJECT, offsetof(pysqlite_Column, name), RO},
+    {"type", T_INT, offsetof(pysqlite_Column, coltype), RO},
+    {NULL}
+};
+
+static PyGetSetDef pysqlite_column_getset[] = {
+    {"offsets", (getter)pysqlite_column_get_offsets, (setter)0},
+    {"nulls", (getter)pysqlite_column_get_nulls, (setter)0},
+    {"format", (getter)pysqlite_column_get_format, (setter)0},
+    {NULL}
+};
+
+static char column_doc[] =
+PyDoc_STR("The values of one result column in a typed buffer.");
+
+PyTypeObject pysqlite_ColumnType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        MODULE_NAME ".Column",                          /* tp_name */
+        sizeof(pysqlite_Column),                        /* tp_basicsize */
+        0,                                              /* tp_itemsize */
+        (destructor)pysqlite_column_dealloc,            /* tp_dealloc */
+        0,                                              /* tp_print */
+        0,                                              /* tp_getattr */
+        0,                                              /* tp_setattr */
+        0,                                              /* tp_compare */
+        0,                                              /* tp_repr */
+        0,                                              /* tp_as_number */
+        &pysqlite_column_as_sequence,                   /* tp_as_sequence */
+        0,                                              /* tp_as_mapping */
+        0,                                              /* tp_hash */
+        0,                                              /* tp_call */
+        0,                                              /* tp_str */
+        0,                                              /* tp_getattro */
+        0,                                              /* tp_setattro */
+        &pysqlite_column_as_buffer,                     /* tp_as_buffer */
+        Py_TPFLAGS_DEFAULT|Py_TPFLAGS_HAVE_NEWBUFFER,   /* tp_flags */
+        column_doc,                                     /* tp_doc */
+        0,                                              /* tp_traverse */
+        0,                                              /* tp_clear */
+        0,                                              /* tp_richcompare */
+        0,                                              /* tp_weaklistoffset */
+        0,                                              /* tp_iter */
+        0,                                              /* tp_iternext */
+        pysqlite_column_methods,                        /* tp_methods */
+        pysqlite_column_members,                        /* tp_members */
+        pysqlite_column_getset,                         /* tp_getset */
+        0,                                              /* tp_base */
+        0,                                              /* tp_dict */
+        0,                                              /* tp_descr_get */
+        0,                                              /* tp_descr_set */
+        0,                                              /* tp_dictoffset */
+        (initproc)0,                                    /* tp_init */
+        0,                                              /* tp_alloc */
+        0,                                              /* tp_new */
+        0                                               /* tp_free */
+};
+
+extern int pysqlite_column_setup_types(void)
+{
+    return PyType_Ready(&pysqlite_ColumnType);
+}
@@ -0,0 +1,89 @@
+/* column.h - definitions for the column type
+ *
+ * Copyright (C) 2016 Gerhard Hring <gh@ghaering.de>
+ *
+ * This file is part of pysqlite.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PYSQLITE_COLUMN_H
+#define PYSQLITE_COLUMN_H
+#include "Python.h"
+#include "structmember.h"
+
+#include "sqlite3.h"
+
+/* A Column holds the values of one result column in a contiguous, typed
+ * buffer, which is exported via the buffer protocol:
+ *
+ * - INTEGER columns: one int64 per row (format 'q')
+ * - FLOAT columns:   one double per row (format 'd')
+ * - TEXT/BLOB:       the concatenated bytes of all values (format 'B'); the
+ *                    value of row i is data[offsets[i]:offsets[i+1]]
+ *
+ * The buffers are allocated with malloc(), so that they can be filled while
+ * the GIL is released. */
+
+typedef struct _pysqlite_Column
+{
+    PyObject_HEAD
+
+    /* the column name, as in cursor.description */
+    PyObject* name;
+
+    /* SQLITE_INTEGER, SQLITE_FLOAT, SQLITE_TEXT, SQLITE_BLOB or SQLITE_NULL if
+     * only NULL values were seen so far */
+    int coltype;
+
+    /* number of rows */
+    Py_ssize_t rows;
+
+    /* the value buffer */
+    char* data;
+    Py_ssize_t nbytes;
+    Py_ssize_t allocated;
+
+    /* for TEXT and BLOB columns, a Column with rows + 1 int64 offsets into data */
+    struct _pysqlite_Column* offsets;
+
+    /* a Column with one byte per row, 1 if the value is NULL */
+    struct _pysqlite_Column* nulls;
+
+    /* buffer description handed out to consumers */
+    char format[2];
+    Py_ssize_t itemsize;
+    Py_ssize_t shape[1];
+    Py_ssize_t strides[1];
+} pysqlite_Column;
+
+extern PyTypeObject pysqlite_ColumnType;
+
+pysqlite_Column* pysqlite_column_new(PyObject* name);
+
+/* Appends the value of column i of the current row of the statement. May be
+ * called without holding the GIL. Returns 0 on success, -1 if out of memory,
+ * and -2 if a TEXT or BLOB value is found in an INTEGER or FLOAT column. */
+int pysqlite_column_append(pysqlite_Column* self, sqlite3_stmt* statement, int i);
+
+/* Prepares the column for export, must be called with the GIL held after the
+ * last append. */
+void pysqlite_column_finish(pysqlite_Column* self);
+
+int pysqlite_column_setup_types(void);
+
+#endif
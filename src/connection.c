@@ -28,6 +28,7 @@
 #include "cursor.h"
 #include "prepare_protocol.h"
 #include "util.h"
+#include "blob.h"
 
 #ifdef PYSQLITE_EXPERIMENTAL
 #include "backup.h"
@@ -45,12 +46,13 @@
 #endif
 
 static int pysqlite_connection_set_isolation_level(pysqlite_Connection* self, PyObject* isolation_level);
+static void _pysqlite_connection_finalize_control(pysqlite_Connection* self);
 static void _pysqlite_drop_unused_cursor_references(pysqlite_Connection* self);
 
 
 int pysqlite_connection_init(pysqlite_Connection* self, PyObject* args, PyObject* kwargs)
 {
-    static char *kwlist[] = {"database", "timeout", "detect_types", "isolation_level", "check_same_thread", "factory", "cached_statements", "flags", NULL, NULL};
+    static char *kwlist[] = {"database", "timeout", "detect_types", "isolation_level", "check_same_thread", "factory", "cached_statements", "flags", "cache_policy", "prepare", NULL, NULL};
 
     PyObject* database;
     int detect_types = 0;
@@ -60,11 +62,15 @@ int pysqlite_connection_init(pysqlite_Connection* self, PyObject* args, PyObject
     int cached_statements = 100;
     double timeout = 5.0;
     int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+    const char* cache_policy = "lfu";
+    PyObject* prepare = NULL;
+    PyObject* prepare_iter;
+    PyObject* sql;
     int rc;
     PyObject* database_utf8;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|diOiOii", kwlist,
-                                     &database, &timeout, &detect_types, &isolation_level, &check_same_thread, &factory, &cached_statements, &flags))
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|diOiOiisO", kwlist,
+                                     &database, &timeout, &detect_types, &isolation_level, &check_same_thread, &factory, &cached_statements, &flags, &cache_policy, &prepare))
     {
         return -1;
     }
@@ -72,10 +78,14 @@ int pysqlite_connection_init(pysqlite_Connection* self, PyObject* args, PyObject
     self->initialized = 1;
 
     self->begin_statement = NULL;
+    self->begin_st = NULL;
+    self->commit_st = NULL;
+    self->rollback_st = NULL;
 
     self->statement_cache = NULL;
     self->statements = NULL;
     self->cursors = NULL;
+    self->blobs = NULL;
 
     Py_INCREF(Py_None);
     self->row_factory = Py_None;
@@ -124,7 +134,7 @@ int pysqlite_connection_init(pysqlite_Connection* self, PyObject* args, PyObject
     }
     Py_DECREF(isolation_level);
 
-    self->statement_cache = (pysqlite_Cache*)PyObject_CallFunction((PyObject*)&pysqlite_CacheType, "Oi", self, cached_statements);
+    self->statement_cache = (pysqlite_Cache*)PyObject_CallFunction((PyObject*)&pysqlite_CacheType, "Ois", self, cached_statements, cache_policy);
     if (PyErr_Occurred()) {
         return -1;
     }
@@ -132,10 +142,11 @@ int pysqlite_connection_init(pysqlite_Connection* self, PyObject* args, PyObject
     self->created_statements = 0;
     self->created_cursors = 0;
 
-    /* Create lists of weak references to statements/cursors */
+    /* Create lists of weak references to statements/cursors/blobs */
     self->statements = PyList_New(0);
     self->cursors = PyList_New(0);
-    if (!self->statements || !self->cursors) {
+    self->blobs = PyList_New(0);
+    if (!self->statements || !self->cursors || !self->blobs) {
         return -1;
     }
 
@@ -176,6 +187,28 @@ int pysqlite_connection_init(pysqlite_Connection* self, PyObject* args, PyObject
     self->ProgrammingError      = pysqlite_ProgrammingError;
     self->NotSupportedError     = pysqlite_NotSupportedError;
 
+    /* prepare the statements the application will need anyway, and keep them
+     * cached for the lifetime of the connection */
+    if (prepare && prepare != Py_None) {
+        prepare_iter = PyObject_GetIter(prepare);
+        if (!prepare_iter) {
+            return -1;
+        }
+
+        while ((sql = PyIter_Next(prepare_iter))) {
+            rc = pysqlite_cache_pin(self->statement_cache, sql);
+            Py_DECREF(sql);
+            if (rc != 0) {
+                break;
+            }
+        }
+        Py_DECREF(prepare_iter);
+
+        if (PyErr_Occurred()) {
+            return -1;
+        }
+    }
+
     return 0;
 }
 
@@ -204,6 +237,7 @@ void pysqlite_do_all_statements(pysqlite_Connection* self, int action)
         cursor = (pysqlite_Cursor*)PyWeakref_GetObject(weakref);
         if ((PyObject*)cursor != Py_None) {
             cursor->reset = 1;
+            cursor->moves++;
         }
     }
 }
@@ -214,6 +248,8 @@ void pysqlite_connection_dealloc(pysqlite_Connection* self)
 
     /* Clean up if user has not called .close() explicitly. */
     if (self->db) {
+        _pysqlite_connection_finalize_control(self);
+
         Py_BEGIN_ALLOW_THREADS
         sqlite3_close(self->db);
         Py_END_ALLOW_THREADS
@@ -229,6 +265,7 @@ void pysqlite_connection_dealloc(pysqlite_Connection* self)
     Py_XDECREF(self->collations);
     Py_XDECREF(self->statements);
     Py_XDECREF(self->cursors);
+    Py_XDECREF(self->blobs);
 
     self->ob_type->tp_free((PyObject*)self);
 }
@@ -285,6 +322,87 @@ PyObject* pysqlite_connection_cursor(pysqlite_Connection* self, PyObject* args,
     return cursor;
 }
 
+PyObject* pysqlite_connection_blobopen(pysqlite_Connection* self, PyObject* args, PyObject* kwargs)
+{
+    static char *kwlist[] = {"table", "column", "rowid", "readonly", "dbname", NULL};
+    char* table;
+    char* column;
+    sqlite_int64 rowid;
+    PyObject* readonly = Py_True;
+    char* dbname = "main";
+    sqlite3_blob* handle;
+    pysqlite_Blob* blob;
+    PyObject* weakref;
+    PyObject* new_list;
+    int flags;
+    int rc;
+    int i;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "ssL|Os", kwlist,
+                                     &table, &column, &rowid, &readonly, &dbname)) {
+        return NULL;
+    }
+
+    if (!pysqlite_check_thread(self) || !pysqlite_check_connection(self)) {
+        return NULL;
+    }
+
+    flags = PyObject_Not(readonly);
+    if (flags < 0) {
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    rc = sqlite3_blob_open(self->db, dbname, table, column, rowid, flags, &handle);
+    Py_END_ALLOW_THREADS
+
+    if (rc != SQLITE_OK) {
+        _pysqlite_seterror(self->db, NULL);
+        return NULL;
+    }
+
+    blob = PyObject_New(pysqlite_Blob, &pysqlite_BlobType);
+    if (!blob) {
+        Py_BEGIN_ALLOW_THREADS
+        sqlite3_blob_close(handle);
+        Py_END_ALLOW_THREADS
+        return NULL;
+    }
+
+    Py_INCREF(self);
+    blob->connection = self;
+    blob->blob = handle;
+    blob->offset = 0;
+    blob->in_weakreflist = NULL;
+
+    /* remember the blob so that close() can close it; forget the dead ones */
+    new_list = PyList_New(0);
+    if (!new_list) {
+        Py_DECREF(blob);
+        return NULL;
+    }
+    for (i = 0; i < PyList_GET_SIZE(self->blobs); i++) {
+        weakref = PyList_GET_ITEM(self->blobs, i);
+        if (PyWeakref_GetObject(weakref) != Py_None && PyList_Append(new_list, weakref) != 0) {
+            Py_DECREF(new_list);
+            Py_DECREF(blob);
+            return NULL;
+        }
+    }
+    Py_DECREF(self->blobs);
+    self->blobs = new_list;
+
+    weakref = PyWeakref_NewRef((PyObject*)blob, NULL);
+    if (!weakref || PyList_Append(self->blobs, weakref) != 0) {
+        Py_XDECREF(weakref);
+        Py_DECREF(blob);
+        return NULL;
+    }
+    Py_DECREF(weakref);
+
+    return (PyObject*)blob;
+}
+
 #ifdef PYSQLITE_EXPERIMENTAL
 PyObject* pysqlite_connection_backup(pysqlite_Connection* self, PyObject* args, PyObject* kwargs)
 {
@@ -322,13 +440,24 @@ PyObject* pysqlite_connection_backup(pysqlite_Connection* self, PyObject* args,
 
 PyObject* pysqlite_connection_close(pysqlite_Connection* self, PyObject* args)
 {
+    PyObject* blob;
     int rc;
+    int i;
 
     if (!pysqlite_check_thread(self)) {
         return NULL;
     }
 
     pysqlite_do_all_statements(self, ACTION_FINALIZE);
+    _pysqlite_connection_finalize_control(self);
+
+    /* open blobs would keep the database from closing */
+    for (i = 0; self->blobs && i < PyList_GET_SIZE(self->blobs); i++) {
+        blob = PyWeakref_GetObject(PyList_GET_ITEM(self->blobs, i));
+        if (blob != Py_None) {
+            (void)pysqlite_blob_close_handle((pysqlite_Blob*)blob);
+        }
+    }
 
     if (self->db) {
         Py_BEGIN_ALLOW_THREADS
@@ -367,91 +496,75 @@ int pysqlite_check_connection(pysqlite_Connection* con)
     }
 }
 
-PyObject* _pysqlite_connection_begin(pysqlite_Connection* self)
+/*
+ * Runs one of the transaction control statements. It is prepared from sql the
+ * first time and kept in *st, so that the next transactions only step it.
+ */
+static int _pysqlite_connection_step_control(pysqlite_Connection* self, sqlite3_stmt** st, const char* sql)
 {
     int rc;
     const char* tail;
-    sqlite3_stmt* statement;
 
-    Py_BEGIN_ALLOW_THREADS
-    rc = sqlite3_prepare_v2(self->db, self->begin_statement, -1, &statement, &tail);
-    Py_END_ALLOW_THREADS
+    if (!*st) {
+        Py_BEGIN_ALLOW_THREADS
+        rc = sqlite3_prepare_v2(self->db, sql, -1, st, &tail);
+        Py_END_ALLOW_THREADS
 
-    if (rc != SQLITE_OK) {
-        _pysqlite_seterror(self->db, statement);
-        goto error;
+        if (rc != SQLITE_OK) {
+            *st = NULL;
+            _pysqlite_seterror(self->db, NULL);
+            return -1;
+        }
     }
 
-    rc = pysqlite_step(statement, self);
+    rc = pysqlite_step(*st, self);
     if (rc != SQLITE_DONE) {
-        _pysqlite_seterror(self->db, statement);
+        _pysqlite_seterror(self->db, *st);
+        return -1;
     }
+    (void)sqlite3_reset(*st);
 
-    Py_BEGIN_ALLOW_THREADS
-    rc = sqlite3_finalize(statement);
-    Py_END_ALLOW_THREADS
+    return 0;
+}
 
-    if (rc != SQLITE_OK && !PyErr_Occurred()) {
-        _pysqlite_seterror(self->db, NULL);
-    }
+static void _pysqlite_connection_finalize_control(pysqlite_Connection* self)
+{
+    sqlite3_finalize(self->begin_st);
+    sqlite3_finalize(self->commit_st);
+    sqlite3_finalize(self->rollback_st);
+    self->begin_st = NULL;
+    self->commit_st = NULL;
+    self->rollback_st = NULL;
+}
 
-error:
-    if (PyErr_Occurred()) {
+PyObject* _pysqlite_connection_begin(pysqlite_Connection* self)
+{
+    if (_pysqlite_connection_step_control(self, &self->begin_st, self->begin_statement) != 0) {
         return NULL;
-    } else {
-        Py_INCREF(Py_None);
-        return Py_None;
     }
+
+    Py_INCREF(Py_None);
+    return Py_None;
 }
 
 PyObject* pysqlite_connection_commit(pysqlite_Connection* self, PyObject* args)
 {
-    int rc;
-    const char* tail;
-    sqlite3_stmt* statement;
-
     if (!pysqlite_check_thread(self) || !pysqlite_check_connection(self)) {
         return NULL;
     }
 
     if (!sqlite3_get_autocommit(self->db)) {
-        Py_BEGIN_ALLOW_THREADS
-        rc = sqlite3_prepare_v2(self->db, "COMMIT", -1, &statement, &tail);
-        Py_END_ALLOW_THREADS
-        if (rc != SQLITE_OK) {
-            _pysqlite_seterror(self->db, NULL);
-            goto error;
-        }
-
-        rc = pysqlite_step(statement, self);
-        if (rc != SQLITE_DONE) {
-            _pysqlite_seterror(self->db, statement);
-        }
-
-        Py_BEGIN_ALLOW_THREADS
-        rc = sqlite3_finalize(statement);
-        Py_END_ALLOW_THREADS
-        if (rc != SQLITE_OK && !PyErr_Occurred()) {
-            _pysqlite_seterror(self->db, NULL);
+        if (_pysqlite_connection_step_control(self, &self->commit_st, "COMMIT") != 0) {
+            return NULL;
         }
-
     }
 
-error:
-    if (PyErr_Occurred()) {
-        return NULL;
-    } else {
-        Py_INCREF(Py_None);
-        return Py_None;
-    }
+    Py_INCREF(Py_None);
+    return Py_None;
 }
 
 PyObject* pysqlite_connection_rollback(pysqlite_Connection* self, PyObject* args)
 {
-    int rc;
-    const char* tail;
-    sqlite3_stmt* statement;
-
     if (!pysqlite_check_thread(self) || !pysqlite_check_connection(self)) {
         return NULL;
     }
@@ -459,35 +572,13 @@ PyObject* pysqlite_connection_rollback(pysqlite_Connection* self, PyObject* args
     if (!sqlite3_get_autocommit(self->db)) {
         pysqlite_do_all_statements(self, ACTION_RESET);
 
-        Py_BEGIN_ALLOW_THREADS
-        rc = sqlite3_prepare_v2(self->db, "ROLLBACK", -1, &statement, &tail);
-        Py_END_ALLOW_THREADS
-        if (rc != SQLITE_OK) {
-            _pysqlite_seterror(self->db, NULL);
-            goto error;
-        }
-
-        rc = pysqlite_step(statement, self);
-        if (rc != SQLITE_DONE) {
-            _pysqlite_seterror(self->db, statement);
-        }
-
-        Py_BEGIN_ALLOW_THREADS
-        rc = sqlite3_finalize(statement);
-        Py_END_ALLOW_THREADS
-        if (rc != SQLITE_OK && !PyErr_Occurred()) {
-            _pysqlite_seterror(self->db, NULL);
+        if (_pysqlite_connection_step_control(self, &self->rollback_st, "ROLLBACK") != 0) {
+            return NULL;
         }
-
     }
 
-error:
-    if (PyErr_Occurred()) {
-        return NULL;
-    } else {
-        Py_INCREF(Py_None);
-        return Py_None;
-    }
+    Py_INCREF(Py_None);
+    return Py_None;
 }
 
 static int
@@ -1157,6 +1248,8 @@ static int pysqlite_connection_set_isolation_level(pysqlite_Connection* self, Py
         PyMem_Free(self->begin_statement);
         self->begin_statement = NULL;
     }
+    sqlite3_finalize(self->begin_st);
+    self->begin_st = NULL;
 
     if (isolation_level == Py_None) {
         Py_INCREF(Py_None);
@@ -1198,25 +1291,12 @@ static int pysqlite_connection_set_isolation_level(pysqlite_Connection* self, Py
     return 0;
 }
 
-PyObject* pysqlite_connection_call(pysqlite_Connection* self, PyObject* args, PyObject* kwargs)
+PyObject* pysqlite_connection_create_statement(pysqlite_Connection* self, PyObject* sql)
 {
-    PyObject* sql;
     pysqlite_Statement* statement;
     PyObject* weakref;
     int rc;
 
-    if (!pysqlite_check_thread(self) || !pysqlite_check_connection(self)) {
-        return NULL;
-    }
-
-    if (!_PyArg_NoKeywords("Connection()", kwargs)) {
-        return NULL;
-    }
-
-    if (!PyArg_ParseTuple(args, "O", &sql)) {
-        return NULL;
-    }
-
     _pysqlite_drop_unused_statement_references(self);
 
     statement = PyObject_New(pysqlite_Statement, &pysqlite_StatementType);
@@ -1253,6 +1333,7 @@ PyObject* pysqlite_connection_call(pysqlite_Connection* self, PyObject* args, Py
 
         if (PyList_Append(self->statements, weakref) != 0) {
             Py_CLEAR(weakref);
+            Py_CLEAR(statement);
             goto error;
         }
 
@@ -1263,6 +1344,25 @@ error:
     return (PyObject*)statement;
 }
 
+PyObject* pysqlite_connection_call(pysqlite_Connection* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* sql;
+
+    if (!pysqlite_check_thread(self) || !pysqlite_check_connection(self)) {
+        return NULL;
+    }
+
+    if (!_PyArg_NoKeywords("Connection()", kwargs)) {
+        return NULL;
+    }
+
+    if (!PyArg_ParseTuple(args, "O", &sql)) {
+        return NULL;
+    }
+
+    return pysqlite_connection_create_statement(self, sql);
+}
+
 PyObject* pysqlite_connection_execute(pysqlite_Connection* self, PyObject* args)
 {
     PyObject* cursor = 0;
@@ -1350,6 +1450,183 @@ error:
     return cursor;
 }
 
+/*
+ * Executes a single statement that returns no rows. The parameters are
+ * converted up front, so that beginning the implicit transaction, binding,
+ * stepping and resetting all happen within a single release of the GIL.
+ */
+PyObject* pysqlite_connection_execute_dml(pysqlite_Connection* self, PyObject* args)
+{
+    PyObject* operation;
+    PyObject* parameters = NULL;
+    PyObject* result = NULL;
+    pysqlite_Statement* statement = NULL;
+    pysqlite_Value* values = NULL;
+    sqlite3_stmt* st;
+    sqlite_int64 lastrowid = 0;
+    long rowcount = -1;
+    int num_params = 0;
+    int allow_8bit_chars;
+    int begin;
+    int rc = SQLITE_OK;
+    int bind_pos = 0;
+    int i;
+
+    if (!PyArg_ParseTuple(args, "O|O:execute_dml", &operation, &parameters)) {
+        return NULL;
+    }
+
+    if (!pysqlite_check_thread(self) || !pysqlite_check_connection(self)) {
+        return NULL;
+    }
+
+    if (!PyString_Check(operation) && !PyUnicode_Check(operation)) {
+        PyErr_SetString(PyExc_ValueError, "operation parameter must be str or unicode");
+        return NULL;
+    }
+
+    allow_8bit_chars = ((self->text_factory != (PyObject*)&PyUnicode_Type) &&
+        (self->text_factory != pysqlite_OptimizedUnicode));
+
+    statement = (pysqlite_Statement*)pysqlite_cache_get_statement(self->statement_cache, operation);
+    if (!statement) {
+        goto error;
+    }
+
+    pysqlite_statement_reset(statement);
+    st = statement->st;
+
+    if (st && sqlite3_column_count(st) > 0) {
+        PyErr_SetString(pysqlite_ProgrammingError, "execute_dml() can only execute statements that return no rows.");
+        goto error;
+    }
+
+    num_params = st ? sqlite3_bind_parameter_count(st) : 0;
+    values = PyMem_New(pysqlite_Value, num_params ? num_params : 1);
+    if (!values) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    if (parameters) {
+        if (pysqlite_statement_convert_parameters(statement, parameters, values, allow_8bit_chars) != 0) {
+            num_params = 0;
+            goto error;
+        }
+    } else if (num_params > 0) {
+        PyErr_Format(pysqlite_ProgrammingError, "Incorrect number of bindings supplied. The current statement uses %d, and there are 0 supplied.",
+                     num_params);
+        num_params = 0;
+        goto error;
+    }
+
+    if (!st) {
+        /* SQLite returns no statement for comments and whitespace */
+        goto done;
+    }
+
+    /* For backwards compatibility, do not start a transaction if a DDL statement is encountered. */
+    begin = self->begin_statement && !sqlite3_stmt_readonly(st) && !statement->is_ddl;
+
+    pysqlite_statement_mark_dirty(statement);
+
+    Py_BEGIN_ALLOW_THREADS
+    if (begin && sqlite3_get_autocommit(self->db)) {
+        if (!self->begin_st) {
+            rc = sqlite3_prepare_v2(self->db, self->begin_statement, -1, &self->begin_st, NULL);
+        }
+        if (rc == SQLITE_OK) {
+            (void)sqlite3_step(self->begin_st);
+            rc = sqlite3_reset(self->begin_st);
+        }
+    }
+
+    if (rc == SQLITE_OK) {
+        for (i = 0; i < num_params; i++) {
+            rc = pysqlite_statement_bind_value(statement, i + 1, &values[i], SQLITE_STATIC);
+            if (rc != SQLITE_OK) {
+                bind_pos = i + 1;
+                break;
+            }
+        }
+    }
+
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_step(st);
+        if (rc == SQLITE_DONE) {
+            if (!sqlite3_stmt_readonly(st)) {
+                rowcount = (long)sqlite3_changes(self->db);
+            }
+            lastrowid = sqlite3_last_insert_rowid(self->db);
+        }
+        (void)sqlite3_reset(st);
+    }
+
+    /* the converted values are released below, so do not leave them bound */
+    sqlite3_clear_bindings(st);
+    Py_END_ALLOW_THREADS
+
+    statement->in_use = 0;
+
+    if (bind_pos) {
+        pysqlite_statement_set_bind_error(rc, bind_pos);
+        goto error;
+    } else if (rc != SQLITE_DONE) {
+        if (PyErr_Occurred()) {
+            /* there was an error that occurred in a user-defined callback */
+            if (_enable_callback_tracebacks) {
+                PyErr_Print();
+            } else {
+                PyErr_Clear();
+            }
+        }
+        _pysqlite_seterror(self->db, NULL);
+        goto error;
+    }
+
+done:
+    result = Py_BuildValue("(lN)", rowcount, _pysqlite_long_from_int64(lastrowid));
+
+error:
+    if (values) {
+        for (i = 0; i < num_params; i++) {
+            pysqlite_value_clear(&values[i]);
+        }
+        PyMem_Free(values);
+    }
+    Py_XDECREF(statement);
+
+    return result;
+}
+
+static PyObject* pysqlite_connection_pin_statement(pysqlite_Connection* self, PyObject* sql)
+{
+    if (!pysqlite_check_thread(self) || !pysqlite_check_connection(self)) {
+        return NULL;
+    }
+
+    if (pysqlite_cache_pin(self->statement_cache, sql) != 0) {
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* pysqlite_connection_unpin_statement(pysqlite_Connection* self, PyObject* sql)
+{
+    if (!pysqlite_check_thread(self) || !pysqlite_check_connection(self)) {
+        return NULL;
+    }
+
+    if (pysqlite_cache_unpin(self->statement_cache, sql) != 0) {
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
 /* ------------------------- COLLATION CODE ------------------------ */
 
 static int
@@ -1605,6 +1882,8 @@ static PyMethodDef connection_methods[] = {
         PyDoc_STR("Return a cursor for the connection.")},
     {"close", (PyCFunction)pysqlite_connection_close, METH_NOARGS,
         PyDoc_STR("Closes the connection.")},
+    {"blobopen", (PyCFunction)pysqlite_connection_blobopen, METH_VARARGS|METH_KEYWORDS,
+        PyDoc_STR("Opens a BLOB for incremental I/O. Non-standard.")},
     {"commit", (PyCFunction)pysqlite_connection_commit, METH_NOARGS,
         PyDoc_STR("Commit the current transaction.")},
     {"rollback", (PyCFunction)pysqlite_connection_rollback, METH_NOARGS,
@@ -1631,6 +1910,12 @@ static PyMethodDef connection_methods[] = {
         PyDoc_STR("Executes a SQL statement. Non-standard.")},
     {"executemany", (PyCFunction)pysqlite_connection_executemany, METH_VARARGS,
         PyDoc_STR("Repeatedly executes a SQL statement. Non-standard.")},
+    {"execute_dml", (PyCFunction)pysqlite_connection_execute_dml, METH_VARARGS,
+        PyDoc_STR("Executes a statement that returns no rows without holding the GIL. Non-standard.")},
+    {"pin_statement", (PyCFunction)pysqlite_connection_pin_statement, METH_O,
+        PyDoc_STR("Prepares a statement and keeps it in the statement cache. Non-standard.")},
+    {"unpin_statement", (PyCFunction)pysqlite_connection_unpin_statement, METH_O,
+        PyDoc_STR("Lets a pinned statement be evicted from the statement cache again. Non-standard.")},
     {"executescript", (PyCFunction)pysqlite_connection_executescript, METH_VARARGS,
         PyDoc_STR("Executes a multiple SQL statements at once. Non-standard.")},
     {"create_collation", (PyCFunction)pysqlite_connection_create_collation, METH_VARARGS,
@@ -55,6 +55,13 @@ typedef struct
      * freed in connection destructor */
     char* begin_statement;
 
+    /* the BEGIN, COMMIT and ROLLBACK statements, prepared on first use and
+     * kept for the next transactions. begin_st is finalized when the
+     * isolation level changes. */
+    sqlite3_stmt* begin_st;
+    sqlite3_stmt* commit_st;
+    sqlite3_stmt* rollback_st;
+
     /* 1 if a check should be performed for each API call if the connection is
      * used from the same thread it was created in */
     int check_same_thread;
@@ -66,9 +73,10 @@ typedef struct
 
     pysqlite_Cache* statement_cache;
 
-    /* Lists of weak references to statements and cursors used within this connection */
+    /* Lists of weak references to statements, cursors and blobs used within this connection */
     PyObject* statements;
     PyObject* cursors;
+    PyObject* blobs;
 
     /* Counters for how many statements/cursors were created in the connection. May be
      * reset to 0 at certain intervals */
@@ -113,10 +121,13 @@ extern PyTypeObject pysqlite_ConnectionType;
 PyObject* pysqlite_connection_alloc(PyTypeObject* type, int aware);
 void pysqlite_connection_dealloc(pysqlite_Connection* self);
 PyObject* pysqlite_connection_cursor(pysqlite_Connection* self, PyObject* args, PyObject* kwargs);
+PyObject* pysqlite_connection_blobopen(pysqlite_Connection* self, PyObject* args, PyObject* kwargs);
 PyObject* pysqlite_connection_close(pysqlite_Connection* self, PyObject* args);
 PyObject* _pysqlite_connection_begin(pysqlite_Connection* self);
 PyObject* pysqlite_connection_commit(pysqlite_Connection* self, PyObject* args);
 PyObject* pysqlite_connection_rollback(pysqlite_Connection* self, PyObject* args);
+PyObject* pysqlite_connection_call(pysqlite_Connection* self, PyObject* args, PyObject* kwargs);
+PyObject* pysqlite_connection_create_statement(pysqlite_Connection* self, PyObject* sql);
 PyObject* pysqlite_connection_new(PyTypeObject* type, PyObject* args, PyObject* kw);
 int pysqlite_connection_init(pysqlite_Connection* self, PyObject* args, PyObject* kwargs);
 
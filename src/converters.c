@@ -0,0 +1,408 @@
+/* converters.c - converters implemented in C
+ *
+ * Copyright (C) 2016 Gerhard Hring <gh@ghaering.de>
+ *
+ * This file is part of pysqlite.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "converters.h"
+#include "module.h"
+#include "datetime.h"
+#include "structmember.h"
+
+enum {
+    CONVERTER_DATE,
+    CONVERTER_TIMESTAMP,
+    CONVERTER_BOOLEAN,
+    CONVERTER_DECIMAL,
+    CONVERTER_JSON,
+    CONVERTER_COUNT
+};
+
+static const char* converter_names[] = {"date", "timestamp", "boolean", "decimal", "json"};
+
+static PyObject* native_converters[CONVERTER_COUNT];
+
+static void _pysqlite_conversion_error(const char* what, const char* val_str, Py_ssize_t nbytes)
+{
+    PyObject* value;
+
+    value = PyString_FromStringAndSize(val_str, nbytes < 100 ? nbytes : 100);
+    if (value) {
+        PyErr_Format(PyExc_ValueError, "invalid %s: '%s'", what, PyString_AS_STRING(value));
+        Py_DECREF(value);
+    }
+}
+
+/*
+ * Parses the integer in [start, end), which may be surrounded by blanks and
+ * have a sign, like int() does.
+ *
+ * 0 => ok; -1 => not an integer
+ */
+static int _pysqlite_parse_int(const char* start, const char* end, PY_LONG_LONG* result)
+{
+    int negative = 0;
+    int digits = 0;
+    PY_LONG_LONG value = 0;
+
+    while (start < end && *start == ' ') {
+        start++;
+    }
+    while (end > start && *(end - 1) == ' ') {
+        end--;
+    }
+
+    if (start < end && (*start == '+' || *start == '-')) {
+        negative = (*start == '-');
+        start++;
+    }
+
+    for (; start < end; start++) {
+        if (*start < '0' || *start > '9' || digits >= 18) {
+            return -1;
+        }
+        value = value * 10 + (*start - '0');
+        digits++;
+    }
+
+    if (!digits) {
+        return -1;
+    }
+
+    *result = negative ? -value : value;
+    return 0;
+}
+
+/*
+ * Parses count integers separated by sep from [start, end) into values.
+ *
+ * 0 => ok; -1 => wrong format
+ */
+static int _pysqlite_parse_fields(const char* start, const char* end, char sep, int count, int* values)
+{
+    const char* pos;
+    PY_LONG_LONG value;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        for (pos = start; pos < end && *pos != sep; pos++);
+
+        if ((pos < end) != (i < count - 1)) {
+            /* too few or too many fields */
+            return -1;
+        }
+
+        if (_pysqlite_parse_int(start, pos, &value) != 0 || value > INT_MAX || value < INT_MIN) {
+            return -1;
+        }
+        values[i] = (int)value;
+
+        start = pos + 1;
+    }
+
+    return 0;
+}
+
+/*
+ * The datetime C API does not range check its arguments, so do what the
+ * date and datetime constructors would do.
+ *
+ * 0 => ok; -1 => out of range
+ */
+static int _pysqlite_check_date(const int* date)
+{
+    static const int days_in_month[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    int year = date[0];
+    int month = date[1];
+    int days;
+
+    if (year < 1 || year > 9999 || month < 1 || month > 12) {
+        return -1;
+    }
+
+    days = days_in_month[month - 1];
+    if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) {
+        days = 29;
+    }
+
+    return (date[2] < 1 || date[2] > days) ? -1 : 0;
+}
+
+static int _pysqlite_check_time(const int* time)
+{
+    if (time[0] < 0 || time[0] > 23 || time[1] < 0 || time[1] > 59 || time[2] < 0 || time[2] > 59) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static PyObject* _pysqlite_convert_date(const char* val_str, Py_ssize_t nbytes)
+{
+    int date[3];
+
+    if (_pysqlite_parse_fields(val_str, val_str + nbytes, '-', 3, date) != 0
+        || _pysqlite_check_date(date) != 0) {
+        _pysqlite_conversion_error("date", val_str, nbytes);
+        return NULL;
+    }
+
+    return PyDate_FromDate(date[0], date[1], date[2]);
+}
+
+static PyObject* _pysqlite_convert_timestamp(const char* val_str, Py_ssize_t nbytes)
+{
+    const char* end = val_str + nbytes;
+    const char* space;
+    const char* dot;
+    const char* pos;
+    int date[3];
+    int time[3];
+    int microseconds = 0;
+    int i;
+
+    for (space = val_str; space < end && *space != ' '; space++);
+    for (dot = space; dot < end && *dot != '.'; dot++);
+
+    if (space == end
+        || _pysqlite_parse_fields(val_str, space, '-', 3, date) != 0
+        || _pysqlite_parse_fields(space + 1, dot, ':', 3, time) != 0
+        || _pysqlite_check_date(date) != 0
+        || _pysqlite_check_time(time) != 0) {
+        goto error;
+    }
+
+    /* the fraction is padded with zeros or truncated to six digits */
+    if (dot < end) {
+        pos = dot + 1;
+        for (i = 0; i < 6; i++) {
+            microseconds *= 10;
+            if (pos < end) {
+                if (*pos < '0' || *pos > '9') {
+                    goto error;
+                }
+                microseconds += *pos - '0';
+                pos++;
+            }
+        }
+        for (; pos < end; pos++) {
+            if (*pos < '0' || *pos > '9') {
+                goto error;
+            }
+        }
+    }
+
+    return PyDateTime_FromDateAndTime(date[0], date[1], date[2], time[0], time[1], time[2], microseconds);
+
+error:
+    _pysqlite_conversion_error("timestamp", val_str, nbytes);
+    return NULL;
+}
+
+static PyObject* _pysqlite_convert_boolean(const char* val_str, Py_ssize_t nbytes)
+{
+    PY_LONG_LONG value;
+
+    if (_pysqlite_parse_int(val_str, val_str + nbytes, &value) != 0) {
+        _pysqlite_conversion_error("boolean", val_str, nbytes);
+        return NULL;
+    }
+
+    return PyBool_FromLong(value != 0);
+}
+
+/*
+ * Checks that [start, end) is a decimal number: an optional sign, digits with
+ * an optional decimal point and an optional exponent.
+ *
+ * 0 => ok; -1 => not a decimal number
+ */
+static int _pysqlite_check_decimal(const char* start, const char* end)
+{
+    int digits = 0;
+
+    if (start < end && (*start == '+' || *start == '-')) {
+        start++;
+    }
+    for (; start < end && *start >= '0' && *start <= '9'; start++) {
+        digits++;
+    }
+    if (start < end && *start == '.') {
+        for (start++; start < end && *start >= '0' && *start <= '9'; start++) {
+            digits++;
+        }
+    }
+    if (!digits) {
+        return -1;
+    }
+
+    if (start < end && (*start == 'e' || *start == 'E')) {
+        start++;
+        if (start < end && (*start == '+' || *start == '-')) {
+            start++;
+        }
+        if (start == end) {
+            return -1;
+        }
+        for (; start < end && *start >= '0' && *start <= '9'; start++);
+    }
+
+    return (start == end) ? 0 : -1;
+}
+
+/* Returns the number as a string with all its digits, so that no precision is
+ * lost and no Python code runs; decimal.Decimal() accepts it as it is. */
+static PyObject* _pysqlite_convert_decimal(const char* val_str, Py_ssize_t nbytes)
+{
+    if (_pysqlite_check_decimal(val_str, val_str + nbytes) != 0) {
+        _pysqlite_conversion_error("decimal", val_str, nbytes);
+        return NULL;
+    }
+
+    return PyString_FromStringAndSize(val_str, nbytes);
+}
+
+PyObject* pysqlite_native_convert(PyObject* converter, const char* val_str, Py_ssize_t nbytes)
+{
+    switch (((pysqlite_NativeConverter*)converter)->kind) {
+        case CONVERTER_DATE:
+            return _pysqlite_convert_date(val_str, nbytes);
+        case CONVERTER_TIMESTAMP:
+            return _pysqlite_convert_timestamp(val_str, nbytes);
+        case CONVERTER_BOOLEAN:
+            return _pysqlite_convert_boolean(val_str, nbytes);
+        case CONVERTER_DECIMAL:
+            return _pysqlite_convert_decimal(val_str, nbytes);
+        default:
+            /* JSON is passed through as text */
+            return PyUnicode_DecodeUTF8(val_str, nbytes, NULL);
+    }
+}
+
+PyObject* pysqlite_native_converter_get(const char* name)
+{
+    int i;
+
+    for (i = 0; i < CONVERTER_COUNT; i++) {
+        if (strcmp(name, converter_names[i]) == 0) {
+            Py_INCREF(native_converters[i]);
+            return native_converters[i];
+        }
+    }
+
+    PyErr_Format(PyExc_ValueError, "unknown native converter '%.100s'", name);
+    return NULL;
+}
+
+static PyObject* pysqlite_native_converter_call(pysqlite_NativeConverter* self, PyObject* args, PyObject* kwargs)
+{
+    const char* val_str;
+    int nbytes;
+
+    if (!_PyArg_NoKeywords("NativeConverter()", kwargs)) {
+        return NULL;
+    }
+
+    if (!PyArg_ParseTuple(args, "s#", &val_str, &nbytes)) {
+        return NULL;
+    }
+
+    return pysqlite_native_convert((PyObject*)self, val_str, nbytes);
+}
+
+static PyObject* pysqlite_native_converter_repr(pysqlite_NativeConverter* self)
+{
+    return PyString_FromFormat("<native converter '%s'>", self->name);
+}
+
+static struct PyMemberDef native_converter_members[] =
+{
+    {"name", T_STRING, offsetof(pysqlite_NativeConverter, name), RO},
+    {NULL}
+};
+
+PyTypeObject pysqlite_NativeConverterType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        MODULE_NAME ".NativeConverter",                 /* tp_name */
+        sizeof(pysqlite_NativeConverter),               /* tp_basicsize */
+        0,                                              /* tp_itemsize */
+        0,                                              /* tp_dealloc */
+        0,                                              /* tp_print */
+        0,                                              /* tp_getattr */
+        0,                                              /* tp_setattr */
+        0,                                              /* tp_compare */
+        (reprfunc)pysqlite_native_converter_repr,       /* tp_repr */
+        0,                                              /* tp_as_number */
+        0,                                              /* tp_as_sequence */
+        0,                                              /* tp_as_mapping */
+        0,                                              /* tp_hash */
+        (ternaryfunc)pysqlite_native_converter_call,    /* tp_call */
+        0,                                              /* tp_str */
+        0,                                              /* tp_getattro */
+        0,                                              /* tp_setattro */
+        0,                                              /* tp_as_buffer */
+        Py_TPFLAGS_DEFAULT,                             /* tp_flags */
+        0,                                              /* tp_doc */
+        0,                                              /* tp_traverse */
+        0,                                              /* tp_clear */
+        0,                                              /* tp_richcompare */
+        0,                                              /* tp_weaklistoffset */
+        0,                                              /* tp_iter */
+        0,                                              /* tp_iternext */
+        0,                                              /* tp_methods */
+        native_converter_members,                       /* tp_members */
+        0,                                              /* tp_getset */
+        0,                                              /* tp_base */
+        0,                                              /* tp_dict */
+        0,                                              /* tp_descr_get */
+        0,                                              /* tp_descr_set */
+        0,                                              /* tp_dictoffset */
+        0,                                              /* tp_init */
+        0,                                              /* tp_alloc */
+        0,                                              /* tp_new */
+        0                                               /* tp_free */
+};
+
+extern int pysqlite_converters_setup_types(void)
+{
+    pysqlite_NativeConverter* converter;
+    int i;
+
+    PyDateTime_IMPORT;
+    if (!PyDateTimeAPI) {
+        return -1;
+    }
+
+    if (PyType_Ready(&pysqlite_NativeConverterType) < 0) {
+        return -1;
+    }
+
+    for (i = 0; i < CONVERTER_COUNT; i++) {
+        converter = PyObject_New(pysqlite_NativeConverter, &pysqlite_NativeConverterType);
+        if (!converter) {
+            return -1;
+        }
+        converter->kind = i;
+        converter->name = converter_names[i];
+        native_converters[i] = (PyObject*)converter;
+    }
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+/* converters.h - converters implemented in C
+ *
+ * Copyright (C) 2016 Gerhard Hring <gh@ghaering.de>
+ *
+ * This file is part of pysqlite.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PYSQLITE_CONVERTERS_H
+#define PYSQLITE_CONVERTERS_H
+#include "Python.h"
+
+/* A converter implemented in C. Instances are callable like any other
+ * converter, but the cursor calls pysqlite_native_convert() on them
+ * directly, without creating a string object or calling into Python. */
+
+typedef struct
+{
+    PyObject_HEAD
+    int kind;
+    const char* name;
+} pysqlite_NativeConverter;
+
+extern PyTypeObject pysqlite_NativeConverterType;
+
+#define pysqlite_NativeConverter_Check(op) (Py_TYPE(op) == &pysqlite_NativeConverterType)
+
+/* returns a new reference to the native converter called name, or NULL with
+ * a ValueError set if there is none */
+PyObject* pysqlite_native_converter_get(const char* name);
+
+PyObject* pysqlite_native_convert(PyObject* converter, const char* val_str, Py_ssize_t nbytes);
+
+int pysqlite_converters_setup_types(void);
+
+#endif
@@ -22,6 +22,10 @@
  */
 
 #include "cursor.h"
+#include "column.h"
+#include "row.h"
+#include "registry.h"
+#include "converters.h"
 #include "module.h"
 #include "util.h"
 
@@ -34,6 +38,91 @@
 #endif
 
 PyObject* pysqlite_cursor_iternext(pysqlite_Cursor* self);
+static int check_cursor(pysqlite_Cursor* cur);
+
+/* number of rows fetchmany()/fetchall() step through per GIL release */
+#define PYSQLITE_FETCH_BATCH 256
+
+/* TEXT and BLOB values up to this size are copied into the staging area of a
+ * batch. A row with a larger value ends the batch and is converted straight
+ * from the statement, so that the value is copied only once. */
+#define PYSQLITE_FETCH_STAGE_LIMIT 4096
+
+/* with blob_views set, a batch ends once this many bytes are staged, as every
+ * view keeps the data of its whole batch alive */
+#define PYSQLITE_BLOB_ARENA_SIZE (64 * 1024)
+
+/* a column value copied out of SQLite by the batch fetching code */
+typedef struct
+{
+    int type;
+    sqlite3_int64 intval;
+    double dblval;
+
+    /* position of TEXT/BLOB values in the staging area's data */
+    Py_ssize_t offset;
+    Py_ssize_t nbytes;
+} pysqlite_Cell;
+
+/* staging area for rows stepped through without holding the GIL */
+typedef struct
+{
+    int numcols;
+    Py_ssize_t rows;
+    Py_ssize_t allocated;
+    pysqlite_Cell* cells;
+
+    char* data;
+    Py_ssize_t nbytes;
+    Py_ssize_t data_allocated;
+
+    /* set if data holds a BLOB value without a converter */
+    int blobs;
+} pysqlite_RowBatch;
+
+/* the data of a fetch batch, shared by the BLOB values returned with
+ * blob_views set */
+typedef struct
+{
+    PyObject_HEAD
+    char* data;
+    Py_ssize_t nbytes;
+} pysqlite_BlobArena;
+
+static PyTypeObject pysqlite_BlobArenaType;
+
+/* a BLOB value of the current row of a cursor's statement, returned by
+ * fetchone() and iteration with blob_views set. It can only be read until
+ * the statement moves to another row. The cursor is referenced weakly, as its
+ * prefetched row may hold views itself. */
+typedef struct
+{
+    PyObject_HEAD
+    PyObject* cursor_ref;
+    unsigned long moves;
+    int column;
+} pysqlite_BlobView;
+
+static PyTypeObject pysqlite_BlobViewType;
+
+/* number of rows executecolumns() binds and steps per GIL release */
+#define PYSQLITE_EXECUTE_BATCH 1024
+
+/* a parameter column of executecolumns() */
+typedef struct
+{
+    /* the items of a sequence column, converted batch by batch into values */
+    PyObject* seq;
+    pysqlite_Value* values;
+
+    /* a buffer column: kind is 'i' (signed), 'u' (unsigned) or 'f' (floating point) */
+    Py_buffer view;
+    int has_view;
+    char kind;
+    Py_ssize_t stride;
+
+    Py_ssize_t length;
+} pysqlite_ParamColumn;
 
 static char* errmsg_fetch_across_rollback = "Cursor needed to be reset because of commit/rollback and can no longer be fetched from.";
 
@@ -50,7 +139,12 @@ static int pysqlite_cursor_init(pysqlite_Cursor* self, PyObject* args, PyObject*
     self->connection = connection;
     self->statement = NULL;
     self->next_row = NULL;
+    self->column_map = NULL;
+    self->named_row_type = NULL;
     self->in_weakreflist = NULL;
+    self->moves = 0;
+    self->next_row_views = 0;
+    self->step_pending = 0;
 
     self->row_cast_map = PyList_New(0);
     if (!self->row_cast_map) {
@@ -64,6 +158,7 @@ static int pysqlite_cursor_init(pysqlite_Cursor* self, PyObject* args, PyObject*
     self->lastrowid= Py_None;
 
     self->arraysize = 1;
+    self->blob_views = 0;
     self->closed = 0;
     self->reset = 0;
 
@@ -93,6 +188,8 @@ static void pysqlite_cursor_dealloc(pysqlite_Cursor* self)
     Py_XDECREF(self->connection);
     Py_XDECREF(self->row_cast_map);
     Py_XDECREF(self->description);
+    Py_XDECREF(self->column_map);
+    Py_XDECREF(self->named_row_type);
     Py_XDECREF(self->lastrowid);
     Py_XDECREF(self->next_row);
 
@@ -119,6 +216,25 @@ PyObject* _pysqlite_get_converter(PyObject* key)
     return retval;
 }
 
+/*
+ * Returns the number of times SQLite re-prepared the statement, which happens
+ * after schema changes. The result columns can only change then.
+ */
+static int _pysqlite_reprepare_count(pysqlite_Statement* statement)
+{
+#ifdef SQLITE_STMTSTATUS_REPREPARE
+    return sqlite3_stmt_status(statement->st, SQLITE_STMTSTATUS_REPREPARE, 0);
+#else
+    return -1;
+#endif
+}
+
+/*
+ * Sets self->row_cast_map to the converters of the result columns.
+ *
+ * The list is kept on the statement and reused until the converters
+ * registry is modified or the statement is re-prepared.
+ */
 int pysqlite_build_row_cast_map(pysqlite_Cursor* self)
 {
     int i;
@@ -130,13 +246,32 @@ int pysqlite_build_row_cast_map(pysqlite_Cursor* self)
     PyObject* py_decltype;
     PyObject* converter;
     PyObject* key;
+    pysqlite_Statement* statement = self->statement;
+    int reprepare_count;
 
     if (!self->connection->detect_types) {
         return 0;
     }
 
+    reprepare_count = _pysqlite_reprepare_count(statement);
+    if (statement->row_cast_map
+            && statement->converters_version == pysqlite_registry_version(converters)
+            && statement->reprepare_count == reprepare_count
+            && reprepare_count != -1) {
+        if (self->row_cast_map != statement->row_cast_map) {
+            Py_XDECREF(self->row_cast_map);
+            Py_INCREF(statement->row_cast_map);
+            self->row_cast_map = statement->row_cast_map;
+        }
+        return 0;
+    }
+
+    Py_CLEAR(statement->row_cast_map);
     Py_XDECREF(self->row_cast_map);
     self->row_cast_map = PyList_New(0);
+    if (!self->row_cast_map) {
+        return -1;
+    }
 
     for (i = 0; i < sqlite3_column_count(self->statement->st); i++) {
         converter = NULL;
@@ -200,6 +335,11 @@ int pysqlite_build_row_cast_map(pysqlite_Cursor* self)
         }
     }
 
+    Py_INCREF(self->row_cast_map);
+    statement->row_cast_map = self->row_cast_map;
+    statement->converters_version = pysqlite_registry_version(converters);
+    statement->reprepare_count = reprepare_count;
+
     return 0;
 }
 
@@ -222,6 +362,68 @@ PyObject* _pysqlite_build_column_name(const char* colname)
     }
 }
 
+/*
+ * Sets self->description for the result columns of self->statement.
+ *
+ * Like the row_cast_map, the description tuple is kept on the statement and
+ * shared by all cursors executing it, until the statement is re-prepared.
+ */
+static int _pysqlite_build_description(pysqlite_Cursor* self)
+{
+    pysqlite_Statement* statement = self->statement;
+    PyObject* description;
+    PyObject* descriptor;
+    int reprepare_count;
+    int numcols;
+    int i;
+
+    reprepare_count = _pysqlite_reprepare_count(statement);
+    if (!statement->description
+            || statement->description_reprepare_count != reprepare_count
+            || reprepare_count == -1) {
+        numcols = sqlite3_column_count(statement->st);
+        description = PyTuple_New(numcols);
+        if (!description) {
+            return -1;
+        }
+        for (i = 0; i < numcols; i++) {
+            descriptor = PyTuple_New(7);
+            if (!descriptor) {
+                Py_DECREF(description);
+                return -1;
+            }
+            PyTuple_SetItem(descriptor, 0, _pysqlite_build_column_name(sqlite3_column_name(statement->st, i)));
+            Py_INCREF(Py_None); PyTuple_SetItem(descriptor, 1, Py_None);
+            Py_INCREF(Py_None); PyTuple_SetItem(descriptor, 2, Py_None);
+            Py_INCREF(Py_None); PyTuple_SetItem(descriptor, 3, Py_None);
+            Py_INCREF(Py_None); PyTuple_SetItem(descriptor, 4, Py_None);
+            Py_INCREF(Py_None); PyTuple_SetItem(descriptor, 5, Py_None);
+            Py_INCREF(Py_None); PyTuple_SetItem(descriptor, 6, Py_None);
+            PyTuple_SetItem(description, i, descriptor);
+        }
+
+        Py_XDECREF(statement->description);
+        statement->description = description;
+        statement->description_reprepare_count = reprepare_count;
+        Py_CLEAR(statement->column_map);
+        Py_CLEAR(statement->named_row_type);
+    }
+
+    Py_DECREF(self->description);
+    Py_INCREF(statement->description);
+    self->description = statement->description;
+
+    Py_XDECREF(self->column_map);
+    Py_XINCREF(statement->column_map);
+    self->column_map = statement->column_map;
+
+    Py_XDECREF(self->named_row_type);
+    Py_XINCREF(statement->named_row_type);
+    self->named_row_type = statement->named_row_type;
+
+    return 0;
+}
+
 static PyObject* pysqlite_unicode_from_string(const char* val_str, Py_ssize_t size, int optimize)
 {
     const char* check;
@@ -250,34 +452,224 @@ static PyObject* pysqlite_unicode_from_string(const char* val_str, Py_ssize_t si
 }
 
 /*
- * Returns a row from the currently active SQLite statement
+ * Converts a single column value to a Python object, using the column's
+ * converter or the connection's text_factory.
  *
- * Precondition:
- * - sqlite3_step() has been called before and it returned SQLITE_ROW.
+ * For columns with a converter, val_str/nbytes hold the raw bytes of the value
+ * and coltype is SQLITE_NULL if there are none. TEXT values must be NUL
+ * terminated.
  */
-PyObject* _pysqlite_fetch_one_row(pysqlite_Cursor* self)
+static PyObject* _pysqlite_convert_value(pysqlite_Cursor* self, sqlite3_stmt* st, int i,
+                                         PyObject* converter, int coltype,
+                                         sqlite3_int64 intval, double dblval,
+                                         const char* val_str, Py_ssize_t nbytes)
 {
-    int i, numcols;
-    PyObject* row;
-    PyObject* item = NULL;
-    int coltype;
-    PyObject* converter;
+    PyObject* item;
     PyObject* converted;
-    Py_ssize_t nbytes;
-    PyObject* buffer;
     void* raw_buffer;
-    const char* val_str;
     char buf[200];
     const char* colname;
 
-    if (self->reset) {
-        PyErr_SetString(pysqlite_InterfaceError, errmsg_fetch_across_rollback);
+    if (converter != Py_None) {
+        if (coltype == SQLITE_NULL) {
+            Py_INCREF(Py_None);
+            return Py_None;
+        }
+
+        if (pysqlite_NativeConverter_Check(converter)) {
+            return pysqlite_native_convert(converter, val_str, nbytes);
+        }
+
+        item = PyString_FromStringAndSize(val_str, nbytes);
+        if (!item) {
+            return NULL;
+        }
+        converted = PyObject_CallFunction(converter, "O", item);
+        Py_DECREF(item);
+        return converted;
+    }
+
+    if (coltype == SQLITE_NULL) {
+        Py_INCREF(Py_None);
+        converted = Py_None;
+    } else if (coltype == SQLITE_INTEGER) {
+        converted = _pysqlite_long_from_int64(intval);
+    } else if (coltype == SQLITE_FLOAT) {
+        converted = PyFloat_FromDouble(dblval);
+    } else if (coltype == SQLITE_TEXT) {
+        if ((self->connection->text_factory == (PyObject*)&PyUnicode_Type)
+            || (self->connection->text_factory == pysqlite_OptimizedUnicode)) {
+
+            converted = pysqlite_unicode_from_string(val_str, nbytes,
+                self->connection->text_factory == pysqlite_OptimizedUnicode ? 1 : 0);
+
+            if (!converted) {
+                colname = sqlite3_column_name(st, i);
+                if (!colname) {
+                    colname = "<unknown column name>";
+                }
+                PyOS_snprintf(buf, sizeof(buf) - 1, "Could not decode to UTF-8 column '%s' with text '%s'",
+                             colname , val_str);
+                PyErr_SetString(pysqlite_OperationalError, buf);
+            }
+        } else if (self->connection->text_factory == (PyObject*)&PyString_Type) {
+            converted = PyString_FromStringAndSize(val_str, nbytes);
+        } else {
+            converted = PyObject_CallFunction(self->connection->text_factory, "s#", val_str, nbytes);
+        }
+    } else {
+        /* coltype == SQLITE_BLOB */
+        converted = PyBuffer_New(nbytes);
+        if (!converted) {
+            return NULL;
+        }
+        if (PyObject_AsWriteBuffer(converted, &raw_buffer, &nbytes)) {
+            Py_DECREF(converted);
+            return NULL;
+        }
+        memcpy(raw_buffer, val_str, nbytes);
+    }
+
+    return converted;
+}
+
+static void pysqlite_blob_view_dealloc(pysqlite_BlobView* self)
+{
+    Py_DECREF(self->cursor_ref);
+    PyObject_Del(self);
+}
+
+/* returns the statement whose row the view refers to, or NULL if it moved */
+static sqlite3_stmt* _pysqlite_blob_view_statement(pysqlite_BlobView* self)
+{
+    PyObject* obj = PyWeakref_GetObject(self->cursor_ref);
+    pysqlite_Cursor* cursor;
+
+    if (obj == Py_None) {
         return NULL;
     }
 
-    Py_BEGIN_ALLOW_THREADS
-    numcols = sqlite3_data_count(self->statement->st);
-    Py_END_ALLOW_THREADS
+    cursor = (pysqlite_Cursor*)obj;
+    if (cursor->moves != self->moves || !cursor->statement || !cursor->statement->st) {
+        return NULL;
+    }
+
+    return cursor->statement->st;
+}
+
+static Py_ssize_t pysqlite_blob_view_getreadbuf(pysqlite_BlobView* self, Py_ssize_t segment, void** ptrptr)
+{
+    sqlite3_stmt* st;
+
+    if (segment != 0) {
+        PyErr_SetString(PyExc_SystemError, "accessing non-existent view segment");
+        return -1;
+    }
+
+    st = _pysqlite_blob_view_statement(self);
+    if (!st) {
+        PyErr_SetString(pysqlite_ProgrammingError, "The BLOB view can't be read after its cursor moved on.");
+        return -1;
+    }
+
+    *ptrptr = (void*)sqlite3_column_blob(st, self->column);
+    if (!*ptrptr) {
+        /* zero-length BLOB */
+        *ptrptr = (void*)"";
+    }
+    return sqlite3_column_bytes(st, self->column);
+}
+
+static Py_ssize_t pysqlite_blob_view_getsegcount(pysqlite_BlobView* self, Py_ssize_t* lenp)
+{
+    sqlite3_stmt* st;
+
+    if (lenp) {
+        st = _pysqlite_blob_view_statement(self);
+        *lenp = st ? sqlite3_column_bytes(st, self->column) : 0;
+    }
+
+    return 1;
+}
+
+static PyBufferProcs pysqlite_blob_view_as_buffer = {
+    (readbufferproc)pysqlite_blob_view_getreadbuf,  /* bf_getreadbuffer */
+    0,                                              /* bf_getwritebuffer */
+    (segcountproc)pysqlite_blob_view_getsegcount,   /* bf_getsegcount */
+    0,                                              /* bf_getcharbuffer */
+};
+
+static PyTypeObject pysqlite_BlobViewType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        MODULE_NAME ".BlobView",                        /* tp_name */
+        sizeof(pysqlite_BlobView),                      /* tp_basicsize */
+        0,                                              /* tp_itemsize */
+        (destructor)pysqlite_blob_view_dealloc,         /* tp_dealloc */
+        0,                                              /* tp_print */
+        0,                                              /* tp_getattr */
+        0,                                              /* tp_setattr */
+        0,                                              /* tp_compare */
+        0,                                              /* tp_repr */
+        0,                                              /* tp_as_number */
+        0,                                              /* tp_as_sequence */
+        0,                                              /* tp_as_mapping */
+        0,                                              /* tp_hash */
+        0,                                              /* tp_call */
+        0,                                              /* tp_str */
+        0,                                              /* tp_getattro */
+        0,                                              /* tp_setattro */
+        &pysqlite_blob_view_as_buffer,                  /* tp_as_buffer */
+        Py_TPFLAGS_DEFAULT,                             /* tp_flags */
+};
+
+/*
+ * Returns a read-only buffer over column i of the current row, valid until
+ * the statement of the cursor moves on.
+ */
+static PyObject* _pysqlite_blob_view_new(pysqlite_Cursor* cursor, int i, Py_ssize_t nbytes)
+{
+    pysqlite_BlobView* view;
+    PyObject* buffer;
+
+    view = PyObject_New(pysqlite_BlobView, &pysqlite_BlobViewType);
+    if (!view) {
+        return NULL;
+    }
+
+    view->cursor_ref = PyWeakref_NewRef((PyObject*)cursor, NULL);
+    if (!view->cursor_ref) {
+        PyObject_Del(view);
+        return NULL;
+    }
+    view->moves = cursor->moves;
+    view->column = i;
+
+    buffer = PyBuffer_FromObject((PyObject*)view, 0, nbytes);
+    Py_DECREF(view);
+
+    return buffer;
+}
+
+/*
+ * Returns the current row of st, converted with the converters in
+ * row_cast_map if it is not NULL. If views is not NULL, BLOB values without
+ * a converter are returned as views of the row, and *views is set if there
+ * are any.
+ */
+static PyObject* _pysqlite_build_row(pysqlite_Cursor* self, sqlite3_stmt* st, PyObject* row_cast_map,
+                                     int* views)
+{
+    int i, numcols;
+    PyObject* row;
+    int coltype;
+    PyObject* converter;
+    PyObject* converted;
+    sqlite3_int64 intval = 0;
+    double dblval = 0.0;
+    const char* val_str = NULL;
+    Py_ssize_t nbytes = 0;
+
+    numcols = sqlite3_data_count(st);
 
     row = PyTuple_New(numcols);
     if (!row) {
@@ -285,8 +677,8 @@ PyObject* _pysqlite_fetch_one_row(pysqlite_Cursor* self)
     }
 
     for (i = 0; i < numcols; i++) {
-        if (self->connection->detect_types) {
-            converter = PyList_GetItem(self->row_cast_map, i);
+        if (row_cast_map) {
+            converter = PyList_GetItem(row_cast_map, i);
             if (!converter) {
                 converter = Py_None;
             }
@@ -295,147 +687,741 @@ PyObject* _pysqlite_fetch_one_row(pysqlite_Cursor* self)
         }
 
         if (converter != Py_None) {
-            nbytes = sqlite3_column_bytes(self->statement->st, i);
-            val_str = (const char*)sqlite3_column_blob(self->statement->st, i);
-            if (!val_str) {
-                Py_INCREF(Py_None);
-                converted = Py_None;
-            } else {
-                item = PyString_FromStringAndSize(val_str, nbytes);
-                if (!item) {
-                    return NULL;
-                }
-                converted = PyObject_CallFunction(converter, "O", item);
-                Py_DECREF(item);
-                if (!converted) {
-                    break;
-                }
-            }
+            val_str = (const char*)sqlite3_column_blob(st, i);
+            nbytes = sqlite3_column_bytes(st, i);
+            coltype = val_str ? SQLITE_BLOB : SQLITE_NULL;
         } else {
-            Py_BEGIN_ALLOW_THREADS
-            coltype = sqlite3_column_type(self->statement->st, i);
-            Py_END_ALLOW_THREADS
-            if (coltype == SQLITE_NULL) {
-                Py_INCREF(Py_None);
-                converted = Py_None;
-            } else if (coltype == SQLITE_INTEGER) {
-                converted = _pysqlite_long_from_int64(sqlite3_column_int64(self->statement->st, i));
+            coltype = sqlite3_column_type(st, i);
+            if (coltype == SQLITE_INTEGER) {
+                intval = sqlite3_column_int64(st, i);
             } else if (coltype == SQLITE_FLOAT) {
-                converted = PyFloat_FromDouble(sqlite3_column_double(self->statement->st, i));
+                dblval = sqlite3_column_double(st, i);
             } else if (coltype == SQLITE_TEXT) {
-                val_str = (const char*)sqlite3_column_text(self->statement->st, i);
-                nbytes = sqlite3_column_bytes(self->statement->st, i);
-                if ((self->connection->text_factory == (PyObject*)&PyUnicode_Type)
-                    || (self->connection->text_factory == pysqlite_OptimizedUnicode)) {
-
-                    converted = pysqlite_unicode_from_string(val_str, nbytes,
-                        self->connection->text_factory == pysqlite_OptimizedUnicode ? 1 : 0);
-
-                    if (!converted) {
-                        colname = sqlite3_column_name(self->statement->st, i);
-                        if (!colname) {
-                            colname = "<unknown column name>";
-                        }
-                        PyOS_snprintf(buf, sizeof(buf) - 1, "Could not decode to UTF-8 column '%s' with text '%s'",
-                                     colname , val_str);
-                        PyErr_SetString(pysqlite_OperationalError, buf);
-                    }
-                } else if (self->connection->text_factory == (PyObject*)&PyString_Type) {
-                    converted = PyString_FromStringAndSize(val_str, nbytes);
-                } else {
-                    converted = PyObject_CallFunction(self->connection->text_factory, "s#", val_str, nbytes);
-                }
-            } else {
-                /* coltype == SQLITE_BLOB */
-                nbytes = sqlite3_column_bytes(self->statement->st, i);
-                buffer = PyBuffer_New(nbytes);
-                if (!buffer) {
-                    break;
-                }
-                if (PyObject_AsWriteBuffer(buffer, &raw_buffer, &nbytes)) {
-                    break;
-                }
-                memcpy(raw_buffer, sqlite3_column_blob(self->statement->st, i), nbytes);
-                converted = buffer;
+                val_str = (const char*)sqlite3_column_text(st, i);
+                nbytes = sqlite3_column_bytes(st, i);
+            } else if (coltype == SQLITE_BLOB) {
+                val_str = (const char*)sqlite3_column_blob(st, i);
+                nbytes = sqlite3_column_bytes(st, i);
             }
         }
 
-        if (converted) {
-            PyTuple_SetItem(row, i, converted);
+        if (views && coltype == SQLITE_BLOB && converter == Py_None) {
+            converted = _pysqlite_blob_view_new(self, i, nbytes);
+            *views = 1;
         } else {
-            Py_INCREF(Py_None);
-            PyTuple_SetItem(row, i, Py_None);
+            converted = _pysqlite_convert_value(self, st, i, converter, coltype,
+                                                intval, dblval, val_str, nbytes);
         }
-    }
-
-    if (PyErr_Occurred()) {
-        Py_DECREF(row);
-        row = NULL;
+        if (!converted) {
+            Py_DECREF(row);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(row, i, converted);
     }
 
     return row;
 }
 
 /*
- * Checks if a cursor object is usable.
+ * Returns a row from the currently active SQLite statement, to be stored in
+ * next_row. With blob_views set, its BLOB values are views of the row.
  *
- * 0 => error; 1 => ok
+ * Precondition:
+ * - sqlite3_step() has been called before and it returned SQLITE_ROW.
  */
-static int check_cursor(pysqlite_Cursor* cur)
+PyObject* _pysqlite_fetch_one_row(pysqlite_Cursor* self)
 {
-    if (!cur->initialized) {
-        PyErr_SetString(pysqlite_ProgrammingError, "Base Cursor.__init__ not called.");
-        return 0;
+    if (self->reset) {
+        PyErr_SetString(pysqlite_InterfaceError, errmsg_fetch_across_rollback);
+        return NULL;
     }
 
-    if (cur->closed) {
-        PyErr_SetString(pysqlite_ProgrammingError, "Cannot operate on a closed cursor.");
+    self->next_row_views = 0;
+    return _pysqlite_build_row(self, self->statement->st,
+                               self->connection->detect_types ? self->row_cast_map : NULL,
+                               self->blob_views ? &self->next_row_views : NULL);
+}
+
+/*
+ * Steps past the last returned row if that was put off because the row holds
+ * BLOB views, and prefetches the next row as usual.
+ */
+static int _pysqlite_cursor_advance(pysqlite_Cursor* self)
+{
+    int rc;
+
+    if (!self->step_pending) {
         return 0;
     }
+    self->step_pending = 0;
+    self->moves++;
 
-    if (cur->locked) {
-        PyErr_SetString(pysqlite_ProgrammingError, "Recursive use of cursors not allowed.");
+    if (!self->statement) {
         return 0;
     }
 
-    return pysqlite_check_thread(cur->connection) && pysqlite_check_connection(cur->connection);
+    rc = pysqlite_step(self->statement->st, self->connection);
+    if (rc == SQLITE_ROW) {
+        self->next_row = _pysqlite_fetch_one_row(self);
+        return self->next_row ? 0 : -1;
+    } else if (rc != SQLITE_DONE) {
+        (void)pysqlite_statement_reset(self->statement);
+        _pysqlite_seterror(self->connection->db, NULL);
+        return -1;
+    }
+
+    return 0;
 }
 
-PyObject* _pysqlite_query_execute(pysqlite_Cursor* self, int multiple, PyObject* args)
+/*
+ * Makes room for one more row in the staging area. Called without the GIL.
+ */
+static int _pysqlite_batch_reserve_row(pysqlite_RowBatch* batch)
 {
-    PyObject* operation = NULL;
-    PyObject* parameters_list = NULL;
-    PyObject* parameters_iter = NULL;
-    PyObject* parameters = NULL;
-    int i;
-    int rc;
-    PyObject* func_args = NULL;
-    PyObject* result = NULL;
-    int numcols;
-    PyObject* descriptor = NULL;
-    PyObject* second_argument = NULL;
-    int allow_8bit_chars;
+    Py_ssize_t new_allocated;
+    pysqlite_Cell* new_cells;
 
-    if (!check_cursor(self)) {
-        goto error;
+    if (batch->rows < batch->allocated) {
+        return 0;
     }
 
-    self->locked = 1;
-    self->reset = 0;
+    new_allocated = batch->allocated ? batch->allocated * 2 : 16;
+    if (new_allocated > PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(pysqlite_Cell) / (batch->numcols ? batch->numcols : 1)) {
+        return -1;
+    }
 
-    /* Make shooting yourself in the foot with not utf-8 decodable 8-bit-strings harder */
-    allow_8bit_chars = ((self->connection->text_factory != (PyObject*)&PyUnicode_Type) &&
-        (self->connection->text_factory != pysqlite_OptimizedUnicode));
+    new_cells = realloc(batch->cells, new_allocated * batch->numcols * sizeof(pysqlite_Cell));
+    if (!new_cells && batch->numcols) {
+        return -1;
+    }
 
-    Py_CLEAR(self->next_row);
+    batch->cells = new_cells;
+    batch->allocated = new_allocated;
 
-    if (multiple) {
-        /* executemany() */
-        if (!PyArg_ParseTuple(args, "OO", &operation, &second_argument)) {
-            goto error;
-        }
+    return 0;
+}
 
-        if (!PyString_Check(operation) && !PyUnicode_Check(operation)) {
+/*
+ * Copies nbytes bytes plus a terminating NUL into the staging area and stores
+ * their position in cell. Called without the GIL.
+ */
+static int _pysqlite_batch_copy_bytes(pysqlite_RowBatch* batch, pysqlite_Cell* cell,
+                                      const char* val_str, Py_ssize_t nbytes)
+{
+    Py_ssize_t needed;
+    Py_ssize_t new_allocated;
+    char* new_data;
+
+    needed = batch->nbytes + nbytes + 1;
+    if (needed > batch->data_allocated) {
+        new_allocated = batch->data_allocated ? batch->data_allocated : 1024;
+        while (new_allocated < needed) {
+            if (new_allocated > PY_SSIZE_T_MAX / 2) {
+                new_allocated = needed;
+                break;
+            }
+            new_allocated *= 2;
+        }
+
+        new_data = realloc(batch->data, new_allocated);
+        if (!new_data) {
+            return -1;
+        }
+
+        batch->data = new_data;
+        batch->data_allocated = new_allocated;
+    }
+
+    if (nbytes) {
+        memcpy(batch->data + batch->nbytes, val_str, nbytes);
+    }
+    batch->data[batch->nbytes + nbytes] = 0;
+
+    cell->offset = batch->nbytes;
+    cell->nbytes = nbytes;
+    batch->nbytes = needed;
+
+    return 0;
+}
+
+/*
+ * Copies the column values of the current row of st into the staging area.
+ * Called without the GIL; row_cast_map is only compared against Py_None.
+ *
+ * Returns 0 if the row was staged, 1 if it holds a value larger than
+ * PYSQLITE_FETCH_STAGE_LIMIT and was left out, and -1 if out of memory.
+ */
+static int _pysqlite_batch_stage_row(pysqlite_RowBatch* batch, sqlite3_stmt* st, PyObject* row_cast_map)
+{
+    int i;
+    pysqlite_Cell* cell;
+    const char* val_str;
+    Py_ssize_t nbytes;
+    Py_ssize_t staged_nbytes = batch->nbytes;
+    int staged_blobs = batch->blobs;
+
+    if (_pysqlite_batch_reserve_row(batch) != 0) {
+        return -1;
+    }
+
+    cell = batch->cells + batch->rows * batch->numcols;
+    for (i = 0; i < batch->numcols; i++, cell++) {
+        if (row_cast_map && PyList_GET_ITEM(row_cast_map, i) != Py_None) {
+            val_str = (const char*)sqlite3_column_blob(st, i);
+            if (!val_str) {
+                cell->type = SQLITE_NULL;
+                continue;
+            }
+            cell->type = SQLITE_BLOB;
+        } else {
+            cell->type = sqlite3_column_type(st, i);
+            if (cell->type == SQLITE_INTEGER) {
+                cell->intval = sqlite3_column_int64(st, i);
+                continue;
+            } else if (cell->type == SQLITE_FLOAT) {
+                cell->dblval = sqlite3_column_double(st, i);
+                continue;
+            } else if (cell->type == SQLITE_TEXT) {
+                val_str = (const char*)sqlite3_column_text(st, i);
+            } else if (cell->type == SQLITE_BLOB) {
+                val_str = (const char*)sqlite3_column_blob(st, i);
+                batch->blobs = 1;
+            } else {
+                continue;
+            }
+        }
+
+        nbytes = sqlite3_column_bytes(st, i);
+        if (nbytes > PYSQLITE_FETCH_STAGE_LIMIT) {
+            batch->nbytes = staged_nbytes;
+            batch->blobs = staged_blobs;
+            return 1;
+        }
+        if (_pysqlite_batch_copy_bytes(batch, cell, val_str, nbytes) != 0) {
+            return -1;
+        }
+    }
+
+    batch->rows++;
+
+    return 0;
+}
+
+static void pysqlite_blob_arena_dealloc(pysqlite_BlobArena* self)
+{
+    free(self->data);
+    PyObject_Del(self);
+}
+
+static Py_ssize_t pysqlite_blob_arena_getreadbuf(pysqlite_BlobArena* self, Py_ssize_t segment, void** ptrptr)
+{
+    if (segment != 0) {
+        PyErr_SetString(PyExc_SystemError, "accessing non-existent arena segment");
+        return -1;
+    }
+
+    *ptrptr = self->data;
+    return self->nbytes;
+}
+
+static Py_ssize_t pysqlite_blob_arena_getsegcount(pysqlite_BlobArena* self, Py_ssize_t* lenp)
+{
+    if (lenp) {
+        *lenp = self->nbytes;
+    }
+
+    return 1;
+}
+
+static PyBufferProcs pysqlite_blob_arena_as_buffer = {
+    (readbufferproc)pysqlite_blob_arena_getreadbuf, /* bf_getreadbuffer */
+    0,                                              /* bf_getwritebuffer */
+    (segcountproc)pysqlite_blob_arena_getsegcount,  /* bf_getsegcount */
+    0,                                              /* bf_getcharbuffer */
+};
+
+static PyTypeObject pysqlite_BlobArenaType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        MODULE_NAME ".BlobArena",                       /* tp_name */
+        sizeof(pysqlite_BlobArena),                     /* tp_basicsize */
+        0,                                              /* tp_itemsize */
+        (destructor)pysqlite_blob_arena_dealloc,        /* tp_dealloc */
+        0,                                              /* tp_print */
+        0,                                              /* tp_getattr */
+        0,                                              /* tp_setattr */
+        0,                                              /* tp_compare */
+        0,                                              /* tp_repr */
+        0,                                              /* tp_as_number */
+        0,                                              /* tp_as_sequence */
+        0,                                              /* tp_as_mapping */
+        0,                                              /* tp_hash */
+        0,                                              /* tp_call */
+        0,                                              /* tp_str */
+        0,                                              /* tp_getattro */
+        0,                                              /* tp_setattro */
+        &pysqlite_blob_arena_as_buffer,                 /* tp_as_buffer */
+        Py_TPFLAGS_DEFAULT,                             /* tp_flags */
+};
+
+/*
+ * Hands the data of the staging area over to a new arena, so that the BLOB
+ * values of the batch can refer to it instead of being copied once more.
+ */
+static PyObject* _pysqlite_batch_take_arena(pysqlite_RowBatch* batch)
+{
+    pysqlite_BlobArena* arena;
+
+    arena = PyObject_New(pysqlite_BlobArena, &pysqlite_BlobArenaType);
+    if (!arena) {
+        return NULL;
+    }
+
+    arena->data = batch->data;
+    arena->nbytes = batch->nbytes;
+
+    batch->data = NULL;
+    batch->nbytes = 0;
+    batch->data_allocated = 0;
+
+    return (PyObject*)arena;
+}
+
+/*
+ * Builds the row tuple for row number r of the staging area. If arena is
+ * not NULL, it holds the staged data, and with views set BLOB values are
+ * returned as read-only buffers into it.
+ */
+static PyObject* _pysqlite_batch_build_row(pysqlite_Cursor* self, pysqlite_RowBatch* batch,
+                                           sqlite3_stmt* st, PyObject* row_cast_map,
+                                           PyObject* arena, int views, Py_ssize_t r)
+{
+    int i;
+    PyObject* row;
+    PyObject* converted;
+    PyObject* converter;
+    pysqlite_Cell* cell;
+    sqlite3_int64 intval;
+    double dblval;
+    const char* val_str;
+    Py_ssize_t nbytes;
+
+    row = PyTuple_New(batch->numcols);
+    if (!row) {
+        return NULL;
+    }
+
+    cell = batch->cells + r * batch->numcols;
+    for (i = 0; i < batch->numcols; i++, cell++) {
+        intval = 0;
+        dblval = 0.0;
+        val_str = NULL;
+        nbytes = 0;
+
+        if (cell->type == SQLITE_INTEGER) {
+            intval = cell->intval;
+        } else if (cell->type == SQLITE_FLOAT) {
+            dblval = cell->dblval;
+        } else if (cell->type != SQLITE_NULL) {
+            val_str = (arena ? ((pysqlite_BlobArena*)arena)->data : batch->data) + cell->offset;
+            nbytes = cell->nbytes;
+        }
+
+        converter = row_cast_map ? PyList_GET_ITEM(row_cast_map, i) : Py_None;
+        if (arena && views && cell->type == SQLITE_BLOB && converter == Py_None) {
+            converted = PyBuffer_FromObject(arena, cell->offset, cell->nbytes);
+        } else {
+            converted = _pysqlite_convert_value(self, st, i, converter,
+                                                cell->type, intval, dblval, val_str, nbytes);
+        }
+        if (!converted) {
+            Py_DECREF(row);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(row, i, converted);
+    }
+
+    return row;
+}
+
+/*
+ * Applies the row factory to row. Steals the reference to row.
+ *
+ * Rows for the Row type itself are created directly instead of calling it.
+ */
+static PyObject* _pysqlite_apply_row_factory(pysqlite_Cursor* self, PyObject* row)
+{
+    PyObject* row_factory = self->connection->row_factory;
+    PyObject* result;
+
+    if (row_factory == Py_None) {
+        return row;
+    } else if (row_factory == (PyObject*)&pysqlite_RowType) {
+        return pysqlite_row_from_tuple(self, row);
+    } else if (row_factory == (PyObject*)&pysqlite_NamedRowType) {
+        return pysqlite_named_row_from_tuple(self, row);
+    }
+
+    result = PyObject_CallFunction(row_factory, "OO", self, row);
+    Py_DECREF(row);
+
+    return result;
+}
+
+/*
+ * Applies the row factory to row and appends the result to list. Steals the
+ * reference to row.
+ */
+static int _pysqlite_append_row(pysqlite_Cursor* self, PyObject* list, PyObject* row)
+{
+    PyObject* next_row;
+    int rc;
+
+    next_row = _pysqlite_apply_row_factory(self, row);
+    if (!next_row) {
+        return -1;
+    }
+
+    rc = PyList_Append(list, next_row);
+    Py_DECREF(next_row);
+
+    return rc;
+}
+
+/*
+ * Fetches up to maxrows rows, or all remaining rows if maxrows <= 0.
+ *
+ * Instead of releasing the GIL around each sqlite3_step() call, the rows are
+ * stepped through in batches of up to PYSQLITE_FETCH_BATCH rows with the GIL
+ * released once per batch. The column values are copied into a C staging area
+ * and converted to Python objects after the GIL has been reacquired. A row
+ * with a value too large to stage ends the batch and is converted directly.
+ * As with pysqlite_cursor_iternext(), the row following the last returned one
+ * is prefetched into self->next_row. The rows returned here are copies; BLOB
+ * views are only handed out by fetchone() and iteration.
+ */
+static PyObject* _pysqlite_fetch_rows(pysqlite_Cursor* self, int maxrows)
+{
+    PyObject* list;
+    PyObject* row;
+    PyObject* large_row = NULL;
+    PyObject* row_cast_map = NULL;
+    PyObject* arena = NULL;
+    pysqlite_Statement* statement = NULL;
+    pysqlite_RowBatch batch;
+    Py_ssize_t counter = 0;
+    Py_ssize_t steps_left;
+    Py_ssize_t steps;
+    Py_ssize_t r;
+    int rc = SQLITE_ROW;
+    int nomem;
+    int large;
+    int staged;
+    int prefetch;
+
+    if (!check_cursor(self)) {
+        return NULL;
+    }
+
+    if (self->reset) {
+        PyErr_SetString(pysqlite_InterfaceError, errmsg_fetch_across_rollback);
+        return NULL;
+    }
+
+    if (_pysqlite_cursor_advance(self) != 0) {
+        return NULL;
+    }
+
+    memset(&batch, 0, sizeof(batch));
+
+    list = PyList_New(0);
+    if (!list) {
+        return NULL;
+    }
+
+    if (!self->next_row) {
+        goto done;
+    }
+
+    if (self->next_row_views && self->statement) {
+        /* the statement is still on the prefetched row, which is about to
+         * be left; copy its values instead of handing out views */
+        row = _pysqlite_build_row(self, self->statement->st,
+                                  self->connection->detect_types ? self->row_cast_map : NULL,
+                                  NULL);
+        if (!row) {
+            goto error;
+        }
+        Py_DECREF(self->next_row);
+        self->next_row = row;
+    }
+    self->next_row_views = 0;
+
+    row = self->next_row;
+    self->next_row = NULL;
+    if (_pysqlite_append_row(self, list, row) != 0) {
+        goto error;
+    }
+    counter++;
+
+    statement = self->statement;
+    if (!statement) {
+        goto done;
+    }
+    Py_INCREF(statement);
+    self->moves++;
+
+    if (self->connection->detect_types && self->row_cast_map) {
+        row_cast_map = self->row_cast_map;
+        Py_INCREF(row_cast_map);
+    }
+
+    batch.numcols = sqlite3_column_count(statement->st);
+
+    /* one more step than rows to return, for the prefetched row */
+    steps_left = (maxrows > 0) ? maxrows - counter + 1 : -1;
+
+    while (rc == SQLITE_ROW && steps_left != 0) {
+        if (self->reset) {
+            PyErr_SetString(pysqlite_InterfaceError, errmsg_fetch_across_rollback);
+            goto error;
+        }
+
+        if (!pysqlite_check_connection(self->connection)) {
+            goto error;
+        }
+
+        steps = PYSQLITE_FETCH_BATCH;
+        if (steps_left > 0 && steps_left < steps) {
+            steps = steps_left;
+        }
+
+        batch.rows = 0;
+        batch.nbytes = 0;
+        batch.blobs = 0;
+        nomem = 0;
+        large = 0;
+
+        Py_BEGIN_ALLOW_THREADS
+        while (batch.rows < steps) {
+            rc = sqlite3_step(statement->st);
+            if (rc != SQLITE_ROW) {
+                break;
+            }
+            staged = _pysqlite_batch_stage_row(&batch, statement->st, row_cast_map);
+            if (staged < 0) {
+                nomem = 1;
+                break;
+            } else if (staged > 0) {
+                large = 1;
+                break;
+            }
+            if (self->blob_views && batch.nbytes >= PYSQLITE_BLOB_ARENA_SIZE) {
+                break;
+            }
+        }
+        Py_END_ALLOW_THREADS
+
+        if (nomem) {
+            PyErr_NoMemory();
+            goto error;
+        }
+
+        if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+            (void)pysqlite_statement_reset(statement);
+            _pysqlite_seterror(self->connection->db, NULL);
+            goto error;
+        }
+
+        if (steps_left > 0) {
+            steps_left -= batch.rows + large;
+        }
+
+        /* the row that wasn't staged is still the current row of the
+         * statement, so convert it before any Python code runs */
+        if (large) {
+            large_row = _pysqlite_build_row(self, statement->st, row_cast_map, NULL);
+            if (!large_row) {
+                goto error;
+            }
+        }
+
+        if (self->blob_views && batch.blobs) {
+            arena = _pysqlite_batch_take_arena(&batch);
+            if (!arena) {
+                goto error;
+            }
+        }
+
+        for (r = 0; r < batch.rows; r++) {
+            /* the prefetched row is usually returned on its own by fetchone()
+             * or iteration, so it doesn't keep the arena alive */
+            prefetch = (steps_left == 0 && !large && r == batch.rows - 1);
+            row = _pysqlite_batch_build_row(self, &batch, statement->st, row_cast_map, arena, !prefetch, r);
+            if (!row) {
+                goto error;
+            }
+
+            if (prefetch) {
+                Py_XDECREF(self->next_row);
+                self->next_row = row;
+            } else if (_pysqlite_append_row(self, list, row) != 0) {
+                goto error;
+            } else {
+                counter++;
+            }
+        }
+
+        Py_CLEAR(arena);
+
+        if (large) {
+            row = large_row;
+            large_row = NULL;
+            if (steps_left == 0) {
+                Py_XDECREF(self->next_row);
+                self->next_row = row;
+            } else if (_pysqlite_append_row(self, list, row) != 0) {
+                goto error;
+            } else {
+                counter++;
+            }
+        }
+    }
+
+done:
+    /* like pysqlite_cursor_iternext(), reset the statement once we run out of
+     * rows; there is no prefetched row exactly when stepping returned
+     * SQLITE_DONE, even if that was the step for the last requested row */
+    if (!self->next_row && self->statement) {
+        (void)pysqlite_statement_reset(self->statement);
+        Py_CLEAR(self->statement);
+    }
+
+    Py_XDECREF(statement);
+    Py_XDECREF(row_cast_map);
+    free(batch.cells);
+    free(batch.data);
+
+    return list;
+
+error:
+    Py_XDECREF(large_row);
+    Py_XDECREF(arena);
+    Py_XDECREF(statement);
+    Py_XDECREF(row_cast_map);
+    free(batch.cells);
+    free(batch.data);
+    Py_DECREF(list);
+
+    return NULL;
+}
+
+/*
+ * Checks if a cursor object is usable.
+ *
+ * 0 => error; 1 => ok
+ */
+static int check_cursor(pysqlite_Cursor* cur)
+{
+    if (!cur->initialized) {
+        PyErr_SetString(pysqlite_ProgrammingError, "Base Cursor.__init__ not called.");
+        return 0;
+    }
+
+    if (cur->closed) {
+        PyErr_SetString(pysqlite_ProgrammingError, "Cannot operate on a closed cursor.");
+        return 0;
+    }
+
+    if (cur->locked) {
+        PyErr_SetString(pysqlite_ProgrammingError, "Recursive use of cursors not allowed.");
+        return 0;
+    }
+
+    return pysqlite_check_thread(cur->connection) && pysqlite_check_connection(cur->connection);
+}
+
+/*
+ * Makes self->statement the prepared statement for operation. It is taken
+ * from the statement cache unless the cached statement is already in use.
+ *
+ * 0 => ok; -1 => error
+ */
+static int _pysqlite_cursor_prepare(pysqlite_Cursor* self, PyObject* operation)
+{
+    if (self->statement) {
+        (void)pysqlite_statement_reset(self->statement);
+        Py_DECREF(self->statement);
+    }
+
+    self->statement = (pysqlite_Statement*)pysqlite_cache_get_statement(self->connection->statement_cache, operation);
+
+    if (!self->statement) {
+        return -1;
+    }
+
+    pysqlite_statement_reset(self->statement);
+    pysqlite_statement_mark_dirty(self->statement);
+
+    return 0;
+}
+
+/*
+ * Implicitly opens a transaction before self->statement modifies the database.
+ *
+ * 0 => ok; -1 => error
+ */
+static int _pysqlite_cursor_begin(pysqlite_Cursor* self)
+{
+    PyObject* result;
+
+    /* For backwards compatibility, do not start a transaction if a DDL statement is encountered. If anybody
+     * wants transactional DDL, they can issue a BEGIN statement manually. */
+    if (self->connection->begin_statement && !sqlite3_stmt_readonly(self->statement->st) && !self->statement->is_ddl) {
+        if (sqlite3_get_autocommit(self->connection->db)) {
+            result = _pysqlite_connection_begin(self->connection);
+            if (!result) {
+                return -1;
+            }
+            Py_DECREF(result);
+        }
+    }
+
+    return 0;
+}
+
+PyObject* _pysqlite_query_execute(pysqlite_Cursor* self, int multiple, PyObject* args)
+{
+    PyObject* operation = NULL;
+    PyObject* parameters_list = NULL;
+    PyObject* parameters_iter = NULL;
+    PyObject* parameters = NULL;
+    int rc;
+    PyObject* second_argument = NULL;
+    int allow_8bit_chars;
+
+    if (!check_cursor(self)) {
+        goto error;
+    }
+
+    self->locked = 1;
+    self->reset = 0;
+
+    /* Make shooting yourself in the foot with not utf-8 decodable 8-bit-strings harder */
+    allow_8bit_chars = ((self->connection->text_factory != (PyObject*)&PyUnicode_Type) &&
+        (self->connection->text_factory != pysqlite_OptimizedUnicode));
+
+    Py_CLEAR(self->next_row);
+    self->next_row_views = 0;
+    self->step_pending = 0;
+    self->moves++;
+
+    if (multiple) {
+        /* executemany() */
+        if (!PyArg_ParseTuple(args, "OO", &operation, &second_argument)) {
+            goto error;
+        }
+
+        if (!PyString_Check(operation) && !PyUnicode_Check(operation)) {
             PyErr_SetString(PyExc_ValueError, "operation parameter must be str or unicode");
             goto error;
         }
@@ -481,86 +1467,485 @@ PyObject* _pysqlite_query_execute(pysqlite_Cursor* self, int multiple, PyObject*
         }
         Py_DECREF(second_argument);
 
-        parameters_iter = PyObject_GetIter(parameters_list);
-        if (!parameters_iter) {
-            goto error;
-        }
+        parameters_iter = PyObject_GetIter(parameters_list);
+        if (!parameters_iter) {
+            goto error;
+        }
+    }
+
+    if (self->statement != NULL) {
+        /* There is an active statement */
+        rc = pysqlite_statement_reset(self->statement);
+    }
+
+    /* reset description and rowcount */
+    Py_DECREF(self->description);
+    Py_INCREF(Py_None);
+    self->description = Py_None;
+    Py_CLEAR(self->column_map);
+    Py_CLEAR(self->named_row_type);
+    self->rowcount = 0L;
+
+    if (_pysqlite_cursor_prepare(self, operation) != 0) {
+        goto error;
+    }
+
+    if (_pysqlite_cursor_begin(self) != 0) {
+        goto error;
+    }
+
+    while (1) {
+        parameters = PyIter_Next(parameters_iter);
+        if (!parameters) {
+            break;
+        }
+
+        pysqlite_statement_mark_dirty(self->statement);
+
+        pysqlite_statement_bind_parameters(self->statement, parameters, allow_8bit_chars);
+        if (PyErr_Occurred()) {
+            goto error;
+        }
+
+        rc = pysqlite_step(self->statement->st, self->connection);
+        if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
+            if (PyErr_Occurred()) {
+                /* there was an error that occurred in a user-defined callback */
+                if (_enable_callback_tracebacks) {
+                    PyErr_Print();
+                } else {
+                    PyErr_Clear();
+                }
+            }
+            (void)pysqlite_statement_reset(self->statement);
+            _pysqlite_seterror(self->connection->db, NULL);
+            goto error;
+        }
+
+        if (pysqlite_build_row_cast_map(self) != 0) {
+            PyErr_SetString(pysqlite_OperationalError, "Error while building row_cast_map");
+            goto error;
+        }
+
+        if (rc == SQLITE_ROW || rc == SQLITE_DONE) {
+            if (self->description == Py_None && sqlite3_column_count(self->statement->st) > 0) {
+                if (_pysqlite_build_description(self) != 0) {
+                    goto error;
+                }
+            }
+        }
+
+        if (!sqlite3_stmt_readonly(self->statement->st)) {
+            self->rowcount += (long)sqlite3_changes(self->connection->db);
+        } else {
+            self->rowcount= -1;
+        }
+
+        if (!multiple) {
+            sqlite_int64 lastrowid;
+            Py_DECREF(self->lastrowid);
+            Py_BEGIN_ALLOW_THREADS
+            lastrowid = sqlite3_last_insert_rowid(self->connection->db);
+            Py_END_ALLOW_THREADS
+            self->lastrowid = _pysqlite_long_from_int64(lastrowid);
+        }
+
+        if (rc == SQLITE_ROW) {
+            if (multiple) {
+                PyErr_SetString(pysqlite_ProgrammingError, "executemany() can only execute DML statements.");
+                goto error;
+            }
+
+            self->next_row = _pysqlite_fetch_one_row(self);
+        } else if (rc == SQLITE_DONE && !multiple) {
+            pysqlite_statement_reset(self->statement);
+            Py_CLEAR(self->statement);
+        }
+
+        if (multiple) {
+            rc = pysqlite_statement_rewind(self->statement);
+        }
+        Py_XDECREF(parameters);
+    }
+
+error:
+    if (multiple && self->statement) {
+        /* the last parameters needn't be kept alive */
+        (void)pysqlite_statement_reset(self->statement);
+    }
+
+    Py_XDECREF(parameters);
+    Py_XDECREF(parameters_iter);
+    Py_XDECREF(parameters_list);
+
+    self->locked = 0;
+
+    if (PyErr_Occurred()) {
+        self->rowcount = -1L;
+        return NULL;
+    } else {
+        Py_INCREF(self);
+        return (PyObject*)self;
+    }
+}
+
+PyObject* pysqlite_cursor_execute(pysqlite_Cursor* self, PyObject* args)
+{
+    return _pysqlite_query_execute(self, 0, args);
+}
+
+PyObject* pysqlite_cursor_executemany(pysqlite_Cursor* self, PyObject* args)
+{
+    return _pysqlite_query_execute(self, 1, args);
+}
+
+/*
+ * Sets up a parameter column of executecolumns() from a sequence or from an
+ * object supporting the new buffer protocol with a numeric format.
+ *
+ * 0 => ok; -1 => error
+ */
+static int _pysqlite_param_column_init(pysqlite_ParamColumn* column, PyObject* obj, Py_ssize_t pos)
+{
+    const char* format;
+
+    if (PyString_Check(obj) || PyUnicode_Check(obj)) {
+        PyErr_Format(PyExc_TypeError, "column %zd must be a sequence or a buffer of numbers, not a string", pos);
+        return -1;
+    }
+
+    if (PyObject_CheckBuffer(obj)) {
+        if (PyObject_GetBuffer(obj, &column->view, PyBUF_FORMAT | PyBUF_STRIDES) != 0) {
+            return -1;
+        }
+        column->has_view = 1;
+
+        format = column->view.format ? column->view.format : "B";
+        if (*format == '@' || *format == '=') {
+            format++;
+        }
+
+        if (column->view.ndim != 1 || format[0] == 0 || format[1] != 0) {
+            PyErr_Format(PyExc_ValueError, "buffer of column %zd must be one-dimensional with a single item format", pos);
+            return -1;
+        }
+
+        switch (format[0]) {
+            case 'b': case 'h': case 'i': case 'l': case 'q':
+                column->kind = 'i';
+                break;
+            case 'B': case 'H': case 'I': case 'L': case 'Q': case '?':
+                column->kind = 'u';
+                break;
+            case 'f': case 'd':
+                column->kind = 'f';
+                break;
+            default:
+                column->kind = 0;
+        }
+
+        if (!column->kind
+            || (column->kind == 'f' && column->view.itemsize != sizeof(float) && column->view.itemsize != sizeof(double))
+            || (column->kind != 'f' && column->view.itemsize != 1 && column->view.itemsize != 2
+                && column->view.itemsize != 4 && column->view.itemsize != 8)) {
+            PyErr_Format(PyExc_ValueError, "unsupported buffer format '%s' in column %zd", column->view.format, pos);
+            return -1;
+        }
+
+        column->length = column->view.shape ? column->view.shape[0] : column->view.len / column->view.itemsize;
+        column->stride = column->view.strides ? column->view.strides[0] : column->view.itemsize;
+    } else {
+        column->seq = PySequence_Fast(obj, "columns must be sequences or buffers");
+        if (!column->seq) {
+            return -1;
+        }
+        column->length = PySequence_Fast_GET_SIZE(column->seq);
+
+        column->values = PyMem_New(pysqlite_Value, PYSQLITE_EXECUTE_BATCH);
+        if (!column->values) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        memset(column->values, 0, PYSQLITE_EXECUTE_BATCH * sizeof(pysqlite_Value));
+    }
+
+    return 0;
+}
+
+static void _pysqlite_param_column_clear(pysqlite_ParamColumn* column)
+{
+    Py_ssize_t i;
+
+    if (column->has_view) {
+        PyBuffer_Release(&column->view);
+        column->has_view = 0;
+    }
+
+    if (column->values) {
+        for (i = 0; i < PYSQLITE_EXECUTE_BATCH; i++) {
+            pysqlite_value_clear(&column->values[i]);
+        }
+        PyMem_Free(column->values);
+        column->values = NULL;
+    }
+
+    Py_CLEAR(column->seq);
+}
+
+/*
+ * Reads item row of a buffer column into value. Called without the GIL.
+ *
+ * 0 => ok; -1 => unsigned value too large for an SQLite INTEGER
+ */
+static int _pysqlite_param_column_read(pysqlite_ParamColumn* column, Py_ssize_t row, pysqlite_Value* value)
+{
+    const char* item = (const char*)column->view.buf + row * column->stride;
+    float f;
+    unsigned char u8;
+    unsigned short u16;
+    unsigned int u32;
+    sqlite3_uint64 u64;
+    signed char i8;
+    short i16;
+    int i32;
+
+    if (column->kind == 'f') {
+        value->type = SQLITE_FLOAT;
+        if (column->view.itemsize == sizeof(float)) {
+            memcpy(&f, item, sizeof(f));
+            value->dblval = f;
+        } else {
+            memcpy(&value->dblval, item, sizeof(double));
+        }
+        return 0;
+    }
+
+    value->type = SQLITE_INTEGER;
+    switch (column->view.itemsize) {
+        case 1:
+            if (column->kind == 'u') {
+                memcpy(&u8, item, 1);
+                value->intval = u8;
+            } else {
+                memcpy(&i8, item, 1);
+                value->intval = i8;
+            }
+            break;
+        case 2:
+            if (column->kind == 'u') {
+                memcpy(&u16, item, 2);
+                value->intval = u16;
+            } else {
+                memcpy(&i16, item, 2);
+                value->intval = i16;
+            }
+            break;
+        case 4:
+            if (column->kind == 'u') {
+                memcpy(&u32, item, 4);
+                value->intval = u32;
+            } else {
+                memcpy(&i32, item, 4);
+                value->intval = i32;
+            }
+            break;
+        default:
+            memcpy(&u64, item, 8);
+            if (column->kind == 'u' && u64 > (sqlite3_uint64)0x7FFFFFFFFFFFFFFFLL) {
+                return -1;
+            }
+            value->intval = (sqlite3_int64)u64;
+    }
+
+    return 0;
+}
+
+PyObject* pysqlite_cursor_executecolumns(pysqlite_Cursor* self, PyObject* args)
+{
+    PyObject* operation;
+    PyObject* columns_arg;
+    PyObject* columns_seq = NULL;
+    pysqlite_ParamColumn* columns = NULL;
+    pysqlite_Value value;
+    pysqlite_Value* current;
+    sqlite3_stmt* st;
+    Py_ssize_t ncolumns = 0;
+    Py_ssize_t nrows = 0;
+    Py_ssize_t start, end, row;
+    Py_ssize_t i;
+    PyObject* item;
+    PyObject* adapted;
+    int num_params_needed;
+    int allow_8bit_chars;
+    int rc = SQLITE_OK;
+    int bind_pos;
+    int overflow;
+    long changes = 0;
+
+    if (!PyArg_ParseTuple(args, "OO:executecolumns", &operation, &columns_arg)) {
+        return NULL;
     }
 
-    if (self->statement != NULL) {
-        /* There is an active statement */
-        rc = pysqlite_statement_reset(self->statement);
+    if (!check_cursor(self)) {
+        return NULL;
     }
 
-    /* reset description and rowcount */
+    if (!PyString_Check(operation) && !PyUnicode_Check(operation)) {
+        PyErr_SetString(PyExc_ValueError, "operation parameter must be str or unicode");
+        return NULL;
+    }
+
+    self->locked = 1;
+    self->reset = 0;
+
+    allow_8bit_chars = ((self->connection->text_factory != (PyObject*)&PyUnicode_Type) &&
+        (self->connection->text_factory != pysqlite_OptimizedUnicode));
+
+    Py_CLEAR(self->next_row);
+    self->next_row_views = 0;
+    self->step_pending = 0;
+    self->moves++;
+
     Py_DECREF(self->description);
     Py_INCREF(Py_None);
     self->description = Py_None;
+    Py_CLEAR(self->column_map);
+    Py_CLEAR(self->named_row_type);
     self->rowcount = 0L;
 
-    func_args = PyTuple_New(1);
-    if (!func_args) {
+    columns_seq = PySequence_Fast(columns_arg, "columns must be a sequence");
+    if (!columns_seq) {
         goto error;
     }
-    Py_INCREF(operation);
-    if (PyTuple_SetItem(func_args, 0, operation) != 0) {
+
+    ncolumns = PySequence_Fast_GET_SIZE(columns_seq);
+    columns = PyMem_New(pysqlite_ParamColumn, ncolumns ? ncolumns : 1);
+    if (!columns) {
+        PyErr_NoMemory();
         goto error;
     }
+    memset(columns, 0, (ncolumns ? ncolumns : 1) * sizeof(pysqlite_ParamColumn));
 
-    if (self->statement) {
-        (void)pysqlite_statement_reset(self->statement);
-        Py_DECREF(self->statement);
+    for (i = 0; i < ncolumns; i++) {
+        if (_pysqlite_param_column_init(&columns[i], PySequence_Fast_GET_ITEM(columns_seq, i), i) != 0) {
+            goto error;
+        }
+
+        if (i == 0) {
+            nrows = columns[i].length;
+        } else if (columns[i].length != nrows) {
+            PyErr_Format(pysqlite_ProgrammingError, "All columns must have the same length, column 0 has %zd items and column %zd has %zd.",
+                         nrows, i, columns[i].length);
+            goto error;
+        }
     }
 
-    self->statement = (pysqlite_Statement*)pysqlite_cache_get(self->connection->statement_cache, func_args);
+    if (_pysqlite_cursor_prepare(self, operation) != 0) {
+        goto error;
+    }
+    st = self->statement->st;
 
-    if (!self->statement) {
+    num_params_needed = sqlite3_bind_parameter_count(st);
+    if (num_params_needed != ncolumns) {
+        PyErr_Format(pysqlite_ProgrammingError, "Incorrect number of bindings supplied. The current statement uses %d, and there are %zd supplied.",
+                     num_params_needed, ncolumns);
         goto error;
     }
 
-    if (self->statement->in_use) {
-        Py_DECREF(self->statement);
-        self->statement = PyObject_New(pysqlite_Statement, &pysqlite_StatementType);
-        if (!self->statement) {
-            goto error;
-        }
-        rc = pysqlite_statement_create(self->statement, self->connection, operation);
-        if (rc != SQLITE_OK) {
-            Py_CLEAR(self->statement);
-            goto error;
-        }
+    if (_pysqlite_cursor_begin(self) != 0) {
+        goto error;
     }
 
-    pysqlite_statement_reset(self->statement);
-    pysqlite_statement_mark_dirty(self->statement);
+    for (start = 0; start < nrows; start = end) {
+        end = start + PYSQLITE_EXECUTE_BATCH;
+        if (end > nrows) {
+            end = nrows;
+        }
 
-    /* For backwards compatibility, do not start a transaction if a DDL statement is encountered. If anybody
-     * wants transactional DDL, they can issue a BEGIN statement manually. */
-    if (self->connection->begin_statement && !sqlite3_stmt_readonly(self->statement->st) && !self->statement->is_ddl) {
-        if (sqlite3_get_autocommit(self->connection->db)) {
-            result = _pysqlite_connection_begin(self->connection);
-            if (!result) {
-                goto error;
+        /* convert the items of sequence columns while holding the GIL */
+        for (i = 0; i < ncolumns; i++) {
+            if (!columns[i].seq) {
+                continue;
+            }
+
+            for (row = start; row < end; row++) {
+                item = PySequence_Fast_GET_ITEM(columns[i].seq, row);
+                adapted = pysqlite_statement_adapt_parameter(item);
+                if (!adapted) {
+                    goto error;
+                }
+                rc = pysqlite_value_from_object(&columns[i].values[row - start], (int)i + 1, adapted, allow_8bit_chars);
+                Py_DECREF(adapted);
+                if (rc != SQLITE_OK) {
+                    goto error;
+                }
             }
-            Py_DECREF(result);
         }
-    }
 
-    while (1) {
-        parameters = PyIter_Next(parameters_iter);
-        if (!parameters) {
-            break;
+        bind_pos = 0;
+        overflow = 0;
+
+        Py_BEGIN_ALLOW_THREADS
+        for (row = start; row < end; row++) {
+            for (i = 0; i < ncolumns; i++) {
+                if (columns[i].seq) {
+                    current = &columns[i].values[row - start];
+                } else {
+                    if (_pysqlite_param_column_read(&columns[i], row, &value) != 0) {
+                        overflow = 1;
+                        bind_pos = (int)i + 1;
+                        break;
+                    }
+                    current = &value;
+                }
+
+                rc = pysqlite_statement_bind_value(self->statement, (int)i + 1, current, SQLITE_STATIC);
+                if (rc != SQLITE_OK) {
+                    bind_pos = (int)i + 1;
+                    break;
+                }
+            }
+            if (bind_pos) {
+                break;
+            }
+
+            rc = sqlite3_step(st);
+            if (rc != SQLITE_DONE) {
+                break;
+            }
+            changes += (long)sqlite3_changes(self->connection->db);
+
+            rc = sqlite3_reset(st);
+            if (rc != SQLITE_OK) {
+                break;
+            }
         }
 
-        pysqlite_statement_mark_dirty(self->statement);
+        /* the converted values are released below, so do not leave them bound */
+        sqlite3_clear_bindings(st);
+        Py_END_ALLOW_THREADS
 
-        pysqlite_statement_bind_parameters(self->statement, parameters, allow_8bit_chars);
-        if (PyErr_Occurred()) {
-            goto error;
+        for (i = 0; i < ncolumns; i++) {
+            if (columns[i].seq) {
+                for (row = start; row < end; row++) {
+                    pysqlite_value_clear(&columns[i].values[row - start]);
+                }
+            }
         }
 
-        rc = pysqlite_step(self->statement->st, self->connection);
-        if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
+        if (overflow) {
+            PyErr_Format(PyExc_OverflowError, "value in row %zd of column %d too large to convert to SQLite INTEGER", row, bind_pos - 1);
+            goto error;
+        } else if (bind_pos) {
+            pysqlite_statement_set_bind_error(rc, bind_pos);
+            if (!PyErr_Occurred()) {
+                PyErr_Format(pysqlite_InterfaceError, "Unknown error binding parameter %d.", bind_pos - 1);
+            }
+            goto error;
+        } else if (rc == SQLITE_ROW) {
+            PyErr_SetString(pysqlite_ProgrammingError, "executecolumns() can only execute DML statements.");
+            goto error;
+        } else if (rc != SQLITE_OK) {
             if (PyErr_Occurred()) {
                 /* there was an error that occurred in a user-defined callback */
                 if (_enable_callback_tracebacks) {
@@ -573,80 +1958,31 @@ PyObject* _pysqlite_query_execute(pysqlite_Cursor* self, int multiple, PyObject*
             _pysqlite_seterror(self->connection->db, NULL);
             goto error;
         }
+    }
 
-        if (pysqlite_build_row_cast_map(self) != 0) {
-            PyErr_SetString(pysqlite_OperationalError, "Error while building row_cast_map");
-            goto error;
-        }
-
-        if (rc == SQLITE_ROW || rc == SQLITE_DONE) {
-            numcols = sqlite3_column_count(self->statement->st);
-
-            if (self->description == Py_None && numcols > 0) {
-                Py_DECREF(self->description);
-                self->description = PyTuple_New(numcols);
-                if (!self->description) {
-                    goto error;
-                }
-                for (i = 0; i < numcols; i++) {
-                    descriptor = PyTuple_New(7);
-                    if (!descriptor) {
-                        goto error;
-                    }
-                    PyTuple_SetItem(descriptor, 0, _pysqlite_build_column_name(sqlite3_column_name(self->statement->st, i)));
-                    Py_INCREF(Py_None); PyTuple_SetItem(descriptor, 1, Py_None);
-                    Py_INCREF(Py_None); PyTuple_SetItem(descriptor, 2, Py_None);
-                    Py_INCREF(Py_None); PyTuple_SetItem(descriptor, 3, Py_None);
-                    Py_INCREF(Py_None); PyTuple_SetItem(descriptor, 4, Py_None);
-                    Py_INCREF(Py_None); PyTuple_SetItem(descriptor, 5, Py_None);
-                    Py_INCREF(Py_None); PyTuple_SetItem(descriptor, 6, Py_None);
-                    PyTuple_SetItem(self->description, i, descriptor);
-                }
-            }
-        }
-
-        if (!sqlite3_stmt_readonly(self->statement->st)) {
-            self->rowcount += (long)sqlite3_changes(self->connection->db);
-        } else {
-            self->rowcount= -1;
-        }
-
-        if (!multiple) {
-            sqlite_int64 lastrowid;
-            Py_DECREF(self->lastrowid);
-            Py_BEGIN_ALLOW_THREADS
-            lastrowid = sqlite3_last_insert_rowid(self->connection->db);
-            Py_END_ALLOW_THREADS
-            self->lastrowid = _pysqlite_long_from_int64(lastrowid);
-        }
-
-        if (rc == SQLITE_ROW) {
-            if (multiple) {
-                PyErr_SetString(pysqlite_ProgrammingError, "executemany() can only execute DML statements.");
-                goto error;
-            }
+    if (!sqlite3_stmt_readonly(st)) {
+        self->rowcount = changes;
+    } else {
+        self->rowcount = -1L;
+    }
 
-            self->next_row = _pysqlite_fetch_one_row(self);
-        } else if (rc == SQLITE_DONE && !multiple) {
-            pysqlite_statement_reset(self->statement);
-            Py_CLEAR(self->statement);
-        }
+    (void)pysqlite_statement_reset(self->statement);
 
-        if (multiple) {
-            rc = pysqlite_statement_reset(self->statement);
+error:
+    if (columns) {
+        for (i = 0; i < ncolumns; i++) {
+            _pysqlite_param_column_clear(&columns[i]);
         }
-        Py_XDECREF(parameters);
+        PyMem_Free(columns);
     }
-
-error:
-    Py_XDECREF(func_args);
-    Py_XDECREF(parameters);
-    Py_XDECREF(parameters_iter);
-    Py_XDECREF(parameters_list);
+    Py_XDECREF(columns_seq);
 
     self->locked = 0;
 
     if (PyErr_Occurred()) {
+        if (self->statement) {
+            (void)pysqlite_statement_reset(self->statement);
+        }
         self->rowcount = -1L;
         return NULL;
     } else {
@@ -655,16 +1991,6 @@ error:
     }
 }
 
-PyObject* pysqlite_cursor_execute(pysqlite_Cursor* self, PyObject* args)
-{
-    return _pysqlite_query_execute(self, 0, args);
-}
-
-PyObject* pysqlite_cursor_executemany(pysqlite_Cursor* self, PyObject* args)
-{
-    return _pysqlite_query_execute(self, 1, args);
-}
-
 PyObject* pysqlite_cursor_executescript(pysqlite_Cursor* self, PyObject* args)
 {
     PyObject* script_obj;
@@ -774,6 +2100,10 @@ PyObject* pysqlite_cursor_iternext(pysqlite_Cursor *self)
         return NULL;
     }
 
+    if (_pysqlite_cursor_advance(self) != 0) {
+        return NULL;
+    }
+
     if (!self->next_row) {
          if (self->statement) {
             (void)pysqlite_statement_reset(self->statement);
@@ -785,14 +2115,15 @@ PyObject* pysqlite_cursor_iternext(pysqlite_Cursor *self)
     next_row_tuple = self->next_row;
     self->next_row = NULL;
 
-    if (self->connection->row_factory != Py_None) {
-        next_row = PyObject_CallFunction(self->connection->row_factory, "OO", self, next_row_tuple);
-        Py_DECREF(next_row_tuple);
-    } else {
-        next_row = next_row_tuple;
-    }
+    next_row = _pysqlite_apply_row_factory(self, next_row_tuple);
 
-    if (self->statement) {
+    if (self->next_row_views) {
+        /* the returned row refers to the current row of the statement, so
+         * stepping past it waits until the cursor is used again */
+        self->next_row_views = 0;
+        self->step_pending = 1;
+    } else if (self->statement) {
+        self->moves++;
         rc = pysqlite_step(self->statement->st, self->connection);
         if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
             (void)pysqlite_statement_reset(self->statement);
@@ -826,72 +2157,145 @@ PyObject* pysqlite_cursor_fetchmany(pysqlite_Cursor* self, PyObject* args, PyObj
 {
     static char *kwlist[] = {"size", NULL, NULL};
 
-    PyObject* row;
-    PyObject* list;
     int maxrows = self->arraysize;
-    int counter = 0;
 
     if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|i:fetchmany", kwlist, &maxrows)) {
         return NULL;
     }
 
-    list = PyList_New(0);
-    if (!list) {
+    return _pysqlite_fetch_rows(self, maxrows);
+}
+
+PyObject* pysqlite_cursor_fetchall(pysqlite_Cursor* self, PyObject* args)
+{
+    return _pysqlite_fetch_rows(self, 0);
+}
+
+PyObject* pysqlite_cursor_fetchcolumns(pysqlite_Cursor* self, PyObject* args, PyObject* kwargs)
+{
+    static char *kwlist[] = {"size", NULL, NULL};
+
+    int maxrows = -1;
+    int numcols;
+    int nrows = 0;
+    int failed = 0;
+    int i;
+    int rc = SQLITE_ROW;
+    sqlite3_stmt* statement;
+    PyObject* columns;
+    PyObject* name;
+    pysqlite_Column** column_array = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|i:fetchcolumns", kwlist, &maxrows)) {
         return NULL;
     }
 
-    /* just make sure we enter the loop */
-    row = Py_None;
+    if (!check_cursor(self)) {
+        return NULL;
+    }
 
-    while (row) {
-        row = pysqlite_cursor_iternext(self);
-        if (row) {
-            PyList_Append(list, row);
-            Py_DECREF(row);
-        } else {
-            break;
-        }
+    if (self->reset) {
+        PyErr_SetString(pysqlite_InterfaceError, errmsg_fetch_across_rollback);
+        return NULL;
+    }
 
-        if (++counter == maxrows) {
-            break;
+    if (_pysqlite_cursor_advance(self) != 0) {
+        return NULL;
+    }
+
+    if (!self->next_row) {
+        if (self->statement) {
+            (void)pysqlite_statement_reset(self->statement);
+            Py_CLEAR(self->statement);
         }
+        return PyList_New(0);
     }
 
-    if (PyErr_Occurred()) {
-        Py_DECREF(list);
+    statement = self->statement->st;
+    numcols = sqlite3_data_count(statement);
+
+    columns = PyList_New(numcols);
+    if (!columns) {
         return NULL;
-    } else {
-        return list;
     }
-}
 
-PyObject* pysqlite_cursor_fetchall(pysqlite_Cursor* self, PyObject* args)
-{
-    PyObject* row;
-    PyObject* list;
+    column_array = PyMem_New(pysqlite_Column*, numcols + 1);
+    if (!column_array) {
+        PyErr_NoMemory();
+        goto error;
+    }
 
-    list = PyList_New(0);
-    if (!list) {
-        return NULL;
+    for (i = 0; i < numcols; i++) {
+        name = _pysqlite_build_column_name(sqlite3_column_name(statement, i));
+        if (!name) {
+            goto error;
+        }
+        column_array[i] = pysqlite_column_new(name);
+        Py_DECREF(name);
+        if (!column_array[i]) {
+            goto error;
+        }
+        PyList_SET_ITEM(columns, i, (PyObject*)column_array[i]);
     }
 
-    /* just make sure we enter the loop */
-    row = (PyObject*)Py_None;
+    /* The statement is still positioned on the row that was prefetched into
+     * next_row, so we start there and drop the tuple. The buffers of the
+     * columns are filled using malloc(), which lets us step through all rows
+     * with the GIL released. */
+    Py_CLEAR(self->next_row);
+    self->next_row_views = 0;
+    self->moves++;
 
-    while (row) {
-        row = pysqlite_cursor_iternext(self);
-        if (row) {
-            PyList_Append(list, row);
-            Py_DECREF(row);
+    Py_BEGIN_ALLOW_THREADS
+    while (rc == SQLITE_ROW && nrows != maxrows) {
+        for (i = 0; i < numcols; i++) {
+            failed = pysqlite_column_append(column_array[i], statement, i);
+            if (failed) {
+                break;
+            }
+        }
+        if (failed) {
+            break;
         }
+        nrows++;
+        rc = sqlite3_step(statement);
     }
+    Py_END_ALLOW_THREADS
 
-    if (PyErr_Occurred()) {
-        Py_DECREF(list);
-        return NULL;
-    } else {
-        return list;
+    if (failed) {
+        (void)pysqlite_statement_reset(self->statement);
+        Py_CLEAR(self->statement);
+        if (failed == -2) {
+            PyErr_Format(pysqlite_DataError, "Column %d holds both numbers and TEXT or BLOB values.", i);
+        } else {
+            PyErr_NoMemory();
+        }
+        goto error;
     }
+
+    if (rc == SQLITE_ROW) {
+        /* size rows were fetched; keep the next one around as usual */
+        self->next_row = _pysqlite_fetch_one_row(self);
+        if (!self->next_row) {
+            goto error;
+        }
+    } else if (rc != SQLITE_DONE) {
+        (void)pysqlite_statement_reset(self->statement);
+        _pysqlite_seterror(self->connection->db, NULL);
+        goto error;
+    }
+
+    for (i = 0; i < numcols; i++) {
+        pysqlite_column_finish(column_array[i]);
+    }
+
+    PyMem_Free(column_array);
+    return columns;
+
+error:
+    PyMem_Free(column_array);
+    Py_DECREF(columns);
+    return NULL;
 }
 
 PyObject* pysqlite_noop(pysqlite_Connection* self, PyObject* args)
@@ -911,6 +2315,8 @@ PyObject* pysqlite_cursor_close(pysqlite_Cursor* self, PyObject* args)
         (void)pysqlite_statement_reset(self->statement);
         Py_CLEAR(self->statement);
     }
+    self->step_pending = 0;
+    self->moves++;
 
     self->closed = 1;
 
@@ -923,6 +2329,8 @@ static PyMethodDef cursor_methods[] = {
         PyDoc_STR("Executes a SQL statement.")},
     {"executemany", (PyCFunction)pysqlite_cursor_executemany, METH_VARARGS,
         PyDoc_STR("Repeatedly executes a SQL statement.")},
+    {"executecolumns", (PyCFunction)pysqlite_cursor_executecolumns, METH_VARARGS,
+        PyDoc_STR("Repeatedly executes a SQL statement with column-oriented parameters. Non-standard.")},
     {"executescript", (PyCFunction)pysqlite_cursor_executescript, METH_VARARGS,
         PyDoc_STR("Executes a multiple SQL statements at once. Non-standard.")},
     {"fetchone", (PyCFunction)pysqlite_cursor_fetchone, METH_NOARGS,
@@ -931,6 +2339,8 @@ static PyMethodDef cursor_methods[] = {
         PyDoc_STR("Fetches several rows from the resultset.")},
     {"fetchall", (PyCFunction)pysqlite_cursor_fetchall, METH_NOARGS,
         PyDoc_STR("Fetches all rows from the resultset.")},
+    {"fetchcolumns", (PyCFunction)pysqlite_cursor_fetchcolumns, METH_VARARGS|METH_KEYWORDS,
+        PyDoc_STR("Fetches several rows from the resultset into one typed buffer per column. Non-standard.")},
     {"close", (PyCFunction)pysqlite_cursor_close, METH_NOARGS,
         PyDoc_STR("Closes the cursor.")},
     {"setinputsizes", (PyCFunction)pysqlite_noop, METH_VARARGS,
@@ -945,6 +2355,7 @@ static struct PyMemberDef cursor_members[] =
     {"connection", T_OBJECT, offsetof(pysqlite_Cursor, connection), RO},
     {"description", T_OBJECT, offsetof(pysqlite_Cursor, description), RO},
     {"arraysize", T_INT, offsetof(pysqlite_Cursor, arraysize), 0},
+    {"blob_views", T_INT, offsetof(pysqlite_Cursor, blob_views), 0},
     {"lastrowid", T_OBJECT, offsetof(pysqlite_Cursor, lastrowid), RO},
     {"rowcount", T_LONG, offsetof(pysqlite_Cursor, rowcount), RO},
     {NULL}
@@ -998,5 +2409,11 @@ PyTypeObject pysqlite_CursorType = {
 extern int pysqlite_cursor_setup_types(void)
 {
     pysqlite_CursorType.tp_new = PyType_GenericNew;
+    if (PyType_Ready(&pysqlite_BlobArenaType) < 0) {
+        return -1;
+    }
+    if (PyType_Ready(&pysqlite_BlobViewType) < 0) {
+        return -1;
+    }
     return PyType_Ready(&pysqlite_CursorType);
 }
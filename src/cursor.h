@@ -35,6 +35,14 @@ typedef struct
     pysqlite_Connection* connection;
     PyObject* description;
     PyObject* row_cast_map;
+
+    /* the column indexes of description by case-folded name, shared by the
+     * Row objects. NULL until a Row needs it. */
+    PyObject* column_map;
+
+    /* the NamedRow subclass for description, shared like column_map */
+    PyObject* named_row_type;
+
     int arraysize;
     PyObject* lastrowid;
     long rowcount;
@@ -44,6 +52,20 @@ typedef struct
     int locked;
     int initialized;
 
+    /* return BLOBs as read-only buffers instead of copying them one by one */
+    int blob_views;
+
+    /* counts the times the statement left its current row; the BLOB views
+     * of a row can be read while it doesn't change */
+    unsigned long moves;
+
+    /* set if next_row holds BLOB views of the current row */
+    int next_row_views;
+
+    /* set if the statement wasn't stepped past the last returned row yet,
+     * because that row holds BLOB views */
+    int step_pending;
+
     /* the next row to be returned, NULL if no next row available */
     PyObject* next_row;
 
@@ -54,11 +76,13 @@ extern PyTypeObject pysqlite_CursorType;
 
 PyObject* pysqlite_cursor_execute(pysqlite_Cursor* self, PyObject* args);
 PyObject* pysqlite_cursor_executemany(pysqlite_Cursor* self, PyObject* args);
+PyObject* pysqlite_cursor_executecolumns(pysqlite_Cursor* self, PyObject* args);
 PyObject* pysqlite_cursor_getiter(pysqlite_Cursor *self);
 PyObject* pysqlite_cursor_iternext(pysqlite_Cursor *self);
 PyObject* pysqlite_cursor_fetchone(pysqlite_Cursor* self, PyObject* args);
 PyObject* pysqlite_cursor_fetchmany(pysqlite_Cursor* self, PyObject* args, PyObject* kwargs);
 PyObject* pysqlite_cursor_fetchall(pysqlite_Cursor* self, PyObject* args);
+PyObject* pysqlite_cursor_fetchcolumns(pysqlite_Cursor* self, PyObject* args, PyObject* kwargs);
 PyObject* pysqlite_noop(pysqlite_Connection* self, PyObject* args);
 PyObject* pysqlite_cursor_close(pysqlite_Cursor* self, PyObject* args);
 
@@ -29,19 +29,135 @@
 #include "cursor.h"
 #include "microprotocols.h"
 #include "prepare_protocol.h"
+#include "registry.h"
 
 
 /** the adapters registry **/
 
 PyObject *psyco_adapters;
 
+/** the adapter resolution cache **/
+
+/* What the prepare protocol finds for the type of the adapted object: the
+ * registered adapter and whether the object may have a __conform__ method.
+ * Entries are direct mapped. They don't own their type, so that classes can
+ * go away while cached; instead an entry is only valid while the type has
+ * the version tag it had when the entry was made. The version tag changes
+ * when the type is modified, and a new type at the address of a freed one
+ * gets a new tag. Static types are never freed and need no tag. Heap types
+ * without a valid tag are not cached. The cache is emptied whenever the
+ * registry changes. */
+
+#define ADAPTER_CACHE_SIZE 64
+
+typedef struct {
+    PyTypeObject *type;     /* borrowed, only compared */
+    unsigned int version_tag;
+    PyObject *adapter;      /* NULL if the registry has none */
+    int conform;            /* 0 if only the instance dict can have __conform__ */
+} pysqlite_AdapterCacheEntry;
+
+static pysqlite_AdapterCacheEntry adapter_cache[ADAPTER_CACHE_SIZE];
+static unsigned long adapter_cache_version;
+static PyObject *conform_str;
+
+static void
+_pysqlite_adapter_cache_clear(void)
+{
+    int i;
+
+    for (i = 0; i < ADAPTER_CACHE_SIZE; i++) {
+        adapter_cache[i].type = NULL;
+        Py_CLEAR(adapter_cache[i].adapter);
+    }
+}
+
+/* returns 1 if the entry made for type with version_tag is still valid */
+static int
+_pysqlite_adapter_cache_valid(PyTypeObject *type, unsigned int version_tag)
+{
+    if (!PyType_HasFeature(type, Py_TPFLAGS_HEAPTYPE)) {
+        return 1;
+    }
+
+    return PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG)
+           && type->tp_version_tag == version_tag;
+}
+
+/* Returns the cache entry for type, or fills in scratch if type can't be
+ * cached. The adapter in it is a borrowed reference. */
+static pysqlite_AdapterCacheEntry *
+_pysqlite_adapter_cache_lookup(PyTypeObject *type, pysqlite_AdapterCacheEntry *scratch)
+{
+    pysqlite_AdapterCacheEntry *entry;
+    PyObject *key, *adapter, *old_adapter;
+    int conform;
+
+    if (adapter_cache_version != pysqlite_registry_version(psyco_adapters)) {
+        _pysqlite_adapter_cache_clear();
+        adapter_cache_version = pysqlite_registry_version(psyco_adapters);
+    }
+
+    entry = &adapter_cache[((size_t)type >> 4) % ADAPTER_CACHE_SIZE];
+    if (entry->type == type && _pysqlite_adapter_cache_valid(type, entry->version_tag)) {
+        return entry;
+    }
+
+    /* looking up __conform__ on the type assigns it a version tag; objects
+     * with their own attribute lookup, like old-style instances, are always
+     * asked for the attribute */
+    conform = _PyType_Lookup(type, conform_str) != NULL
+              || type->tp_getattro != PyObject_GenericGetAttr;
+
+    key = Py_BuildValue("(OO)", (PyObject*)type, (PyObject*)&pysqlite_PrepareProtocolType);
+    if (!key) {
+        return NULL;
+    }
+    adapter = PyDict_GetItem(psyco_adapters, key);
+    Py_DECREF(key);
+
+    if (PyType_HasFeature(type, Py_TPFLAGS_HEAPTYPE)
+            && !PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG)) {
+        entry = scratch;
+        entry->adapter = adapter;
+    } else {
+        old_adapter = entry->adapter;
+        Py_XINCREF(adapter);
+        entry->adapter = adapter;
+        Py_XDECREF(old_adapter);
+    }
+    entry->type = type;
+    entry->version_tag = type->tp_version_tag;
+    entry->conform = conform;
+
+    return entry;
+}
+
+/* pysqlite_microprotocols_lookup - the registered adapter for type */
+
+PyObject *
+pysqlite_microprotocols_lookup(PyTypeObject *type)
+{
+    pysqlite_AdapterCacheEntry scratch;
+    pysqlite_AdapterCacheEntry *entry;
+
+    entry = _pysqlite_adapter_cache_lookup(type, &scratch);
+    return entry ? entry->adapter : NULL;
+}
+
 /* pysqlite_microprotocols_init - initialize the adapters dictionary */
 
 int
 pysqlite_microprotocols_init(PyObject *dict)
 {
-    /* create adapters dictionary and put it in module namespace */
-    if ((psyco_adapters = PyDict_New()) == NULL) {
+    /* create adapters registry and put it in module namespace */
+    if ((psyco_adapters = pysqlite_registry_new()) == NULL) {
+        return -1;
+    }
+    adapter_cache_version = pysqlite_registry_version(psyco_adapters);
+
+    conform_str = PyString_InternFromString("__conform__");
+    if (!conform_str) {
         return -1;
     }
 
@@ -64,7 +180,7 @@ pysqlite_microprotocols_add(PyTypeObject *type, PyObject *proto, PyObject *cast)
         return -1;
     }
 
-    rc = PyDict_SetItem(psyco_adapters, key, cast);
+    rc = PyObject_SetItem(psyco_adapters, key, cast);
     Py_DECREF(key);
 
     return rc;
@@ -75,26 +191,44 @@ pysqlite_microprotocols_add(PyTypeObject *type, PyObject *proto, PyObject *cast)
 PyObject *
 pysqlite_microprotocols_adapt(PyObject *obj, PyObject *proto, PyObject *alt)
 {
-    PyObject *adapter, *key;
+    pysqlite_AdapterCacheEntry scratch;
+    pysqlite_AdapterCacheEntry *entry;
+    PyObject *adapter, *key, *conform, **dictptr;
+    int type_conform = 1;
 
     /* we don't check for exact type conformance as specified in PEP 246
        because the pysqlite_PrepareProtocolType type is abstract and there is no
        way to get a quotable object to be its instance */
 
     /* look for an adapter in the registry */
-    key = Py_BuildValue("(OO)", (PyObject*)obj->ob_type, proto);
-    if (!key) {
-        return NULL;
+    if (proto == (PyObject*)&pysqlite_PrepareProtocolType) {
+        entry = _pysqlite_adapter_cache_lookup(obj->ob_type, &scratch);
+        if (!entry) {
+            return NULL;
+        }
+        adapter = entry->adapter;
+        type_conform = entry->conform;
+    } else {
+        key = Py_BuildValue("(OO)", (PyObject*)obj->ob_type, proto);
+        if (!key) {
+            return NULL;
+        }
+        adapter = PyDict_GetItem(psyco_adapters, key);
+        Py_DECREF(key);
     }
-    adapter = PyDict_GetItem(psyco_adapters, key);
-    Py_DECREF(key);
     if (adapter) {
-        PyObject *adapted = PyObject_CallFunctionObjArgs(adapter, obj, NULL);
+        /* the adapter may change the registry, which empties the cache */
+        PyObject *adapted;
+        Py_INCREF(adapter);
+        adapted = PyObject_CallFunctionObjArgs(adapter, obj, NULL);
+        Py_DECREF(adapter);
         return adapted;
     }
 
-    /* try to have the protocol adapt this object*/
-    if (PyObject_HasAttrString(proto, "__adapt__")) {
+    /* try to have the protocol adapt this object; the prepare protocol
+       itself is a static type without __adapt__ */
+    if (proto != (PyObject*)&pysqlite_PrepareProtocolType
+            && PyObject_HasAttrString(proto, "__adapt__")) {
         PyObject *adapted = PyObject_CallMethod(proto, "__adapt__", "O", obj);
         if (adapted) {
             if (adapted != Py_None) {
@@ -108,9 +242,21 @@ pysqlite_microprotocols_adapt(PyObject *obj, PyObject *proto, PyObject *alt)
             return NULL;
     }
 
-    /* and finally try to have the object adapt itself */
-    if (PyObject_HasAttrString(obj, "__conform__")) {
-        PyObject *adapted = PyObject_CallMethod(obj, "__conform__","O", proto);
+    /* and finally try to have the object adapt itself; if its type has no
+       __conform__, only the instance dict needs to be looked at */
+    if (type_conform) {
+        conform = PyObject_GetAttr(obj, conform_str);
+        if (!conform) {
+            PyErr_Clear();
+        }
+    } else {
+        dictptr = _PyObject_GetDictPtr(obj);
+        conform = (dictptr && *dictptr) ? PyDict_GetItem(*dictptr, conform_str) : NULL;
+        Py_XINCREF(conform);
+    }
+    if (conform) {
+        PyObject *adapted = PyObject_CallFunctionObjArgs(conform, proto, NULL);
+        Py_DECREF(conform);
         if (adapted) {
             if (adapted != Py_None) {
                 return adapted;
@@ -47,6 +47,11 @@ extern int pysqlite_microprotocols_add(
 extern PyObject *pysqlite_microprotocols_adapt(
     PyObject *obj, PyObject *proto, PyObject *alt);
 
+/* returns the adapter registered for type and the prepare protocol as a
+   borrowed reference, or NULL if there is none. Cached per type and type
+   version, without keeping the type alive. */
+extern PyObject *pysqlite_microprotocols_lookup(PyTypeObject *type);
+
 extern PyObject *
     pysqlite_adapt(pysqlite_Cursor* self, PyObject *args);   
 #define pysqlite_adapt_doc \
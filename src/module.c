@@ -24,6 +24,12 @@
 #include "connection.h"
 #include "statement.h"
 #include "cursor.h"
+#include "column.h"
+#include "registry.h"
+#include "converters.h"
+#include "adapters.h"
+#include "blob.h"
+#include "pool.h"
 #include "cache.h"
 #include "prepare_protocol.h"
 #include "microprotocols.h"
@@ -52,7 +58,7 @@ static PyObject* module_connect(PyObject* self, PyObject* args, PyObject*
      * C-level, so this code is redundant with the one in connection_init in
      * connection.c and must always be copied from there ... */
 
-    static char *kwlist[] = {"database", "timeout", "detect_types", "isolation_level", "check_same_thread", "factory", "cached_statements", "flags", NULL, NULL};
+    static char *kwlist[] = {"database", "timeout", "detect_types", "isolation_level", "check_same_thread", "factory", "cached_statements", "flags", "cache_policy", "prepare", NULL, NULL};
     PyObject* database;
     int detect_types = 0;
     PyObject* isolation_level;
@@ -61,11 +67,13 @@ static PyObject* module_connect(PyObject* self, PyObject* args, PyObject*
     int cached_statements;
     double timeout = 5.0;
     int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+    const char* cache_policy = "lfu";
+    PyObject* prepare;
 
     PyObject* result;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|diOiOii", kwlist,
-                                     &database, &timeout, &detect_types, &isolation_level, &check_same_thread, &factory, &cached_statements, &flags))
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|diOiOiisO", kwlist,
+                                     &database, &timeout, &detect_types, &isolation_level, &check_same_thread, &factory, &cached_statements, &flags, &cache_policy, &prepare))
     {
         return NULL; 
     }
@@ -168,7 +176,18 @@ static PyObject* module_register_adapter(PyObject* self, PyObject* args)
         pysqlite_BaseTypeAdapted = 1;
     }
 
+    /* a string selects one of the adapters implemented in C */
+    if (PyString_Check(caster)) {
+        caster = pysqlite_native_adapter_get(PyString_AS_STRING(caster));
+        if (!caster) {
+            return NULL;
+        }
+    } else {
+        Py_INCREF(caster);
+    }
+
     rc = pysqlite_microprotocols_add(type, (PyObject*)&pysqlite_PrepareProtocolType, caster);
+    Py_DECREF(caster);
     if (rc == -1)
         return NULL;
 
@@ -179,7 +198,9 @@ static PyObject* module_register_adapter(PyObject* self, PyObject* args)
 PyDoc_STRVAR(module_register_adapter_doc,
 "register_adapter(type, callable)\n\
 \n\
-Registers an adapter with pysqlite's adapter registry. Non-standard.");
+Registers an adapter with pysqlite's adapter registry. callable can also be\n\
+the name of a native adapter: 'date', 'timestamp', 'decimal' or 'uuid'.\n\
+Non-standard.");
 
 static PyObject* module_register_converter(PyObject* self, PyObject* args)
 {
@@ -196,13 +217,23 @@ static PyObject* module_register_converter(PyObject* self, PyObject* args)
         return NULL;
     }
 
+    /* a string selects one of the converters implemented in C */
+    if (PyString_Check(callable)) {
+        callable = pysqlite_native_converter_get(PyString_AS_STRING(callable));
+        if (!callable) {
+            return NULL;
+        }
+    } else {
+        Py_INCREF(callable);
+    }
+
     /* convert the name to upper case */
     name = PyObject_CallMethod(orig_name, "upper", "");
     if (!name) {
         goto error;
     }
 
-    if (PyDict_SetItem(converters, name, callable) != 0) {
+    if (PyObject_SetItem(converters, name, callable) != 0) {
         goto error;
     }
 
@@ -210,13 +241,16 @@ static PyObject* module_register_converter(PyObject* self, PyObject* args)
     retval = Py_None;
 error:
     Py_XDECREF(name);
+    Py_DECREF(callable);
     return retval;
 }
 
 PyDoc_STRVAR(module_register_converter_doc,
 "register_converter(typename, callable)\n\
 \n\
-Registers a converter with pysqlite. Non-standard.");
+Registers a converter with pysqlite. Instead of a callable, the name of a\n\
+converter implemented in C can be given: 'date', 'timestamp', 'boolean',\n\
+'decimal' or 'json'. Non-standard.");
 
 static PyObject* enable_callback_tracebacks(PyObject* self, PyObject* args)
 {
@@ -235,7 +269,7 @@ Enable or disable callback functions throwing errors to stderr.");
 
 static void converters_init(PyObject* dict)
 {
-    converters = PyDict_New();
+    converters = pysqlite_registry_new();
     if (!converters) {
         return;
     }
@@ -290,7 +324,13 @@ PyMODINIT_FUNC init_sqlite(void)
     if (!module ||
         (pysqlite_row_setup_types() < 0) ||
         (pysqlite_cursor_setup_types() < 0) ||
+        (pysqlite_column_setup_types() < 0) ||
+        (pysqlite_registry_setup_types() < 0) ||
+        (pysqlite_converters_setup_types() < 0) ||
+        (pysqlite_adapters_setup_types() < 0) ||
+        (pysqlite_blob_setup_types() < 0) ||
         (pysqlite_connection_setup_types() < 0) ||
+        (pysqlite_pool_setup_types() < 0) ||
         (pysqlite_cache_setup_types() < 0) ||
         (pysqlite_statement_setup_types() < 0) ||
         #ifdef PYSQLITE_EXPERIMENTAL
@@ -303,6 +343,8 @@ PyMODINIT_FUNC init_sqlite(void)
 
     Py_INCREF(&pysqlite_ConnectionType);
     PyModule_AddObject(module, "Connection", (PyObject*) &pysqlite_ConnectionType);
+    Py_INCREF(&pysqlite_ConnectionPoolType);
+    PyModule_AddObject(module, "ConnectionPool", (PyObject*) &pysqlite_ConnectionPoolType);
     Py_INCREF(&pysqlite_CursorType);
     PyModule_AddObject(module, "Cursor", (PyObject*) &pysqlite_CursorType);
     Py_INCREF(&pysqlite_CacheType);
@@ -313,6 +355,10 @@ PyMODINIT_FUNC init_sqlite(void)
     PyModule_AddObject(module, "PrepareProtocol", (PyObject*) &pysqlite_PrepareProtocolType);
     Py_INCREF(&pysqlite_RowType);
     PyModule_AddObject(module, "Row", (PyObject*) &pysqlite_RowType);
+    Py_INCREF(&pysqlite_NamedRowType);
+    PyModule_AddObject(module, "NamedRow", (PyObject*) &pysqlite_NamedRowType);
+    Py_INCREF(&pysqlite_ColumnType);
+    PyModule_AddObject(module, "Column", (PyObject*) &pysqlite_ColumnType);
 
     if (!(dict = PyModule_GetDict(module))) {
         goto error;
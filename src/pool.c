@@ -0,0 +1,503 @@
+/* pool.c - a pool of reusable connections
+ *
+ * Copyright (C) 2016 Gerhard Hring <gh@ghaering.de>
+ *
+ * This file is part of pysqlite.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "pool.h"
+#include "module.h"
+#include "pythread.h"
+
+static int pysqlite_pool_init(pysqlite_ConnectionPool* self, PyObject* args, PyObject* kwargs)
+{
+    /* the arguments of connect(), which are checked and passed on to the
+     * factory the same way; see module_connect() in module.c */
+    static char *kwlist[] = {"database", "timeout", "detect_types", "isolation_level", "check_same_thread", "factory", "cached_statements", "flags", "cache_policy", "prepare", NULL, NULL};
+    PyObject* database;
+    int detect_types;
+    PyObject* isolation_level;
+    PyObject* factory = NULL;
+    int check_same_thread;
+    int cached_statements;
+    double timeout;
+    int flags;
+    const char* cache_policy;
+    PyObject* prepare;
+
+    PyObject* connect_kwargs;
+    PyObject* value;
+    double idle_timeout = -1.0;
+    long maxsize = 5;
+
+    if (self->idle) {
+        PyErr_SetString(pysqlite_ProgrammingError, "ConnectionPool.__init__ must only be called once.");
+        return -1;
+    }
+
+    connect_kwargs = kwargs ? PyDict_Copy(kwargs) : PyDict_New();
+    if (!connect_kwargs) {
+        return -1;
+    }
+
+    /* take out the pool's own arguments; the others are passed on to the
+     * connection factory like for connect() */
+    value = PyDict_GetItemString(connect_kwargs, "maxsize");
+    if (value) {
+        maxsize = PyInt_AsLong(value);
+        if (maxsize == -1 && PyErr_Occurred()) {
+            goto error;
+        }
+        if (PyDict_DelItemString(connect_kwargs, "maxsize") != 0) {
+            goto error;
+        }
+    }
+    if (maxsize < 1 || maxsize > INT_MAX) {
+        PyErr_SetString(PyExc_ValueError, "maxsize must be a positive integer");
+        goto error;
+    }
+
+    value = PyDict_GetItemString(connect_kwargs, "idle_timeout");
+    if (value) {
+        if (value != Py_None) {
+            idle_timeout = PyFloat_AsDouble(value);
+            if (idle_timeout == -1.0 && PyErr_Occurred()) {
+                goto error;
+            }
+            if (idle_timeout < 0.0) {
+                PyErr_SetString(PyExc_ValueError, "idle_timeout must not be negative");
+                goto error;
+            }
+        }
+        if (PyDict_DelItemString(connect_kwargs, "idle_timeout") != 0) {
+            goto error;
+        }
+    }
+
+    if (!PyArg_ParseTupleAndKeywords(args, connect_kwargs, "O|diOiOiisO:ConnectionPool", kwlist,
+                                     &database, &timeout, &detect_types, &isolation_level, &check_same_thread, &factory, &cached_statements, &flags, &cache_policy, &prepare))
+    {
+        goto error;
+    }
+
+    if (factory == NULL) {
+        factory = (PyObject*)&pysqlite_ConnectionType;
+    }
+
+    self->acquired = PySet_New(NULL);
+    if (!self->acquired) {
+        goto error;
+    }
+
+    self->idle = PyMem_New(pysqlite_PoolEntry, maxsize);
+    if (!self->idle) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    self->idle_count = 0;
+
+    Py_INCREF(factory);
+    self->factory = factory;
+    Py_INCREF(args);
+    self->connect_args = args;
+    self->connect_kwargs = connect_kwargs;
+
+    self->maxsize = (int)maxsize;
+    self->idle_timeout = idle_timeout;
+    self->size = 0;
+    self->closed = 0;
+
+    return 0;
+
+error:
+    Py_DECREF(connect_kwargs);
+    return -1;
+}
+
+/* returns 1 if an idle connection can be handed out: it is open, and the
+ * application hasn't used it since it was released to start a transaction or
+ * leave a statement running */
+static int _pysqlite_pool_usable(pysqlite_Connection* connection)
+{
+    if (!connection->db || !sqlite3_get_autocommit(connection->db)) {
+        return 0;
+    }
+
+#if SQLITE_VERSION_NUMBER >= 3007010
+    {
+        sqlite3_stmt* statement;
+
+        for (statement = sqlite3_next_stmt(connection->db, NULL); statement;
+                statement = sqlite3_next_stmt(connection->db, statement)) {
+            if (sqlite3_stmt_busy(statement)) {
+                return 0;
+            }
+        }
+    }
+#endif
+
+    return 1;
+}
+
+/* closes a connection that was taken out of the pool, ignoring errors */
+static void _pysqlite_pool_close_connection(pysqlite_Connection* connection)
+{
+    PyObject* result;
+
+    /* whichever thread finds the connection no longer needed closes it */
+    connection->thread_ident = PyThread_get_thread_ident();
+
+    result = pysqlite_connection_close(connection, NULL);
+    if (result) {
+        Py_DECREF(result);
+    } else {
+        PyErr_Clear();
+    }
+    Py_DECREF(connection);
+}
+
+/* takes the idle connection at index out of the list */
+static pysqlite_Connection* _pysqlite_pool_take(pysqlite_ConnectionPool* self, int index)
+{
+    pysqlite_Connection* connection;
+    int i;
+
+    connection = self->idle[index].connection;
+    self->idle_count--;
+    for (i = index; i < self->idle_count; i++) {
+        self->idle[i] = self->idle[i + 1];
+    }
+
+    return connection;
+}
+
+/* closes the connections that have been idle for longer than idle_timeout */
+static void _pysqlite_pool_evict(pysqlite_ConnectionPool* self)
+{
+    time_t now;
+
+    if (self->idle_timeout < 0.0) {
+        return;
+    }
+
+    now = time(NULL);
+
+    /* the oldest entries are at the front. Closing a connection releases the
+     * GIL, so each one is taken out of the list before it is closed. */
+    while (self->idle_count > 0 && difftime(now, self->idle[0].released) >= self->idle_timeout) {
+        self->size--;
+        _pysqlite_pool_close_connection(_pysqlite_pool_take(self, 0));
+    }
+}
+
+/*
+ * Checks if the pool is usable.
+ *
+ * 0 => error; 1 => ok
+ */
+static int check_pool(pysqlite_ConnectionPool* self)
+{
+    if (!self->idle) {
+        PyErr_SetString(pysqlite_ProgrammingError, "Base ConnectionPool.__init__ not called.");
+        return 0;
+    }
+
+    if (self->closed) {
+        PyErr_SetString(pysqlite_ProgrammingError, "Cannot operate on a closed connection pool.");
+        return 0;
+    }
+
+    return 1;
+}
+
+static PyObject* pysqlite_pool_acquire(pysqlite_ConnectionPool* self, PyObject* args)
+{
+    pysqlite_Connection* connection = NULL;
+    long thread_ident;
+    int i;
+
+    if (!check_pool(self)) {
+        return NULL;
+    }
+
+    _pysqlite_pool_evict(self);
+
+    thread_ident = PyThread_get_thread_ident();
+
+    while (!connection && self->idle_count > 0) {
+        /* prefer the connection this thread released last, otherwise take
+         * the most recently released one */
+        for (i = self->idle_count - 1; i > 0; i--) {
+            if (self->idle[i].thread_ident == thread_ident) {
+                break;
+            }
+        }
+        if (self->idle[i].thread_ident != thread_ident) {
+            i = self->idle_count - 1;
+        }
+
+        connection = _pysqlite_pool_take(self, i);
+
+        if (!_pysqlite_pool_usable(connection)) {
+            /* the application closed or used it after releasing it */
+            self->size--;
+            _pysqlite_pool_close_connection(connection);
+            connection = NULL;
+        }
+    }
+
+    if (!connection) {
+        if (self->size >= self->maxsize) {
+            PyErr_Format(pysqlite_OperationalError, "All %d connections of the pool are in use.", self->maxsize);
+            return NULL;
+        }
+
+        /* count the connection before opening it, as other threads can run
+         * while the database is opened */
+        self->size++;
+        connection = (pysqlite_Connection*)PyObject_Call(self->factory, self->connect_args, self->connect_kwargs);
+        if (!connection) {
+            self->size--;
+            return NULL;
+        }
+        if (!PyObject_TypeCheck((PyObject*)connection, &pysqlite_ConnectionType)) {
+            self->size--;
+            Py_DECREF(connection);
+            PyErr_SetString(PyExc_TypeError, "factory must return a Connection");
+            return NULL;
+        }
+    }
+
+    if (PySet_Add(self->acquired, (PyObject*)connection) != 0) {
+        self->size--;
+        _pysqlite_pool_close_connection(connection);
+        return NULL;
+    }
+
+    /* the connection belongs to the acquiring thread until it is released */
+    connection->thread_ident = thread_ident;
+
+    return (PyObject*)connection;
+}
+
+static PyObject* pysqlite_pool_release(pysqlite_ConnectionPool* self, PyObject* args)
+{
+    pysqlite_Connection* connection;
+    PyObject* result;
+    PyObject* exc_type;
+    PyObject* exc_value;
+    PyObject* exc_tb;
+    int rc;
+
+    if (!PyArg_ParseTuple(args, "O!:release", &pysqlite_ConnectionType, &connection)) {
+        return NULL;
+    }
+
+    if (!self->idle) {
+        PyErr_SetString(pysqlite_ProgrammingError, "Base ConnectionPool.__init__ not called.");
+        return NULL;
+    }
+
+    if (!pysqlite_check_thread(connection)) {
+        return NULL;
+    }
+
+    /* the reference of the acquired set is taken over */
+    Py_INCREF(connection);
+    rc = PySet_Discard(self->acquired, (PyObject*)connection);
+    if (rc <= 0) {
+        Py_DECREF(connection);
+        if (rc == 0) {
+            PyErr_SetString(pysqlite_ProgrammingError, "The connection was not acquired from this pool.");
+        }
+        return NULL;
+    }
+
+    if (connection->db && !sqlite3_get_autocommit(connection->db)) {
+        /* don't hand an open transaction to the next user */
+        result = pysqlite_connection_rollback(connection, NULL);
+        if (!result) {
+            /* the connection has left the pool, so it is closed instead of
+             * being left open with the transaction */
+            self->size--;
+            PyErr_Fetch(&exc_type, &exc_value, &exc_tb);
+            _pysqlite_pool_close_connection(connection);
+            PyErr_Restore(exc_type, exc_value, exc_tb);
+            return NULL;
+        }
+        Py_DECREF(result);
+    }
+
+    if (self->closed || !connection->db) {
+        self->size--;
+        _pysqlite_pool_close_connection(connection);
+    } else {
+        /* make room among the idle connections before adding this one */
+        _pysqlite_pool_evict(self);
+
+        self->idle[self->idle_count].connection = connection;
+        self->idle[self->idle_count].thread_ident = PyThread_get_thread_ident();
+        self->idle[self->idle_count].released = time(NULL);
+        self->idle_count++;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* pysqlite_pool_evict(pysqlite_ConnectionPool* self, PyObject* args)
+{
+    if (!check_pool(self)) {
+        return NULL;
+    }
+
+    _pysqlite_pool_evict(self);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* pysqlite_pool_close(pysqlite_ConnectionPool* self, PyObject* args)
+{
+    if (!self->idle) {
+        PyErr_SetString(pysqlite_ProgrammingError, "Base ConnectionPool.__init__ not called.");
+        return NULL;
+    }
+
+    self->closed = 1;
+
+    /* acquired connections are closed when they are released */
+    while (self->idle_count > 0) {
+        self->size--;
+        _pysqlite_pool_close_connection(_pysqlite_pool_take(self, self->idle_count - 1));
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static void pysqlite_pool_dealloc(pysqlite_ConnectionPool* self)
+{
+    int i;
+
+    if (self->idle) {
+        for (i = 0; i < self->idle_count; i++) {
+            Py_DECREF(self->idle[i].connection);
+        }
+        PyMem_Free(self->idle);
+    }
+
+    Py_XDECREF(self->factory);
+    Py_XDECREF(self->connect_args);
+    Py_XDECREF(self->connect_kwargs);
+    Py_XDECREF(self->acquired);
+
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* pysqlite_pool_get_idle(pysqlite_ConnectionPool* self, void* unused)
+{
+    return PyInt_FromLong(self->idle_count);
+}
+
+static PyObject* pysqlite_pool_get_idle_timeout(pysqlite_ConnectionPool* self, void* unused)
+{
+    if (self->idle_timeout < 0.0) {
+        Py_INCREF(Py_None);
+        return Py_None;
+    }
+
+    return PyFloat_FromDouble(self->idle_timeout);
+}
+
+static PyMethodDef pool_methods[] = {
+    {"acquire", (PyCFunction)pysqlite_pool_acquire, METH_NOARGS,
+        PyDoc_STR("Returns an idle connection, or opens a new one.")},
+    {"release", (PyCFunction)pysqlite_pool_release, METH_VARARGS,
+        PyDoc_STR("Gives a connection back to the pool.")},
+    {"evict", (PyCFunction)pysqlite_pool_evict, METH_NOARGS,
+        PyDoc_STR("Closes the connections that have been idle for idle_timeout seconds or more.")},
+    {"close", (PyCFunction)pysqlite_pool_close, METH_NOARGS,
+        PyDoc_STR("Closes the idle connections, and the others once they are released.")},
+    {NULL, NULL}
+};
+
+static struct PyMemberDef pool_members[] =
+{
+    {"maxsize", T_INT, offsetof(pysqlite_ConnectionPool, maxsize), RO},
+    {"size", T_INT, offsetof(pysqlite_ConnectionPool, size), RO},
+    {NULL}
+};
+
+static PyGetSetDef pool_getset[] = {
+    {"idle", (getter)pysqlite_pool_get_idle, (setter)0},
+    {"idle_timeout", (getter)pysqlite_pool_get_idle_timeout, (setter)0},
+    {NULL}
+};
+
+static char pool_doc[] =
+PyDoc_STR("A pool of connections to the same database.");
+
+PyTypeObject pysqlite_ConnectionPoolType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        MODULE_NAME ".ConnectionPool",                  /* tp_name */
+        sizeof(pysqlite_ConnectionPool),                /* tp_basicsize */
+        0,                                              /* tp_itemsize */
+        (destructor)pysqlite_pool_dealloc,              /* tp_dealloc */
+        0,                                              /* tp_print */
+        0,                                              /* tp_getattr */
+        0,                                              /* tp_setattr */
+        0,                                              /* tp_compare */
+        0,                                              /* tp_repr */
+        0,                                              /* tp_as_number */
+        0,                                              /* tp_as_sequence */
+        0,                                              /* tp_as_mapping */
+        0,                                              /* tp_hash */
+        0,                                              /* tp_call */
+        0,                                              /* tp_str */
+        0,                                              /* tp_getattro */
+        0,                                              /* tp_setattro */
+        0,                                              /* tp_as_buffer */
+        Py_TPFLAGS_DEFAULT|Py_TPFLAGS_BASETYPE,         /* tp_flags */
+        pool_doc,                                       /* tp_doc */
+        0,                                              /* tp_traverse */
+        0,                                              /* tp_clear */
+        0,                                              /* tp_richcompare */
+        0,                                              /* tp_weaklistoffset */
+        0,                                              /* tp_iter */
+        0,                                              /* tp_iternext */
+        pool_methods,                                   /* tp_methods */
+        pool_members,                                   /* tp_members */
+        pool_getset,                                    /* tp_getset */
+        0,                                              /* tp_base */
+        0,                                              /* tp_dict */
+        0,                                              /* tp_descr_get */
+        0,                                              /* tp_descr_set */
+        0,                                              /* tp_dictoffset */
+        (initproc)pysqlite_pool_init,                   /* tp_init */
+        0,                                              /* tp_alloc */
+        0,                                              /* tp_new */
+        0                                               /* tp_free */
+};
+
+extern int pysqlite_pool_setup_types(void)
+{
+    pysqlite_ConnectionPoolType.tp_new = PyType_GenericNew;
+    return PyType_Ready(&pysqlite_ConnectionPoolType);
+}
@@ -0,0 +1,74 @@
+/* pool.h - a pool of reusable connections
+ *
+ * Copyright (C) 2016 Gerhard Hring <gh@ghaering.de>
+ *
+ * This file is part of pysqlite.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PYSQLITE_POOL_H
+#define PYSQLITE_POOL_H
+#include "Python.h"
+
+#include <time.h>
+
+#include "connection.h"
+
+/* an idle connection, waiting to be handed out again */
+typedef struct
+{
+    pysqlite_Connection* connection;
+
+    /* the thread that released the connection */
+    long thread_ident;
+    time_t released;
+} pysqlite_PoolEntry;
+
+typedef struct
+{
+    PyObject_HEAD
+
+    /* the arguments for creating new connections, like for connect() */
+    PyObject* factory;
+    PyObject* connect_args;
+    PyObject* connect_kwargs;
+
+    int maxsize;
+
+    /* idle connections are closed after this many seconds; negative to keep
+     * them open */
+    double idle_timeout;
+
+    /* the idle connections, the most recently released one last */
+    pysqlite_PoolEntry* idle;
+    int idle_count;
+
+    /* the connections handed out by acquire() */
+    PyObject* acquired;
+
+    /* the number of open connections, idle, acquired or being opened */
+    int size;
+
+    int closed;
+} pysqlite_ConnectionPool;
+
+extern PyTypeObject pysqlite_ConnectionPoolType;
+
+int pysqlite_pool_setup_types(void);
+
+#endif
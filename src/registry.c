@@ -0,0 +1,175 @@
+/* registry.c - a dict that counts its modifications
+ *
+ * Copyright (C) 2016 Gerhard Hring <gh@ghaering.de>
+ *
+ * This file is part of pysqlite.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "registry.h"
+#include "module.h"
+#include "structmember.h"
+
+PyObject* pysqlite_registry_new(void)
+{
+    return PyObject_CallObject((PyObject*)&pysqlite_RegistryType, NULL);
+}
+
+/* Item assignment and deletion come through here, but dict.__setitem__() and
+ * dict.__delitem__() called on the registry reach the dict slot directly and
+ * don't bump the version; the registry has to be modified through its own
+ * methods. */
+static int pysqlite_registry_ass_subscript(pysqlite_Registry* self, PyObject* key, PyObject* value)
+{
+    self->version++;
+    return PyDict_Type.tp_as_mapping->mp_ass_subscript((PyObject*)self, key, value);
+}
+
+/* calls the dict method name on self, for the methods that modify the dict
+ * without going through mp_ass_subscript */
+static PyObject* pysqlite_registry_call_dict_method(pysqlite_Registry* self, const char* name, PyObject* args, PyObject* kwargs)
+{
+    PyObject* method;
+    PyObject* method_args;
+    PyObject* result;
+    Py_ssize_t i;
+
+    self->version++;
+
+    method = PyObject_GetAttrString((PyObject*)&PyDict_Type, name);
+    if (!method) {
+        return NULL;
+    }
+
+    method_args = PyTuple_New(PyTuple_GET_SIZE(args) + 1);
+    if (!method_args) {
+        Py_DECREF(method);
+        return NULL;
+    }
+    Py_INCREF(self);
+    PyTuple_SET_ITEM(method_args, 0, (PyObject*)self);
+    for (i = 0; i < PyTuple_GET_SIZE(args); i++) {
+        Py_INCREF(PyTuple_GET_ITEM(args, i));
+        PyTuple_SET_ITEM(method_args, i + 1, PyTuple_GET_ITEM(args, i));
+    }
+
+    result = PyObject_Call(method, method_args, kwargs);
+    Py_DECREF(method_args);
+    Py_DECREF(method);
+
+    return result;
+}
+
+static PyObject* pysqlite_registry_clear(pysqlite_Registry* self, PyObject* args, PyObject* kwargs)
+{
+    return pysqlite_registry_call_dict_method(self, "clear", args, kwargs);
+}
+
+static PyObject* pysqlite_registry_pop(pysqlite_Registry* self, PyObject* args, PyObject* kwargs)
+{
+    return pysqlite_registry_call_dict_method(self, "pop", args, kwargs);
+}
+
+static PyObject* pysqlite_registry_popitem(pysqlite_Registry* self, PyObject* args, PyObject* kwargs)
+{
+    return pysqlite_registry_call_dict_method(self, "popitem", args, kwargs);
+}
+
+static PyObject* pysqlite_registry_setdefault(pysqlite_Registry* self, PyObject* args, PyObject* kwargs)
+{
+    return pysqlite_registry_call_dict_method(self, "setdefault", args, kwargs);
+}
+
+static PyObject* pysqlite_registry_update(pysqlite_Registry* self, PyObject* args, PyObject* kwargs)
+{
+    return pysqlite_registry_call_dict_method(self, "update", args, kwargs);
+}
+
+static PyMethodDef registry_methods[] = {
+    {"clear", (PyCFunction)pysqlite_registry_clear, METH_VARARGS|METH_KEYWORDS,
+        PyDoc_STR("D.clear() -> None.  Remove all items from D.")},
+    {"pop", (PyCFunction)pysqlite_registry_pop, METH_VARARGS|METH_KEYWORDS,
+        PyDoc_STR("D.pop(k[,d]) -> v, remove specified key and return the corresponding value.")},
+    {"popitem", (PyCFunction)pysqlite_registry_popitem, METH_VARARGS|METH_KEYWORDS,
+        PyDoc_STR("D.popitem() -> (k, v), remove and return some (key, value) pair as a 2-tuple.")},
+    {"setdefault", (PyCFunction)pysqlite_registry_setdefault, METH_VARARGS|METH_KEYWORDS,
+        PyDoc_STR("D.setdefault(k[,d]) -> D.get(k,d), also set D[k]=d if k not in D.")},
+    {"update", (PyCFunction)pysqlite_registry_update, METH_VARARGS|METH_KEYWORDS,
+        PyDoc_STR("D.update([E, ]**F) -> None.  Update D from dict/iterable E and F.")},
+    {NULL, NULL}
+};
+
+static struct PyMemberDef registry_members[] =
+{
+    {"version", T_ULONG, offsetof(pysqlite_Registry, version), RO},
+    {NULL}
+};
+
+static PyMappingMethods registry_as_mapping = {
+    0,                                              /* mp_length */
+    0,                                              /* mp_subscript */
+    (objobjargproc)pysqlite_registry_ass_subscript, /* mp_ass_subscript */
+};
+
+PyTypeObject pysqlite_RegistryType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        MODULE_NAME ".Registry",                        /* tp_name */
+        sizeof(pysqlite_Registry),                      /* tp_basicsize */
+        0,                                              /* tp_itemsize */
+        0,                                              /* tp_dealloc */
+        0,                                              /* tp_print */
+        0,                                              /* tp_getattr */
+        0,                                              /* tp_setattr */
+        0,                                              /* tp_compare */
+        0,                                              /* tp_repr */
+        0,                                              /* tp_as_number */
+        0,                                              /* tp_as_sequence */
+        &registry_as_mapping,                           /* tp_as_mapping */
+        0,                                              /* tp_hash */
+        0,                                              /* tp_call */
+        0,                                              /* tp_str */
+        0,                                              /* tp_getattro */
+        0,                                              /* tp_setattro */
+        0,                                              /* tp_as_buffer */
+        Py_TPFLAGS_DEFAULT|Py_TPFLAGS_BASETYPE,         /* tp_flags */
+        0,                                              /* tp_doc */
+        0,                                              /* tp_traverse */
+        0,                                              /* tp_clear */
+        0,                                              /* tp_richcompare */
+        0,                                              /* tp_weaklistoffset */
+        0,                                              /* tp_iter */
+        0,                                              /* tp_iternext */
+        registry_methods,                               /* tp_methods */
+        registry_members,                               /* tp_members */
+        0,                                              /* tp_getset */
+        0,                                              /* tp_base */
+        0,                                              /* tp_dict */
+        0,                                              /* tp_descr_get */
+        0,                                              /* tp_descr_set */
+        0,                                              /* tp_dictoffset */
+        0,                                              /* tp_init */
+        0,                                              /* tp_alloc */
+        0,                                              /* tp_new */
+        0                                               /* tp_free */
+};
+
+extern int pysqlite_registry_setup_types(void)
+{
+    pysqlite_RegistryType.tp_base = &PyDict_Type;
+    return PyType_Ready(&pysqlite_RegistryType);
+}
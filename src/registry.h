@@ -0,0 +1,50 @@
+/* registry.h - a dict that counts its modifications
+ *
+ * Copyright (C) 2016 Gerhard Hring <gh@ghaering.de>
+ *
+ * This file is part of pysqlite.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PYSQLITE_REGISTRY_H
+#define PYSQLITE_REGISTRY_H
+#include "Python.h"
+
+/* A dict subclass used for the converters and adapters registries. Every
+ * modification increments its version, so that the results of lookups can
+ * be cached and revalidated cheaply. Only modifications through the
+ * registry's own methods are counted: calling the dict methods on it
+ * directly, e.g. dict.__setitem__(registry, key, value) or
+ * dict.update(registry, other), bypasses the version, and cached lookups
+ * won't see the change until the registry is modified properly. */
+
+typedef struct
+{
+    PyDictObject dict;
+    unsigned long version;
+} pysqlite_Registry;
+
+extern PyTypeObject pysqlite_RegistryType;
+
+#define pysqlite_registry_version(op) (((pysqlite_Registry*)(op))->version)
+
+PyObject* pysqlite_registry_new(void);
+
+int pysqlite_registry_setup_types(void);
+
+#endif
@@ -23,21 +23,182 @@
 
 #include "row.h"
 #include "cursor.h"
+#include "structmember.h"
 
 void pysqlite_row_dealloc(pysqlite_Row* self)
 {
-    Py_XDECREF(self->data);
+    Py_ssize_t i;
+
+    for (i = 0; i < Py_SIZE(self); i++) {
+        Py_XDECREF(self->values[i]);
+    }
     Py_XDECREF(self->description);
+    Py_XDECREF(self->column_map);
 
     Py_TYPE(self)->tp_free((PyObject*)self);
 }
 
+/* Returns name with the ASCII letters in lower case, like column names are
+ * compared. Unicode names are encoded to UTF-8 first. */
+static PyObject* _pysqlite_fold_name(PyObject* name)
+{
+    PyObject* utf8 = NULL;
+    PyObject* folded;
+    const char* src;
+    char* dst;
+    Py_ssize_t size;
+    Py_ssize_t i;
+
+    if (PyUnicode_Check(name)) {
+        utf8 = PyUnicode_AsUTF8String(name);
+        if (!utf8) {
+            return NULL;
+        }
+        name = utf8;
+    }
+
+    src = PyString_AS_STRING(name);
+    size = PyString_GET_SIZE(name);
+
+    for (i = 0; i < size; i++) {
+        if (src[i] >= 'A' && src[i] <= 'Z') {
+            break;
+        }
+    }
+    if (i == size) {
+        if (!utf8) {
+            Py_INCREF(name);
+        }
+        return name;
+    }
+
+    /* not from src directly, single characters would be shared */
+    folded = PyString_FromStringAndSize(NULL, size);
+    if (!folded) {
+        Py_XDECREF(utf8);
+        return NULL;
+    }
+
+    dst = PyString_AS_STRING(folded);
+    for (i = 0; i < size; i++) {
+        if (src[i] >= 'A' && src[i] <= 'Z') {
+            dst[i] = src[i] + ('a' - 'A');
+        } else {
+            dst[i] = src[i];
+        }
+    }
+    Py_XDECREF(utf8);
+
+    return folded;
+}
+
+/* Maps the case-folded column names of description to their indexes. The
+ * first of several columns with the same name wins. */
+static PyObject* _pysqlite_build_column_map(PyObject* description)
+{
+    PyObject* map;
+    PyObject* name;
+    PyObject* folded;
+    PyObject* index;
+    Py_ssize_t i;
+    int rc;
+
+    map = PyDict_New();
+    if (!map || !PyTuple_Check(description)) {
+        return map;
+    }
+
+    for (i = 0; i < PyTuple_GET_SIZE(description); i++) {
+        name = PyTuple_GET_ITEM(PyTuple_GET_ITEM(description, i), 0);
+        if (!PyString_Check(name) && !PyUnicode_Check(name)) {
+            continue;
+        }
+
+        folded = _pysqlite_fold_name(name);
+        if (!folded) {
+            goto error;
+        }
+
+        rc = 0;
+        if (!PyDict_GetItem(map, folded)) {
+            index = PyInt_FromSsize_t(i);
+            if (!index) {
+                Py_DECREF(folded);
+                goto error;
+            }
+            rc = PyDict_SetItem(map, folded, index);
+            Py_DECREF(index);
+        }
+        Py_DECREF(folded);
+        if (rc != 0) {
+            goto error;
+        }
+    }
+
+    return map;
+
+error:
+    Py_DECREF(map);
+    return NULL;
+}
+
+/* Returns the column map for the cursor's description, building it the first
+ * time. It is kept on the cursor and its statement, so that it is built once
+ * per prepared statement. */
+static PyObject* _pysqlite_cursor_column_map(pysqlite_Cursor* cursor)
+{
+    pysqlite_Statement* statement = cursor->statement;
+
+    if (!cursor->column_map) {
+        if (statement && statement->description == cursor->description && statement->column_map) {
+            cursor->column_map = statement->column_map;
+            Py_INCREF(cursor->column_map);
+        } else {
+            cursor->column_map = _pysqlite_build_column_map(cursor->description);
+            if (!cursor->column_map) {
+                return NULL;
+            }
+            if (statement && statement->description == cursor->description) {
+                Py_XDECREF(statement->column_map);
+                Py_INCREF(cursor->column_map);
+                statement->column_map = cursor->column_map;
+            }
+        }
+    }
+
+    Py_INCREF(cursor->column_map);
+    return cursor->column_map;
+}
+
+/* creates a row for the cursor's result columns with room for size values */
+static pysqlite_Row* _pysqlite_row_alloc(PyTypeObject* type, pysqlite_Cursor* cursor, Py_ssize_t size)
+{
+    pysqlite_Row* self;
+
+    self = (pysqlite_Row*)type->tp_alloc(type, size);
+    if (!self) {
+        return NULL;
+    }
+
+    self->column_map = _pysqlite_cursor_column_map(cursor);
+    if (!self->column_map) {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    Py_INCREF(cursor->description);
+    self->description = cursor->description;
+
+    return self;
+}
+
 static PyObject *
 pysqlite_row_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
 {
     pysqlite_Row *self;
     PyObject* data;
     pysqlite_Cursor* cursor;
+    Py_ssize_t i;
 
     assert(type != NULL && type->tp_alloc != NULL);
 
@@ -56,95 +217,356 @@ pysqlite_row_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    self = (pysqlite_Row *) type->tp_alloc(type, 0);
+    self = _pysqlite_row_alloc(type, cursor, PyTuple_GET_SIZE(data));
     if (self == NULL)
         return NULL;
 
-    Py_INCREF(data);
-    self->data = data;
-
-    Py_INCREF(cursor->description);
-    self->description = cursor->description;
+    for (i = 0; i < PyTuple_GET_SIZE(data); i++) {
+        Py_INCREF(PyTuple_GET_ITEM(data, i));
+        self->values[i] = PyTuple_GET_ITEM(data, i);
+    }
 
     return (PyObject *) self;
 }
 
-PyObject* pysqlite_row_item(pysqlite_Row* self, Py_ssize_t idx)
+static PyObject* _pysqlite_row_from_tuple(PyTypeObject* type, pysqlite_Cursor* cursor, PyObject* data)
 {
-   PyObject* item = PyTuple_GetItem(self->data, idx);
-   Py_XINCREF(item);
-   return item;
+    pysqlite_Row* self;
+    Py_ssize_t i;
+
+    self = _pysqlite_row_alloc(type, cursor, PyTuple_GET_SIZE(data));
+    if (!self) {
+        Py_DECREF(data);
+        return NULL;
+    }
+
+    if (Py_REFCNT(data) == 1) {
+        /* nobody else sees the tuple, so its values can be moved */
+        for (i = 0; i < PyTuple_GET_SIZE(data); i++) {
+            self->values[i] = PyTuple_GET_ITEM(data, i);
+            PyTuple_SET_ITEM(data, i, NULL);
+        }
+    } else {
+        for (i = 0; i < PyTuple_GET_SIZE(data); i++) {
+            Py_INCREF(PyTuple_GET_ITEM(data, i));
+            self->values[i] = PyTuple_GET_ITEM(data, i);
+        }
+    }
+    Py_DECREF(data);
+
+    return (PyObject*)self;
 }
 
-PyObject* pysqlite_row_subscript(pysqlite_Row* self, PyObject* idx)
+PyObject* pysqlite_row_from_tuple(pysqlite_Cursor* cursor, PyObject* data)
 {
-    Py_ssize_t _idx;
-    char* key;
-    int nitems, i;
-    char* compare_key;
+    return _pysqlite_row_from_tuple(&pysqlite_RowType, cursor, data);
+}
+
+static PyObject* module_str;
+
+/* The metatype of the NamedRow subclasses built for the statements. The type
+ * owns the member definitions of its columns and the names they point to, so
+ * they can't go away while the type or one of its descriptors exists. */
+typedef struct
+{
+    PyHeapTypeObject type;
+    PyMemberDef* members;
+    PyObject* fields;
+} pysqlite_NamedRowMeta;
+
+static PyTypeObject pysqlite_NamedRowMetaType;
+
+static void pysqlite_named_row_meta_dealloc(pysqlite_NamedRowMeta* self)
+{
+    PyMemberDef* members = self->members;
+    PyObject* fields = self->fields;
+
+    /* the descriptors hold references to the type, so none are left */
+    PyType_Type.tp_dealloc((PyObject*)self);
+
+    PyMem_Free(members);
+    Py_XDECREF(fields);
+}
+
+/* Creates a subclass of NamedRow with a read-only member for each column of
+ * description, at the offset of the column's value in the row. Columns whose
+ * names are taken by an earlier column or a class attribute, or start with
+ * two underscores, get no member. The members are bound to the subclass,
+ * which can't be subclassed itself, so they can't read past the values of a
+ * row with fewer columns. */
+static PyObject* _pysqlite_build_named_row_type(PyObject* description)
+{
+    PyObject* dict;
+    PyObject* fields = NULL;
+    PyObject* slots;
+    PyObject* name;
+    PyObject* descr;
+    PyObject* type = NULL;
+    PyObject* result = NULL;
+    PyTypeObject* newtype;
+    PyMemberDef* members;
+    Py_ssize_t ncolumns;
+    Py_ssize_t i;
+    int rc;
+
+    dict = PyDict_New();
+    if (!dict) {
+        return NULL;
+    }
+
+    ncolumns = PyTuple_Check(description) ? PyTuple_GET_SIZE(description) : 0;
+    fields = PyTuple_New(ncolumns);
+    if (!fields) {
+        goto error;
+    }
+    for (i = 0; i < ncolumns; i++) {
+        name = PyTuple_GET_ITEM(PyTuple_GET_ITEM(description, i), 0);
+        Py_INCREF(name);
+        PyTuple_SET_ITEM(fields, i, name);
+    }
+
+    if (PyDict_SetItemString(dict, "_fields", fields) != 0
+            || PyDict_SetItemString(dict, "__module__", module_str) != 0) {
+        goto error;
+    }
+
+    /* no instance dictionary, so that the values stay at the end of the row */
+    slots = PyTuple_New(0);
+    if (!slots) {
+        goto error;
+    }
+    rc = PyDict_SetItemString(dict, "__slots__", slots);
+    Py_DECREF(slots);
+    if (rc != 0) {
+        goto error;
+    }
+
+    type = PyObject_CallFunction((PyObject*)&pysqlite_NamedRowMetaType, "s(O)O",
+                                 "NamedRow", &pysqlite_NamedRowType, dict);
+    if (!type) {
+        goto error;
+    }
+    newtype = (PyTypeObject*)type;
+
+    /* Like Row, the rows can't be part of reference cycles, so they are not
+     * tracked by the garbage collector, which type() makes them. */
+    newtype->tp_flags &= ~(Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_BASETYPE);
+    newtype->tp_traverse = NULL;
+    newtype->tp_clear = NULL;
+    newtype->tp_is_gc = NULL;
+    newtype->tp_free = PyObject_Del;
+
+    members = PyMem_New(PyMemberDef, ncolumns + 1);
+    if (!members) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    memset(members, 0, (ncolumns + 1) * sizeof(PyMemberDef));
+    ((pysqlite_NamedRowMeta*)type)->members = members;
+    Py_INCREF(fields);
+    ((pysqlite_NamedRowMeta*)type)->fields = fields;
+
+    for (i = 0; i < ncolumns; i++) {
+        name = PyTuple_GET_ITEM(fields, i);
+        if (!PyString_Check(name)
+                || strncmp(PyString_AS_STRING(name), "__", 2) == 0
+                || _PyType_Lookup(newtype, name)) {
+            continue;
+        }
+
+        members[i].name = PyString_AS_STRING(name);
+        members[i].type = T_OBJECT;
+        members[i].offset = offsetof(pysqlite_Row, values) + i * sizeof(PyObject*);
+        members[i].flags = READONLY;
+        members[i].doc = NULL;
+
+        descr = PyDescr_NewMember(newtype, &members[i]);
+        if (!descr) {
+            goto error;
+        }
+        rc = PyObject_SetAttr(type, name, descr);
+        Py_DECREF(descr);
+        if (rc != 0) {
+            goto error;
+        }
+    }
+
+    result = type;
+    type = NULL;
+
+error:
+    Py_DECREF(dict);
+    Py_XDECREF(fields);
+    Py_XDECREF(type);
+    return result;
+}
+
+/* Returns the NamedRow subclass for the cursor's description, building it the
+ * first time, like _pysqlite_cursor_column_map(). */
+static PyObject* _pysqlite_cursor_named_row_type(pysqlite_Cursor* cursor)
+{
+    pysqlite_Statement* statement = cursor->statement;
+
+    if (!cursor->named_row_type) {
+        if (statement && statement->description == cursor->description && statement->named_row_type) {
+            cursor->named_row_type = statement->named_row_type;
+            Py_INCREF(cursor->named_row_type);
+        } else {
+            cursor->named_row_type = _pysqlite_build_named_row_type(cursor->description);
+            if (!cursor->named_row_type) {
+                return NULL;
+            }
+            if (statement && statement->description == cursor->description) {
+                Py_XDECREF(statement->named_row_type);
+                Py_INCREF(cursor->named_row_type);
+                statement->named_row_type = cursor->named_row_type;
+            }
+        }
+    }
+
+    Py_INCREF(cursor->named_row_type);
+    return cursor->named_row_type;
+}
+
+PyObject* pysqlite_named_row_from_tuple(pysqlite_Cursor* cursor, PyObject* data)
+{
+    PyObject* type;
+    PyObject* row;
 
-    char* p1;
-    char* p2;
+    type = _pysqlite_cursor_named_row_type(cursor);
+    if (!type) {
+        Py_DECREF(data);
+        return NULL;
+    }
 
+    row = _pysqlite_row_from_tuple((PyTypeObject*)type, cursor, data);
+    Py_DECREF(type);
+
+    return row;
+}
+
+static PyObject *
+pysqlite_named_row_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    PyObject* fields = NULL;
+    PyObject* data;
+    pysqlite_Cursor* cursor;
+    PyObject* row;
+
+    if (!_PyArg_NoKeywords("NamedRow()", kwargs))
+        return NULL;
+    if (!PyArg_ParseTuple(args, "O!O!", &pysqlite_CursorType, &cursor, &PyTuple_Type, &data))
+        return NULL;
+
+    if (type == &pysqlite_NamedRowType) {
+        type = (PyTypeObject*)_pysqlite_cursor_named_row_type(cursor);
+        if (!type) {
+            return NULL;
+        }
+    } else {
+        Py_INCREF(type);
+    }
+
+    /* the members must not reach beyond the values */
+    if (Py_TYPE(type) == &pysqlite_NamedRowMetaType) {
+        fields = ((pysqlite_NamedRowMeta*)type)->fields;
+    }
+    row = NULL;
+    if (fields && PyTuple_GET_SIZE(fields) != PyTuple_GET_SIZE(data)) {
+        PyErr_Format(PyExc_ValueError, "%s() needs %zd values, got %zd",
+                     type->tp_name, PyTuple_GET_SIZE(fields), PyTuple_GET_SIZE(data));
+    } else {
+        Py_INCREF(data);
+        row = _pysqlite_row_from_tuple(type, cursor, data);
+    }
+    Py_DECREF(type);
+
+    return row;
+}
+
+PyObject* pysqlite_row_item(pysqlite_Row* self, Py_ssize_t idx)
+{
     PyObject* item;
 
+    if (idx < 0 || idx >= Py_SIZE(self)) {
+        PyErr_SetString(PyExc_IndexError, "Row index out of range");
+        return NULL;
+    }
+
+    item = self->values[idx];
+    Py_INCREF(item);
+    return item;
+}
+
+/* returns the values from start to stop in steps of step as a tuple */
+static PyObject* pysqlite_row_slice(pysqlite_Row* self, PyObject* slice)
+{
+    Py_ssize_t start, stop, step, slicelength;
+    Py_ssize_t cur, i;
+    PyObject* result;
+
+    if (PySlice_GetIndicesEx((PySliceObject*)slice, Py_SIZE(self), &start, &stop, &step, &slicelength) < 0) {
+        return NULL;
+    }
+
+    result = PyTuple_New(slicelength);
+    if (!result) {
+        return NULL;
+    }
+
+    for (cur = start, i = 0; i < slicelength; cur += step, i++) {
+        Py_INCREF(self->values[cur]);
+        PyTuple_SET_ITEM(result, i, self->values[cur]);
+    }
+
+    return result;
+}
+
+PyObject* pysqlite_row_subscript(pysqlite_Row* self, PyObject* idx)
+{
+    Py_ssize_t _idx;
+    PyObject* index;
+    PyObject* folded;
+
     if (PyInt_Check(idx)) {
         _idx = PyInt_AsLong(idx);
         if (_idx < 0)
-           _idx += PyTuple_GET_SIZE(self->data);
-        item = PyTuple_GetItem(self->data, _idx);
-        Py_XINCREF(item);
-        return item;
+           _idx += Py_SIZE(self);
+        return pysqlite_row_item(self, _idx);
     } else if (PyLong_Check(idx)) {
         _idx = PyNumber_AsSsize_t(idx, PyExc_IndexError);
         if (_idx == -1 && PyErr_Occurred())
             return NULL;
         if (_idx < 0)
-           _idx += PyTuple_GET_SIZE(self->data);
-        item = PyTuple_GetItem(self->data, _idx);
-        Py_XINCREF(item);
-        return item;
+           _idx += Py_SIZE(self);
+        return pysqlite_row_item(self, _idx);
     } else if (PyString_Check(idx) || PyUnicode_Check(idx)) {
-        key = PyString_AsString(idx);
-
-        nitems = PyTuple_Size(self->description);
-
-        for (i = 0; i < nitems; i++) {
-            compare_key = PyString_AsString(PyTuple_GET_ITEM(PyTuple_GET_ITEM(self->description, i), 0));
-            if (!compare_key) {
+        index = PyDict_GetItem(self->column_map, idx);
+        if (!index) {
+            folded = _pysqlite_fold_name(idx);
+            if (!folded) {
                 return NULL;
             }
+            index = PyDict_GetItem(self->column_map, folded);
+            Py_DECREF(folded);
 
-            p1 = key;
-            p2 = compare_key;
-
-            while (1) {
-                if ((*p1 == (char)0) || (*p2 == (char)0)) {
-                    break;
-                }
-
-                if ((*p1 | 0x20) != (*p2 | 0x20)) {
-                    break;
-                }
-
-                p1++;
-                p2++;
+            if (!index) {
+                PyErr_SetString(PyExc_IndexError, "No item with that key");
+                return NULL;
             }
 
-            if ((*p1 == (char)0) && (*p2 == (char)0)) {
-                /* found item */
-                item = PyTuple_GetItem(self->data, i);
-                Py_INCREF(item);
-                return item;
+            /* remember this spelling of the name, so that the next lookup
+             * with it needs no folding */
+            if (PyString_CheckExact(idx) || PyUnicode_CheckExact(idx)) {
+                if (PyDict_SetItem(self->column_map, idx, index) != 0) {
+                    return NULL;
+                }
             }
-
         }
 
-        PyErr_SetString(PyExc_IndexError, "No item with that key");
-        return NULL;
+        return pysqlite_row_item(self, PyInt_AS_LONG(index));
     } else if (PySlice_Check(idx)) {
-        PyErr_SetString(PyExc_ValueError, "slices not implemented, yet");
-        return NULL;
+        return pysqlite_row_slice(self, idx);
     } else {
         PyErr_SetString(PyExc_IndexError, "Index must be int or string");
         return NULL;
@@ -153,7 +575,7 @@ PyObject* pysqlite_row_subscript(pysqlite_Row* self, PyObject* idx)
 
 Py_ssize_t pysqlite_row_length(pysqlite_Row* self, PyObject* args, PyObject* kwargs)
 {
-    return PyTuple_GET_SIZE(self->data);
+    return Py_SIZE(self);
 }
 
 PyObject* pysqlite_row_keys(pysqlite_Row* self, PyObject* args, PyObject* kwargs)
@@ -177,23 +599,132 @@ PyObject* pysqlite_row_keys(pysqlite_Row* self, PyObject* args, PyObject* kwargs
     return list;
 }
 
+PyObject* pysqlite_row_asdict(pysqlite_Row* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* dict;
+    PyObject* key;
+    Py_ssize_t nitems, i;
+
+    dict = PyDict_New();
+    if (!dict) {
+        return NULL;
+    }
+
+    if (!PyTuple_Check(self->description)) {
+        return dict;
+    }
+
+    nitems = PyTuple_GET_SIZE(self->description);
+    if (nitems > Py_SIZE(self)) {
+        nitems = Py_SIZE(self);
+    }
+
+    for (i = 0; i < nitems; i++) {
+        key = PyTuple_GET_ITEM(PyTuple_GET_ITEM(self->description, i), 0);
+
+        /* like looking up the name, the first of equally named columns wins */
+        if (PyDict_GetItem(dict, key)) {
+            continue;
+        }
+        if (PyDict_SetItem(dict, key, self->values[i]) != 0) {
+            Py_DECREF(dict);
+            return NULL;
+        }
+    }
+
+    return dict;
+}
+
+/* returns the values as a tuple, for operations that are rarely used on rows */
+static PyObject* pysqlite_row_as_tuple(pysqlite_Row* self)
+{
+    PyObject* result;
+    Py_ssize_t i;
+
+    result = PyTuple_New(Py_SIZE(self));
+    if (!result) {
+        return NULL;
+    }
+
+    for (i = 0; i < Py_SIZE(self); i++) {
+        Py_INCREF(self->values[i]);
+        PyTuple_SET_ITEM(result, i, self->values[i]);
+    }
+
+    return result;
+}
+
 static int pysqlite_row_print(pysqlite_Row* self, FILE *fp, int flags)
 {
-    return (&PyTuple_Type)->tp_print(self->data, fp, flags);
+    PyObject* data;
+    int rc;
+
+    data = pysqlite_row_as_tuple(self);
+    if (!data) {
+        return -1;
+    }
+
+    rc = (&PyTuple_Type)->tp_print(data, fp, flags);
+    Py_DECREF(data);
+
+    return rc;
 }
 
 static PyObject* pysqlite_iter(pysqlite_Row* self)
 {
-    return PyObject_GetIter(self->data);
+    return PySeqIter_New((PyObject*)self);
+}
+
+/* the same as the hash of a tuple with the values, so that it doesn't change
+ * with the storage of the row */
+static long pysqlite_row_values_hash(pysqlite_Row* self)
+{
+    long x, y;
+    Py_ssize_t len = Py_SIZE(self);
+    Py_ssize_t i;
+    long mult = 1000003L;
+
+    x = 0x345678L;
+    for (i = 0; i < Py_SIZE(self); i++) {
+        y = PyObject_Hash(self->values[i]);
+        if (y == -1) {
+            return -1;
+        }
+        x = (x ^ y) * mult;
+        len--;
+        mult += (long)(82520L + len + len);
+    }
+    x += 97531L;
+    if (x == -1) {
+        x = -2;
+    }
+
+    return x;
 }
 
 static long pysqlite_row_hash(pysqlite_Row *self)
 {
-    return PyObject_Hash(self->description) ^ PyObject_Hash(self->data);
+    long description_hash;
+    long values_hash;
+
+    description_hash = PyObject_Hash(self->description);
+    if (description_hash == -1) {
+        return -1;
+    }
+
+    values_hash = pysqlite_row_values_hash(self);
+    if (values_hash == -1) {
+        return -1;
+    }
+
+    return description_hash ^ values_hash;
 }
 
 static PyObject* pysqlite_row_richcompare(pysqlite_Row *self, PyObject *_other, int opid)
 {
+    Py_ssize_t i;
+    int cmp;
+
     if (opid != Py_EQ && opid != Py_NE) {
         Py_INCREF(Py_NotImplemented);
         return Py_NotImplemented;
@@ -204,8 +735,20 @@ static PyObject* pysqlite_row_richcompare(pysqlite_Row *self, PyObject *_other,
         if ((opid == Py_EQ && res == Py_True)
             || (opid == Py_NE && res == Py_False)) {
             Py_DECREF(res);
-            return PyObject_RichCompare(self->data, other->data, opid);
+
+            cmp = Py_SIZE(self) == Py_SIZE(other);
+            for (i = 0; cmp == 1 && i < Py_SIZE(self); i++) {
+                cmp = PyObject_RichCompareBool(self->values[i], other->values[i], Py_EQ);
+            }
+            if (cmp < 0) {
+                return NULL;
+            }
+
+            res = (cmp == (opid == Py_EQ)) ? Py_True : Py_False;
+            Py_INCREF(res);
+            return res;
         }
+        return res;
     }
     Py_INCREF(Py_NotImplemented);
     return Py_NotImplemented;
@@ -228,6 +771,8 @@ static PySequenceMethods pysqlite_row_as_sequence = {
 static PyMethodDef pysqlite_row_methods[] = {
     {"keys", (PyCFunction)pysqlite_row_keys, METH_NOARGS,
         PyDoc_STR("Returns the keys of the row.")},
+    {"asdict", (PyCFunction)pysqlite_row_asdict, METH_NOARGS,
+        PyDoc_STR("Returns a dictionary of the column names and values.")},
     {NULL, NULL}
 };
 
@@ -235,8 +780,8 @@ static PyMethodDef pysqlite_row_methods[] = {
 PyTypeObject pysqlite_RowType = {
         PyVarObject_HEAD_INIT(NULL, 0)
         MODULE_NAME ".Row",                             /* tp_name */
-        sizeof(pysqlite_Row),                           /* tp_basicsize */
-        0,                                              /* tp_itemsize */
+        sizeof(pysqlite_Row) - sizeof(PyObject*),       /* tp_basicsize */
+        sizeof(PyObject*),                              /* tp_itemsize */
         (destructor)pysqlite_row_dealloc,               /* tp_dealloc */
         (printfunc)pysqlite_row_print,                  /* tp_print */
         0,                                              /* tp_getattr */
@@ -252,7 +797,7 @@ PyTypeObject pysqlite_RowType = {
         0,                                              /* tp_getattro */
         0,                                              /* tp_setattro */
         0,                                              /* tp_as_buffer */
-        Py_TPFLAGS_DEFAULT|Py_TPFLAGS_BASETYPE,         /* tp_flags */
+        Py_TPFLAGS_DEFAULT|Py_TPFLAGS_BASETYPE|Py_TPFLAGS_HAVE_VERSION_TAG, /* tp_flags */
         0,                                              /* tp_doc */
         (traverseproc)0,                                /* tp_traverse */
         0,                                              /* tp_clear */
@@ -274,10 +819,113 @@ PyTypeObject pysqlite_RowType = {
         0                                               /* tp_free */
 };
 
+/* The row factory for rows with the columns as attributes. Each statement gets
+ * its own subclass, see _pysqlite_build_named_row_type(). */
+PyTypeObject pysqlite_NamedRowType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        MODULE_NAME ".NamedRow",                        /* tp_name */
+        sizeof(pysqlite_Row) - sizeof(PyObject*),       /* tp_basicsize */
+        sizeof(PyObject*),                              /* tp_itemsize */
+        (destructor)pysqlite_row_dealloc,               /* tp_dealloc */
+        0,                                              /* tp_print */
+        0,                                              /* tp_getattr */
+        0,                                              /* tp_setattr */
+        0,                                              /* tp_compare */
+        0,                                              /* tp_repr */
+        0,                                              /* tp_as_number */
+        0,                                              /* tp_as_sequence */
+        0,                                              /* tp_as_mapping */
+        0,                                              /* tp_hash */
+        0,                                              /* tp_call */
+        0,                                              /* tp_str */
+        0,                                              /* tp_getattro */
+        0,                                              /* tp_setattro */
+        0,                                              /* tp_as_buffer */
+        Py_TPFLAGS_DEFAULT|Py_TPFLAGS_BASETYPE|Py_TPFLAGS_HAVE_VERSION_TAG, /* tp_flags */
+        0,                                              /* tp_doc */
+        (traverseproc)0,                                /* tp_traverse */
+        0,                                              /* tp_clear */
+        0,                                              /* tp_richcompare */
+        0,                                              /* tp_weaklistoffset */
+        0,                                              /* tp_iter */
+        0,                                              /* tp_iternext */
+        0,                                              /* tp_methods */
+        0,                                              /* tp_members */
+        0,                                              /* tp_getset */
+        0,                                              /* tp_base */
+        0,                                              /* tp_dict */
+        0,                                              /* tp_descr_get */
+        0,                                              /* tp_descr_set */
+        0,                                              /* tp_dictoffset */
+        0,                                              /* tp_init */
+        0,                                              /* tp_alloc */
+        0,                                              /* tp_new */
+        0                                               /* tp_free */
+};
+
+static PyTypeObject pysqlite_NamedRowMetaType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+        MODULE_NAME ".NamedRowType",                    /* tp_name */
+        sizeof(pysqlite_NamedRowMeta),                  /* tp_basicsize */
+        sizeof(PyMemberDef),                            /* tp_itemsize */
+        (destructor)pysqlite_named_row_meta_dealloc,    /* tp_dealloc */
+        0,                                              /* tp_print */
+        0,                                              /* tp_getattr */
+        0,                                              /* tp_setattr */
+        0,                                              /* tp_compare */
+        0,                                              /* tp_repr */
+        0,                                              /* tp_as_number */
+        0,                                              /* tp_as_sequence */
+        0,                                              /* tp_as_mapping */
+        0,                                              /* tp_hash */
+        0,                                              /* tp_call */
+        0,                                              /* tp_str */
+        0,                                              /* tp_getattro */
+        0,                                              /* tp_setattro */
+        0,                                              /* tp_as_buffer */
+        Py_TPFLAGS_DEFAULT,                             /* tp_flags */
+        0,                                              /* tp_doc */
+        (traverseproc)0,                                /* tp_traverse */
+        0,                                              /* tp_clear */
+        0,                                              /* tp_richcompare */
+        0,                                              /* tp_weaklistoffset */
+        0,                                              /* tp_iter */
+        0,                                              /* tp_iternext */
+        0,                                              /* tp_methods */
+        0,                                              /* tp_members */
+        0,                                              /* tp_getset */
+        0,                                              /* tp_base */
+        0,                                              /* tp_dict */
+        0,                                              /* tp_descr_get */
+        0,                                              /* tp_descr_set */
+        0,                                              /* tp_dictoffset */
+        0,                                              /* tp_init */
+        0,                                              /* tp_alloc */
+        0,                                              /* tp_new */
+        0                                               /* tp_free */
+};
+
 extern int pysqlite_row_setup_types(void)
 {
+    module_str = PyString_FromString(MODULE_NAME);
+    if (!module_str) {
+        return -1;
+    }
+
     pysqlite_RowType.tp_new = pysqlite_row_new;
     pysqlite_RowType.tp_as_mapping = &pysqlite_row_as_mapping;
     pysqlite_RowType.tp_as_sequence = &pysqlite_row_as_sequence;
-    return PyType_Ready(&pysqlite_RowType);
+    if (PyType_Ready(&pysqlite_RowType) < 0) {
+        return -1;
+    }
+
+    pysqlite_NamedRowType.tp_new = pysqlite_named_row_new;
+    pysqlite_NamedRowType.tp_base = &pysqlite_RowType;
+    if (PyType_Ready(&pysqlite_NamedRowType) < 0) {
+        return -1;
+    }
+
+    /* garbage collection support and everything else is inherited */
+    pysqlite_NamedRowMetaType.tp_base = &PyType_Type;
+    return PyType_Ready(&pysqlite_NamedRowMetaType);
 }
@@ -25,14 +25,32 @@
 #define PYSQLITE_ROW_H
 #include "Python.h"
 
+#include "cursor.h"
+
+/* A row is allocated as one object with the values inline, like a tuple. The
+ * description and the column map are shared by the rows of a statement. */
 typedef struct _Row
 {
-    PyObject_HEAD
-    PyObject* data;
+    PyObject_VAR_HEAD
     PyObject* description;
+
+    /* the column indexes by case-folded name, shared with the cursor */
+    PyObject* column_map;
+
+    PyObject* values[1];
 } pysqlite_Row;
 
 extern PyTypeObject pysqlite_RowType;
+extern PyTypeObject pysqlite_NamedRowType;
+
+/* Creates a Row for the current result columns of cursor, like calling
+ * Row(cursor, data) but without parsing arguments. Steals the reference to
+ * data, which must be a tuple. */
+PyObject* pysqlite_row_from_tuple(pysqlite_Cursor* cursor, PyObject* data);
+
+/* Like pysqlite_row_from_tuple(), but creates an instance of the NamedRow
+ * subclass for the cursor's result columns. */
+PyObject* pysqlite_named_row_from_tuple(pysqlite_Cursor* cursor, PyObject* data);
 
 int pysqlite_row_setup_types(void);
 
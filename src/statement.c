@@ -27,6 +27,7 @@
 #include "util.h"
 #include "microprotocols.h"
 #include "prepare_protocol.h"
+#include "adapters.h"
 
 /* prototypes */
 static int pysqlite_check_remaining_sql(const char* tail);
@@ -47,6 +48,7 @@ typedef enum {
     TYPE_STRING,
     TYPE_UNICODE,
     TYPE_BUFFER,
+    TYPE_BUFFER_VIEW,
     TYPE_UNKNOWN
 } parameter_type;
 
@@ -59,7 +61,15 @@ int pysqlite_statement_create(pysqlite_Statement* self, pysqlite_Connection* con
     char* p;
 
     self->st = NULL;
+    self->sql = NULL;
     self->in_use = 0;
+    self->row_cast_map = NULL;
+    self->description = NULL;
+    self->column_map = NULL;
+    self->named_row_type = NULL;
+    self->bindings = NULL;
+    self->bindings_size = 0;
+    self->bindings_held = 0;
 
     if (PyString_Check(sql)) {
         sql_str = sql;
@@ -117,10 +127,23 @@ int pysqlite_statement_create(pysqlite_Statement* self, pysqlite_Connection* con
         rc = PYSQLITE_TOO_MUCH_SQL;
     }
 
+    if (rc == SQLITE_OK) {
+        self->bindings_size = sqlite3_bind_parameter_count(self->st);
+        if (self->bindings_size > 0) {
+            self->bindings = PyMem_New(pysqlite_Binding, self->bindings_size);
+            if (!self->bindings) {
+                PyErr_NoMemory();
+                self->bindings_size = 0;
+                return PYSQLITE_SQL_WRONG_TYPE;
+            }
+            memset(self->bindings, 0, self->bindings_size * sizeof(pysqlite_Binding));
+        }
+    }
+
     return rc;
 }
 
-int pysqlite_statement_bind_parameter(pysqlite_Statement* self, int pos, PyObject* parameter, int allow_8bit_chars)
+int pysqlite_value_from_object(pysqlite_Value* value, int pos, PyObject* parameter, int allow_8bit_chars)
 {
     int rc = SQLITE_OK;
     const char* buffer;
@@ -130,9 +153,11 @@ int pysqlite_statement_bind_parameter(pysqlite_Statement* self, int pos, PyObjec
     parameter_type paramtype;
     char* c;
 
+    value->type = SQLITE_NULL;
+    value->owner = NULL;
+
     if (parameter == Py_None) {
-        rc = sqlite3_bind_null(self->st, pos);
-        goto final;
+        return SQLITE_OK;
     }
 
     if (PyInt_CheckExact(parameter)) {
@@ -157,6 +182,8 @@ int pysqlite_statement_bind_parameter(pysqlite_Statement* self, int pos, PyObjec
         paramtype = TYPE_STRING;
     } else if (PyUnicode_Check(parameter)) {
         paramtype = TYPE_UNICODE;
+    } else if (PyObject_CheckBuffer(parameter)) {
+        paramtype = TYPE_BUFFER_VIEW;
     } else {
         paramtype = TYPE_UNKNOWN;
     }
@@ -166,53 +193,106 @@ int pysqlite_statement_bind_parameter(pysqlite_Statement* self, int pos, PyObjec
         for (c = string; *c != 0; c++) {
             if (*c & 0x80) {
                 PyErr_SetString(pysqlite_ProgrammingError, "You must not use 8-bit bytestrings unless you use a text_factory that can interpret 8-bit bytestrings (like text_factory = str). It is highly recommended that you instead just switch your application to Unicode strings.");
-                rc = -1;
-                goto final;
+                return -1;
             }
         }
     }
 
     switch (paramtype) {
-        case TYPE_INT: {
-            long longval = PyInt_AsLong(parameter);
-            rc = sqlite3_bind_int64(self->st, pos, longval);
+        case TYPE_INT:
+            value->type = SQLITE_INTEGER;
+            value->intval = PyInt_AsLong(parameter);
             break;
-        }
-        case TYPE_LONG: {
-            sqlite_int64 value = _pysqlite_long_as_int64(parameter);
-            if (value == -1 && PyErr_Occurred())
+        case TYPE_LONG:
+            value->type = SQLITE_INTEGER;
+            value->intval = _pysqlite_long_as_int64(parameter);
+            if (value->intval == -1 && PyErr_Occurred()) {
                 rc = -1;
-            else
-                rc = sqlite3_bind_int64(self->st, pos, (sqlite_int64)value);
+            }
             break;
-        }
         case TYPE_FLOAT:
-            rc = sqlite3_bind_double(self->st, pos, PyFloat_AsDouble(parameter));
+            value->type = SQLITE_FLOAT;
+            value->dblval = PyFloat_AsDouble(parameter);
             break;
         case TYPE_STRING:
             PyString_AsStringAndSize(parameter, &string, &buflen);
-            rc = sqlite3_bind_text(self->st, pos, string, buflen, SQLITE_TRANSIENT);
+            value->type = SQLITE_TEXT;
+            value->data = string;
+            value->nbytes = buflen;
+            Py_INCREF(parameter);
+            value->owner = parameter;
             break;
         case TYPE_UNICODE:
             stringval = PyUnicode_AsUTF8String(parameter);
+            if (!stringval) {
+                rc = -1;
+                break;
+            }
             PyString_AsStringAndSize(stringval, &string, &buflen);
-            rc = sqlite3_bind_text(self->st, pos, string, buflen, SQLITE_TRANSIENT);
-            Py_DECREF(stringval);
+            value->type = SQLITE_TEXT;
+            value->data = string;
+            value->nbytes = buflen;
+            value->owner = stringval;
             break;
         case TYPE_BUFFER:
             if (PyObject_AsCharBuffer(parameter, &buffer, &buflen) == 0) {
-                rc = sqlite3_bind_blob(self->st, pos, buffer, buflen, SQLITE_TRANSIENT);
+                value->type = SQLITE_BLOB;
+                value->data = buffer;
+                value->nbytes = buflen;
+                Py_INCREF(parameter);
+                value->owner = parameter;
             } else {
                 PyErr_SetString(PyExc_ValueError, "could not convert BLOB to buffer");
                 rc = -1;
             }
             break;
+        case TYPE_BUFFER_VIEW:
+            /* the memoryview pins the exporter's memory, so that e. g. a
+             * bytearray can't be resized while it is bound */
+            stringval = PyMemoryView_GetContiguous(parameter, PyBUF_READ, 'C');
+            if (!stringval) {
+                rc = -1;
+                break;
+            }
+            value->type = SQLITE_BLOB;
+            value->data = PyMemoryView_GET_BUFFER(stringval)->buf;
+            value->nbytes = PyMemoryView_GET_BUFFER(stringval)->len;
+            if (!value->data) {
+                value->data = "";
+            }
+            value->owner = stringval;
+            break;
         case TYPE_UNKNOWN:
             rc = -1;
             PyErr_Format(pysqlite_InterfaceError, "Parameter %d is of no supported type", pos);
     }
 
-final:
+    return rc;
+}
+
+void pysqlite_value_clear(pysqlite_Value* value)
+{
+    Py_CLEAR(value->owner);
+}
+
+int pysqlite_statement_bind_value(pysqlite_Statement* self, int pos, pysqlite_Value* value, sqlite3_destructor_type destructor)
+{
+    switch (value->type) {
+        case SQLITE_INTEGER:
+            return sqlite3_bind_int64(self->st, pos, value->intval);
+        case SQLITE_FLOAT:
+            return sqlite3_bind_double(self->st, pos, value->dblval);
+        case SQLITE_TEXT:
+            return sqlite3_bind_text(self->st, pos, value->data, value->nbytes, destructor);
+        case SQLITE_BLOB:
+            return sqlite3_bind_blob(self->st, pos, value->data, value->nbytes, destructor);
+        default:
+            return sqlite3_bind_null(self->st, pos);
+    }
+}
+
+void pysqlite_statement_set_bind_error(int rc, int pos)
+{
     switch (rc) {
         case SQLITE_TOOBIG:
             PyErr_Format(pysqlite_DatabaseError, "Parameter %d is too big", pos);
@@ -224,30 +304,183 @@ final:
             PyErr_Format(pysqlite_DatabaseError, "SQlite is out of memory for parameter %d", pos);
             break;
     }
+}
+
+/* replaces the binding at pos; steals the reference to owner */
+static void _pysqlite_statement_hold(pysqlite_Statement* self, int pos, PyObject* source, PyObject* owner)
+{
+    pysqlite_Binding* binding = &self->bindings[pos - 1];
+    PyObject* old_source = binding->source;
+    PyObject* old_owner = binding->owner;
+
+    Py_XINCREF(source);
+    binding->source = source;
+    binding->owner = owner;
+    if (owner) {
+        self->bindings_held = 1;
+    }
+
+    Py_XDECREF(old_source);
+    Py_XDECREF(old_owner);
+}
+
+/* unbinds the parameters SQLite doesn't own, so that their data can go */
+static void _pysqlite_statement_release_bindings(pysqlite_Statement* self)
+{
+    int i;
+
+    if (!self->bindings_held) {
+        return;
+    }
+
+    if (self->st) {
+        (void)sqlite3_clear_bindings(self->st);
+    }
+
+    self->bindings_held = 0;
+    for (i = 0; i < self->bindings_size; i++) {
+        Py_CLEAR(self->bindings[i].source);
+        Py_CLEAR(self->bindings[i].owner);
+    }
+}
+
+/*
+ * Binds value, which was made from source, at pos. Text owned by an
+ * immutable string and blobs pinned by a memoryview are bound without
+ * copying and kept alive by the statement; everything else is copied by
+ * SQLite.
+ */
+static int _pysqlite_statement_bind_value_at(pysqlite_Statement* self, int pos, pysqlite_Value* value, PyObject* source)
+{
+    int rc;
+
+    if (pos < 1 || pos > self->bindings_size) {
+        rc = pysqlite_statement_bind_value(self, pos, value, SQLITE_TRANSIENT);
+        pysqlite_value_clear(value);
+    } else if (value->owner && (value->type == SQLITE_TEXT || PyMemoryView_Check(value->owner))) {
+        rc = pysqlite_statement_bind_value(self, pos, value, SQLITE_STATIC);
+        _pysqlite_statement_hold(self, pos, rc == SQLITE_OK ? source : NULL, value->owner);
+        value->owner = NULL;
+    } else {
+        rc = pysqlite_statement_bind_value(self, pos, value, SQLITE_TRANSIENT);
+        pysqlite_value_clear(value);
+        _pysqlite_statement_hold(self, pos, NULL, NULL);
+    }
+
+    pysqlite_statement_set_bind_error(rc, pos);
 
     return rc;
 }
 
-/* returns 0 if the object is one of Python's internal ones that don't need to be adapted */
-static int _need_adapt(PyObject* obj)
+int pysqlite_statement_bind_parameter(pysqlite_Statement* self, int pos, PyObject* parameter, int allow_8bit_chars)
 {
-    if (pysqlite_BaseTypeAdapted) {
-        return 1;
+    pysqlite_Binding* binding;
+    pysqlite_Value value;
+    int rc;
+
+    if (pos >= 1 && pos <= self->bindings_size) {
+        binding = &self->bindings[pos - 1];
+        if (binding->source == parameter && binding->owner && PyString_Check(binding->owner)) {
+            /* the same string as before, e. g. from the previous row of
+             * executemany(); its UTF-8 is still bound */
+            return SQLITE_OK;
+        }
+    }
+
+    rc = pysqlite_value_from_object(&value, pos, parameter, allow_8bit_chars);
+    if (rc == SQLITE_OK) {
+        rc = _pysqlite_statement_bind_value_at(self, pos, &value, parameter);
     }
 
+    return rc;
+}
+
+/* returns 0 if the object is one of Python's internal ones that don't need to be adapted */
+static int _need_adapt(PyObject* obj)
+{
     if (PyInt_CheckExact(obj) || PyLong_CheckExact(obj)
             || PyFloat_CheckExact(obj) || PyString_CheckExact(obj)
             || PyUnicode_CheckExact(obj) || PyBuffer_Check(obj)) {
-        return 0;
+        /* only the base types that have an adapter of their own */
+        if (!pysqlite_BaseTypeAdapted) {
+            return 0;
+        }
+        return pysqlite_microprotocols_lookup(Py_TYPE(obj)) != NULL || PyErr_Occurred();
     } else {
         return 1;
     }
 }
 
+/* Returns the parameter adapted for binding. Like when binding directly, an
+ * error of a native adapter is raised, while a failing adapter lookup leaves
+ * the parameter as it is. */
+PyObject* pysqlite_statement_adapt_parameter(PyObject* parameter)
+{
+    PyObject* adapted;
+    pysqlite_Value value;
+    char buf[PYSQLITE_NATIVE_ADAPT_BUFSIZE];
+    int rc;
+
+    if (!_need_adapt(parameter)) {
+        Py_INCREF(parameter);
+        return parameter;
+    }
+
+    rc = pysqlite_native_adapt(parameter, &value, buf);
+    if (rc > 0) {
+        if (value.owner) {
+            return value.owner;
+        }
+        return PyString_FromStringAndSize(value.data, value.nbytes);
+    } else if (rc < 0) {
+        return NULL;
+    }
+
+    adapted = pysqlite_microprotocols_adapt(parameter, (PyObject*)&pysqlite_PrepareProtocolType, NULL);
+    if (!adapted) {
+        PyErr_Clear();
+        Py_INCREF(parameter);
+        adapted = parameter;
+    }
+
+    return adapted;
+}
+
+/* Adapts and binds a single parameter. Types with a native adapter are
+ * formatted on the stack and bound without creating a string object. */
+static int _pysqlite_statement_bind_object(pysqlite_Statement* self, int pos, PyObject* parameter, int allow_8bit_chars)
+{
+    PyObject* adapted;
+    pysqlite_Value value;
+    char buf[PYSQLITE_NATIVE_ADAPT_BUFSIZE];
+    int rc;
+
+    if (!_need_adapt(parameter)) {
+        return pysqlite_statement_bind_parameter(self, pos, parameter, allow_8bit_chars);
+    }
+
+    rc = pysqlite_native_adapt(parameter, &value, buf);
+    if (rc > 0) {
+        return _pysqlite_statement_bind_value_at(self, pos, &value, NULL);
+    } else if (rc < 0) {
+        return -1;
+    }
+
+    adapted = pysqlite_microprotocols_adapt(parameter, (PyObject*)&pysqlite_PrepareProtocolType, NULL);
+    if (!adapted) {
+        PyErr_Clear();
+        Py_INCREF(parameter);
+        adapted = parameter;
+    }
+    rc = pysqlite_statement_bind_parameter(self, pos, adapted, allow_8bit_chars);
+    Py_DECREF(adapted);
+
+    return rc;
+}
+
 void pysqlite_statement_bind_parameters(pysqlite_Statement* self, PyObject* parameters, int allow_8bit_chars)
 {
     PyObject* current_param;
-    PyObject* adapted;
     const char* binding_name;
     int i;
     int rc;
@@ -286,20 +519,8 @@ void pysqlite_statement_bind_parameters(pysqlite_Statement* self, PyObject* para
                 return;
             }
 
-            if (!_need_adapt(current_param)) {
-                adapted = current_param;
-            } else {
-                adapted = pysqlite_microprotocols_adapt(current_param, (PyObject*)&pysqlite_PrepareProtocolType, NULL);
-                if (adapted) {
-                    Py_DECREF(current_param);
-                } else {
-                    PyErr_Clear();
-                    adapted = current_param;
-                }
-            }
-
-            rc = pysqlite_statement_bind_parameter(self, i + 1, adapted, allow_8bit_chars);
-            Py_DECREF(adapted);
+            rc = _pysqlite_statement_bind_object(self, i + 1, current_param, allow_8bit_chars);
+            Py_DECREF(current_param);
 
             if (rc != SQLITE_OK) {
                 if (!PyErr_Occurred()) {
@@ -331,20 +552,8 @@ void pysqlite_statement_bind_parameters(pysqlite_Statement* self, PyObject* para
                 return;
             }
 
-            if (!_need_adapt(current_param)) {
-                adapted = current_param;
-            } else {
-                adapted = pysqlite_microprotocols_adapt(current_param, (PyObject*)&pysqlite_PrepareProtocolType, NULL);
-                if (adapted) {
-                    Py_DECREF(current_param);
-                } else {
-                    PyErr_Clear();
-                    adapted = current_param;
-                }
-            }
-
-            rc = pysqlite_statement_bind_parameter(self, i, adapted, allow_8bit_chars);
-            Py_DECREF(adapted);
+            rc = _pysqlite_statement_bind_object(self, i, current_param, allow_8bit_chars);
+            Py_DECREF(current_param);
 
             if (rc != SQLITE_OK) {
                 if (!PyErr_Occurred()) {
@@ -358,6 +567,95 @@ void pysqlite_statement_bind_parameters(pysqlite_Statement* self, PyObject* para
     }
 }
 
+/*
+ * Converts the parameters for all placeholders of the statement to C values,
+ * so that they can be bound later without holding the GIL. values must have
+ * room for sqlite3_bind_parameter_count() items. On error, the values
+ * converted so far are cleared again.
+ *
+ * 0 => ok; -1 => error
+ */
+int pysqlite_statement_convert_parameters(pysqlite_Statement* self, PyObject* parameters, pysqlite_Value* values, int allow_8bit_chars)
+{
+    PyObject* current_param;
+    PyObject* adapted;
+    const char* binding_name;
+    int i;
+    int rc;
+    int num_params_needed;
+    int num_params;
+    int converted = 0;
+
+    num_params_needed = sqlite3_bind_parameter_count(self->st);
+
+    if (PyTuple_CheckExact(parameters) || PyList_CheckExact(parameters) || (!PyDict_Check(parameters) && PySequence_Check(parameters))) {
+        num_params = (int)PySequence_Size(parameters);
+        if (num_params < 0) {
+            return -1;
+        }
+        if (num_params != num_params_needed) {
+            PyErr_Format(pysqlite_ProgrammingError, "Incorrect number of bindings supplied. The current statement uses %d, and there are %d supplied.",
+                         num_params_needed, num_params);
+            return -1;
+        }
+    } else if (!PyDict_Check(parameters)) {
+        PyErr_SetString(PyExc_ValueError, "parameters are of unsupported type");
+        return -1;
+    }
+
+    for (i = 1; i <= num_params_needed; i++) {
+        if (PyDict_Check(parameters)) {
+            binding_name = sqlite3_bind_parameter_name(self->st, i);
+            if (!binding_name) {
+                PyErr_Format(pysqlite_ProgrammingError, "Binding %d has no name, but you supplied a dictionary (which has only names).", i);
+                goto error;
+            }
+
+            binding_name++; /* skip first char (the colon) */
+            if (PyDict_CheckExact(parameters)) {
+                current_param = PyDict_GetItemString(parameters, binding_name);
+                Py_XINCREF(current_param);
+            } else {
+                current_param = PyMapping_GetItemString(parameters, (char*)binding_name);
+            }
+            if (!current_param) {
+                PyErr_Format(pysqlite_ProgrammingError, "You did not supply a value for binding %d.", i);
+                goto error;
+            }
+        } else {
+            current_param = PySequence_GetItem(parameters, i - 1);
+            if (!current_param) {
+                goto error;
+            }
+        }
+
+        adapted = pysqlite_statement_adapt_parameter(current_param);
+        Py_DECREF(current_param);
+        if (!adapted) {
+            goto error;
+        }
+
+        rc = pysqlite_value_from_object(&values[i - 1], i, adapted, allow_8bit_chars);
+        Py_DECREF(adapted);
+        if (rc != SQLITE_OK) {
+            if (!PyErr_Occurred()) {
+                PyErr_Format(pysqlite_InterfaceError, "Unknown error binding parameter %d.", i - 1);
+            }
+            pysqlite_value_clear(&values[i - 1]);
+            goto error;
+        }
+        converted = i;
+    }
+
+    return 0;
+
+error:
+    for (i = 0; i < converted; i++) {
+        pysqlite_value_clear(&values[i]);
+    }
+    return -1;
+}
+
 int pysqlite_statement_finalize(pysqlite_Statement* self)
 {
     int rc;
@@ -370,12 +668,16 @@ int pysqlite_statement_finalize(pysqlite_Statement* self)
         self->st = NULL;
     }
 
+    _pysqlite_statement_release_bindings(self);
+
     self->in_use = 0;
 
     return rc;
 }
 
-int pysqlite_statement_reset(pysqlite_Statement* self)
+/* resets the statement for the next parameters of executemany(), keeping
+ * the bound strings so that they can be reused */
+int pysqlite_statement_rewind(pysqlite_Statement* self)
 {
     int rc;
 
@@ -394,6 +696,17 @@ int pysqlite_statement_reset(pysqlite_Statement* self)
     return rc;
 }
 
+int pysqlite_statement_reset(pysqlite_Statement* self)
+{
+    int rc;
+
+    rc = pysqlite_statement_rewind(self);
+
+    _pysqlite_statement_release_bindings(self);
+
+    return rc;
+}
+
 void pysqlite_statement_mark_dirty(pysqlite_Statement* self)
 {
     self->in_use = 1;
@@ -409,7 +722,14 @@ void pysqlite_statement_dealloc(pysqlite_Statement* self)
 
     self->st = NULL;
 
+    _pysqlite_statement_release_bindings(self);
+    PyMem_Free(self->bindings);
+
     Py_XDECREF(self->sql);
+    Py_XDECREF(self->row_cast_map);
+    Py_XDECREF(self->description);
+    Py_XDECREF(self->column_map);
+    Py_XDECREF(self->named_row_type);
 
     if (self->in_weakreflist != NULL) {
         PyObject_ClearWeakRefs((PyObject*)self);
@@ -31,6 +31,14 @@
 #define PYSQLITE_TOO_MUCH_SQL (-100)
 #define PYSQLITE_SQL_WRONG_TYPE (-101)
 
+/* A parameter bound with SQLITE_STATIC. SQLite refers to the data of owner
+ * until the parameter is rebound or the statement is reset. */
+typedef struct
+{
+    PyObject* source; /* the parameter the text was made from */
+    PyObject* owner;
+} pysqlite_Binding;
+
 typedef struct
 {
     PyObject_HEAD
@@ -39,18 +47,58 @@ typedef struct
     PyObject* sql;
     int in_use;
     int is_ddl;
+
+    /* the converters for the result columns, see pysqlite_build_row_cast_map() */
+    PyObject* row_cast_map;
+    unsigned long converters_version;
+    int reprepare_count;
+
+    /* the cursor description for the result columns */
+    PyObject* description;
+    int description_reprepare_count;
+
+    /* the column indexes by case-folded name for Row, built on demand */
+    PyObject* column_map;
+
+    /* the NamedRow subclass for the result columns, built on demand */
+    PyObject* named_row_type;
+
+    /* the parameters bound without copying, indexed by position - 1 */
+    pysqlite_Binding* bindings;
+    int bindings_size;
+    int bindings_held;
+
     PyObject* in_weakreflist; /* List of weak references */
 } pysqlite_Statement;
 
+/* a parameter converted to C, so that it can be bound without holding the GIL */
+typedef struct
+{
+    int type; /* SQLITE_INTEGER, SQLITE_FLOAT, SQLITE_TEXT, SQLITE_BLOB or SQLITE_NULL */
+    sqlite3_int64 intval;
+    double dblval;
+    const char* data;
+    Py_ssize_t nbytes;
+    PyObject* owner; /* keeps data alive */
+} pysqlite_Value;
+
 extern PyTypeObject pysqlite_StatementType;
 
 int pysqlite_statement_create(pysqlite_Statement* self, pysqlite_Connection* connection, PyObject* sql);
 void pysqlite_statement_dealloc(pysqlite_Statement* self);
 
+int pysqlite_value_from_object(pysqlite_Value* value, int pos, PyObject* parameter, int allow_8bit_chars);
+void pysqlite_value_clear(pysqlite_Value* value);
+
+int pysqlite_statement_bind_value(pysqlite_Statement* self, int pos, pysqlite_Value* value, sqlite3_destructor_type destructor);
+void pysqlite_statement_set_bind_error(int rc, int pos);
+PyObject* pysqlite_statement_adapt_parameter(PyObject* parameter);
 int pysqlite_statement_bind_parameter(pysqlite_Statement* self, int pos, PyObject* parameter, int allow_8bit_chars);
 void pysqlite_statement_bind_parameters(pysqlite_Statement* self, PyObject* parameters, int allow_8bit_chars);
+int pysqlite_statement_convert_parameters(pysqlite_Statement* self, PyObject* parameters, pysqlite_Value* values, int allow_8bit_chars);
 
 int pysqlite_statement_finalize(pysqlite_Statement* self);
+int pysqlite_statement_rewind(pysqlite_Statement* self);
 int pysqlite_statement_reset(pysqlite_Statement* self);
 void pysqlite_statement_mark_dirty(pysqlite_Statement* self);
 